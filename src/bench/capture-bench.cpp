@@ -0,0 +1,378 @@
+// Standard Library Includes
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <vector>
+
+// Dependency Includes
+#include <benchmark/benchmark.h>
+
+// Project Includes
+#include "core/report.hpp"
+#include "core/track-cache.hpp"
+#include "parsers/ais/parser.hpp"
+#include "parsers/moos/message-parser.hpp"
+#include "parsers/moos/packet-parser.hpp"
+#include "parsers/nmea0183/packet-parser.hpp"
+#include "readers/pcap/log-reader.hpp"
+
+// Hot-path benchmarks, on real traffic: every input is sampled from the captures in `data/`.
+// Run from the repository root; or point TRACKMON_DATA at the data directory.
+
+// ====== Utilities ======
+
+/// \brief every payload in a capture, copied out; so a benchmark replays memory, not the file
+struct Capture {
+    std::vector<uint64_t> timestamps;
+    std::vector<std::vector<uint8_t>> payloads;
+
+    size_t size() const { return payloads.size(); }
+
+    bool empty() const { return payloads.empty(); }
+
+    /// \brief a frame over the copy; as a reader would hand it to a parser
+    readers::pcap::FrameBuffer frame( size_t index ) const {
+        return { timestamps[index], payloads[index].size(), const_cast<uint8_t*>(payloads[index].data()) };
+    }
+};
+
+static std::string data_path( const std::string& name ){
+    const char* directory = std::getenv( "TRACKMON_DATA" );
+    return std::string( (nullptr == directory) ? "data" : directory ) + '/' + name;
+}
+
+static Capture load_capture( const std::string& name, bool tcp, uint16_t port ){
+    Capture capture;
+    readers::pcap::LogReader reader( data_path(name) );
+    if( ! reader.good() ){
+        return capture;
+    }
+    if( tcp ){
+        reader.set_filter_tcp();
+    }else{
+        reader.set_filter_udp();
+    }
+    reader.set_filter_port( port );
+
+    while( reader.good() ){
+        const readers::pcap::FrameBuffer& chunk = reader.next();
+        if( 0 < chunk.length ){
+            capture.timestamps.push_back( chunk.timestamp );
+            capture.payloads.emplace_back( chunk.buffer, chunk.buffer + chunk.length );
+        }
+    }
+    return capture;
+}
+
+static const Capture& moos_capture(){
+    static const Capture capture = load_capture( "m2_berta.moos.p9000.pcap", true, 9000 );
+    return capture;
+}
+
+static const Capture& ais_capture(){
+    static const Capture capture = load_capture( "ais.tcpdump.2022-05-18.pcap", false, 4003 );
+    return capture;
+}
+
+/// \brief the messages the MOOS packet parser splits out: i.e. the MOOS message parser's input
+static const std::vector<std::string>& moos_lines(){
+    static const std::vector<std::string> lines = [](){
+        std::vector<std::string> out;
+        const Capture& capture = moos_capture();
+        parsers::moos::PacketParser parser;
+        for( size_t index = 0; index < capture.size(); ++index ){
+            const readers::pcap::FrameBuffer frame = capture.frame( index );
+            parser.load( &frame );
+            while( ! parser.empty() ){
+                std::string line = parser.next();
+                if( ! line.empty() ){
+                    out.push_back( std::move(line) );
+                }
+            }
+        }
+        return out;
+    }();
+    return lines;
+}
+
+/// \brief one NMEA sentence, and the time its datagram arrived
+struct Sentence {
+    uint64_t timestamp;
+    std::string line;
+};
+
+/// \brief the sentences the NMEA-0183 packet parser splits out: i.e. the AIS parser's input
+static const std::vector<Sentence>& ais_sentences(){
+    static const std::vector<Sentence> sentences = [](){
+        std::vector<Sentence> out;
+        const Capture& capture = ais_capture();
+        parsers::nmea0183::PacketParser parser;
+        for( size_t index = 0; index < capture.size(); ++index ){
+            const readers::pcap::FrameBuffer frame = capture.frame( index );
+            parser.load( &frame );
+            while( ! parser.empty() ){
+                std::string line = parser.next();
+                if( ! line.empty() ){
+                    out.push_back( {frame.timestamp, std::move(line)} );
+                }
+            }
+        }
+        return out;
+    }();
+    return sentences;
+}
+
+/// \brief every report in both captures, in capture order
+static const std::vector<Report>& captured_reports(){
+    static const std::vector<Report> reports = [](){
+        std::vector<Report> out;
+        parsers::moos::MessageParser moos_parser;
+        for( const std::string& line : moos_lines() ){
+            if( const Report* report = moos_parser.parse(line) ){
+                out.push_back( *report );
+            }
+        }
+        parsers::ais::Parser ais_parser;
+        for( const Sentence& sentence : ais_sentences() ){
+            if( const Report* report = ais_parser.parse(sentence.timestamp, sentence.line) ){
+                out.push_back( *report );
+            }
+        }
+        return out;
+    }();
+    return reports;
+}
+
+/// \brief the first position in the captures; as the local origin
+static bool captured_origin( double& latitude, double& longitude ){
+    for( const Report& report : captured_reports() ){
+        if( report.has(Report::GLOBAL) ){
+            latitude = report.latitude;
+            longitude = report.longitude;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ====== Parser Benchmarks ======
+
+/// \brief split MOOS frames into messages; one frame per iteration
+static void BM_MoosPacketParser_next( benchmark::State& state ){
+    const Capture& capture = moos_capture();
+    if( capture.empty() ){
+        state.SkipWithError( "no MOOS capture; run from the repository root, or set TRACKMON_DATA" );
+        return;
+    }
+
+    parsers::moos::PacketParser parser;
+    size_t index = 0;
+    size_t messages = 0;
+    size_t bytes = 0;
+    for( auto _ : state ){
+        const readers::pcap::FrameBuffer frame = capture.frame( index );
+        parser.load( &frame );
+        while( ! parser.empty() ){
+            const std::string line = parser.next();
+            benchmark::DoNotOptimize( line );
+            // as `ParseProfile::messages`: only lines handed on to the message parser
+            messages += ! line.empty();
+        }
+        bytes += frame.length;
+        index = (index + 1 < capture.size()) ? index + 1 : 0;
+    }
+
+    state.SetItemsProcessed( messages );
+    state.SetBytesProcessed( bytes );
+}
+BENCHMARK(BM_MoosPacketParser_next);
+
+/// \brief decode one MOOS NODE_REPORT per iteration
+static void BM_MoosMessageParser_parse( benchmark::State& state ){
+    const std::vector<std::string>& lines = moos_lines();
+    if( lines.empty() ){
+        state.SkipWithError( "no MOOS capture; run from the repository root, or set TRACKMON_DATA" );
+        return;
+    }
+
+    parsers::moos::MessageParser parser;
+    size_t index = 0;
+    for( auto _ : state ){
+        benchmark::DoNotOptimize( parser.parse(lines[index]) );
+        index = (index + 1 < lines.size()) ? index + 1 : 0;
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK(BM_MoosMessageParser_parse);
+
+/// \brief split AIS datagrams into NMEA-0183 sentences; one datagram per iteration
+static void BM_Nmea0183PacketParser_next( benchmark::State& state ){
+    const Capture& capture = ais_capture();
+    if( capture.empty() ){
+        state.SkipWithError( "no AIS capture; run from the repository root, or set TRACKMON_DATA" );
+        return;
+    }
+
+    parsers::nmea0183::PacketParser parser;
+    size_t index = 0;
+    size_t sentences = 0;
+    size_t bytes = 0;
+    for( auto _ : state ){
+        const readers::pcap::FrameBuffer frame = capture.frame( index );
+        parser.load( &frame );
+        while( ! parser.empty() ){
+            const std::string line = parser.next();
+            benchmark::DoNotOptimize( line );
+            sentences += ! line.empty();
+        }
+        bytes += frame.length;
+        index = (index + 1 < capture.size()) ? index + 1 : 0;
+    }
+
+    state.SetItemsProcessed( sentences );
+    state.SetBytesProcessed( bytes );
+}
+BENCHMARK(BM_Nmea0183PacketParser_next);
+
+/// \brief decode one AIS sentence per iteration; in capture order, so multi-sentence messages reassemble
+static void BM_AisParser_parse( benchmark::State& state ){
+    const std::vector<Sentence>& sentences = ais_sentences();
+    if( sentences.empty() ){
+        state.SkipWithError( "no AIS capture; run from the repository root, or set TRACKMON_DATA" );
+        return;
+    }
+
+    parsers::ais::Parser parser;
+    size_t index = 0;
+    size_t reports = 0;
+    for( auto _ : state ){
+        const Sentence& sentence = sentences[index];
+        const Report* report = parser.parse( sentence.timestamp, sentence.line );
+        benchmark::DoNotOptimize( report );
+        reports += (nullptr != report);
+        index = (index + 1 < sentences.size()) ? index + 1 : 0;
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+    // the rest are unsupported types, or the leading parts of multi-sentence messages
+    state.counters["reports/sentence"] = static_cast<double>(reports) / state.iterations();
+}
+BENCHMARK(BM_AisParser_parse);
+
+// ====== Report + Cache Benchmarks ======
+
+/// \brief merge one captured report into another; as the cache does on every update
+static void BM_Report_assign( benchmark::State& state ){
+    const std::vector<Report>& reports = captured_reports();
+    if( reports.empty() ){
+        state.SkipWithError( "no captured reports; run from the repository root, or set TRACKMON_DATA" );
+        return;
+    }
+
+    Report merged = reports.front();
+    size_t index = 0;
+    for( auto _ : state ){
+        merged = reports[index];
+        benchmark::DoNotOptimize( merged );
+        index = (index + 1 < reports.size()) ? index + 1 : 0;
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK(BM_Report_assign);
+
+/// \brief replay captured traffic, in batches of 64, into a cache already holding `state.range(0)` other tracks
+static void BM_TrackCache_update_captured( benchmark::State& state ){
+    const std::vector<Report>& captured = captured_reports();
+    if( captured.empty() ){
+        state.SkipWithError( "no captured reports; run from the repository root, or set TRACKMON_DATA" );
+        return;
+    }
+    constexpr size_t batch_size = 64;
+    const size_t track_count = state.range(0);
+
+    TrackCache cache;
+    double latitude = 0;
+    double longitude = 0;
+    if( captured_origin(latitude, longitude) ){
+        cache.set_origin( latitude, longitude );
+    }
+    cache.reserve( track_count + captured.size() );
+
+    // background tracks; with ids above any MMSI, so they never collide with the capture's
+    Report background( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+    for( size_t index = 0; index < track_count; ++index ){
+        background.id = 1'000'000'000 + index;
+        cache.update( background );
+    }
+
+    // each pass shifts the capture later in time; so every report is fresh, as live traffic would be
+    uint64_t first = UINT64_MAX;
+    uint64_t last = 0;
+    for( const Report& report : captured ){
+        first = std::min( first, report.timestamp );
+        last = std::max( last, report.timestamp );
+    }
+    const uint64_t pass_length = last - first + 1;
+
+    std::vector<Report> batch;
+    batch.reserve( batch_size );
+    uint64_t shift = 0;
+    size_t index = 0;
+    size_t updated = 0;
+    for( auto _ : state ){
+        // copying the batch is timed too: it is ~1% of the update, and cheaper than pausing the timer
+        batch.clear();
+        for( size_t count = 0; count < batch_size; ++count ){
+            batch.push_back( captured[index] );
+            batch.back().timestamp += shift;
+            if( captured.size() <= ++index ){
+                index = 0;
+                shift += pass_length;
+            }
+        }
+
+        updated += cache.update( batch );
+    }
+
+    state.SetItemsProcessed( state.iterations() * batch_size );
+    state.counters["changed/report"] = static_cast<double>(updated) / (state.iterations() * batch_size);
+}
+BENCHMARK(BM_TrackCache_update_captured)->Arg(0)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+
+/// \brief project every captured position, in batches of 256;  state.range(0): TrackCache::PROJECTION_MODE
+static void BM_TrackCache_project_captured( benchmark::State& state ){
+    constexpr size_t batch_size = 256;
+    std::vector<Report> positions;
+    for( const Report& report : captured_reports() ){
+        if( report.has(Report::GLOBAL) ){
+            positions.push_back( report );
+        }
+    }
+    double latitude = 0;
+    double longitude = 0;
+    if( positions.empty() || (! captured_origin(latitude, longitude)) ){
+        // MOOS reports are local-only; the positions come from the AIS capture
+        state.SkipWithError( "no captured positions, from the AIS capture; run from the repository root, or set TRACKMON_DATA" );
+        return;
+    }
+
+    TrackCache cache;
+    cache.set_projection( static_cast<TrackCache::PROJECTION_MODE>(state.range(0)) );
+    cache.set_origin( latitude, longitude );
+
+    size_t offset = 0;
+    size_t projected = 0;
+    for( auto _ : state ){
+        const size_t count = std::min( batch_size, positions.size() - offset );
+        benchmark::DoNotOptimize( cache.project(std::span<Report>(positions.data() + offset, count)) );
+        projected += count;
+        offset = (offset + count < positions.size()) ? offset + count : 0;
+    }
+
+    state.SetItemsProcessed( projected );
+}
+BENCHMARK(BM_TrackCache_project_captured)->Arg(TrackCache::EXACT)->Arg(TrackCache::FAST);
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <thread>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "connectors/registry.hpp"
+#include "core/connector.hpp"
+
+#include "ingest-bench.hpp"
+
+constexpr static std::string_view stage_names[IngestBench::stage_count] = {
+    "read", "packet_parse", "message_parse", "projection", "cache_update" };
+
+// ====== Utility Methods ======
+
+static inline uint64_t now_nsec(){
+    return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count() );
+}
+
+/// \brief a quoted JSON string; escaping quotes, backslashes, and control characters
+static void append_json_string( fmt::memory_buffer& out, std::string_view text ){
+    out.push_back( '"' );
+    for( const char c : text ){
+        if( ('"' == c) || ('\\' == c) ){
+            out.push_back( '\\' );
+            out.push_back( c );
+        }else if( static_cast<unsigned char>(c) < 0x20 ){
+            fmt::format_to( std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c) );
+        }else{
+            out.push_back( c );
+        }
+    }
+    out.push_back( '"' );
+}
+
+/// \return count per second; 0 if no time has passed
+static inline double rate( uint64_t count, uint64_t nanoseconds ){
+    return (0 < nanoseconds) ? (count * 1e9 / nanoseconds) : 0.0;
+}
+
+// ====== IngestBench ======
+
+IngestBench::IngestBench( std::vector<std::string> specs, uint32_t loops )
+    : specs_(std::move(specs))
+    , loops_(std::max<uint32_t>(1, loops))
+    , limit_(0)
+    , auto_origin_(true)
+    , frames_(0)
+    , bytes_(0)
+    , messages_(0)
+    , reports_(0)
+    , updates_(0)
+    , stage_nanoseconds_{}
+    , warmup_nanoseconds_(0)
+{}
+
+void IngestBench::set_limit( uint64_t frames ){
+    limit_ = frames;
+}
+
+void IngestBench::set_configure( configure_function configure ){
+    configure_ = std::move(configure);
+}
+
+void IngestBench::set_auto_origin( bool enable ){
+    auto_origin_ = enable;
+}
+
+std::string_view IngestBench::stage_name( STAGE stage ){
+    return stage_names[stage];
+}
+
+bool IngestBench::run(){
+    FrameBatch frames;
+    std::vector<Report> batch;
+    // loop 0 is an untimed warm-up: it interns every name into the process-wide `NameTable`, which
+    // outlives the loop's cache; so the timed loops all start from the same state.
+    for( uint32_t loop = 0; loop <= loops_; ++loop ){
+        // .1. setup: untimed
+        std::vector<std::unique_ptr<Connector>> connectors;
+        if( ! connectors::Registry::global().create(specs_, connectors) ){
+            return false;
+        }
+        std::vector<Connector*> active;
+        for( auto& connector : connectors ){
+            connector->set_limit( limit_ );
+            connector->set_profiling( true );
+            active.push_back( connector.get() );
+        }
+
+        TrackCache cache;
+        if( configure_ ){
+            configure_( cache );
+        }
+        double latitude = 0;
+        double longitude = 0;
+        bool needs_origin = auto_origin_ && (! cache.origin(latitude, longitude));
+
+        // .2. one frame from each connector in turn, until all are exhausted; as `ingest --inline`
+        uint64_t read = 0;
+        uint64_t parse = 0;
+        uint64_t projection = 0;
+        uint64_t update = 0;
+        uint64_t updates = 0;
+        const uint64_t loop_start = now_nsec();
+        while( ! active.empty() ){
+            for( size_t index = 0; index < active.size(); ){
+                frames.clear();
+                const uint64_t read_start = now_nsec();
+                const bool more = active[index]->read( frames );
+                const uint64_t parse_start = now_nsec();
+                read += parse_start - read_start;
+                if( ! more ){
+                    active.erase( active.begin() + index );
+                    continue;
+                }
+                ++index;
+                if( frames.empty() ){
+                    continue;
+                }
+
+                active[index - 1]->parse( frames, batch );
+                uint64_t project_start = now_nsec();
+                parse += project_start - parse_start;
+
+                if( needs_origin ){
+                    const auto found = std::find_if( batch.begin(), batch.end(), []( const Report& report ){
+                        return report.has( Report::GLOBAL );
+                    });
+                    if( batch.end() != found ){
+                        cache.set_origin( found->latitude, found->longitude );
+                        needs_origin = false;
+                        // building the projection is setup; not projection
+                        project_start = now_nsec();
+                    }
+                }
+
+                cache.project( batch );
+                const uint64_t update_start = now_nsec();
+                projection += update_start - project_start;
+
+                updates += cache.apply( batch );
+                update += now_nsec() - update_start;
+                batch.clear();
+            }
+        }
+        const uint64_t loop_nanoseconds = now_nsec() - loop_start;
+        if( 0 == loop ){
+            warmup_nanoseconds_ = loop_nanoseconds;
+            spdlog::info("    >> Warm-up: {:.1f} ms", loop_nanoseconds / 1e6 );
+            continue;
+        }
+        loop_nanoseconds_.push_back( loop_nanoseconds );
+        updates_ += updates;
+
+        // .3. split the parse time between the parser's two steps
+        uint64_t packet = 0;
+        for( const auto& connector : connectors ){
+            const ConnectorStats stats = connector->stats();
+            const ParseProfile& profile = connector->profile();
+            frames_ += stats.frames;
+            bytes_ += stats.bytes;
+            reports_ += stats.reports;
+            messages_ += profile.messages;
+            packet += profile.packet_nanoseconds;
+        }
+        packet = std::min( packet, parse );
+
+        stage_nanoseconds_[READ] += read;
+        stage_nanoseconds_[PACKET_PARSE] += packet;
+        stage_nanoseconds_[MESSAGE_PARSE] += parse - packet;
+        stage_nanoseconds_[PROJECTION] += projection;
+        stage_nanoseconds_[CACHE_UPDATE] += update;
+
+        spdlog::info("    >> Loop {}/{}: {:.1f} ms", loop, loops_, loop_nanoseconds_.back() / 1e6 );
+    }
+    return true;
+}
+
+std::string IngestBench::to_json() const {
+    uint64_t total = 0;
+    for( const uint64_t nanoseconds : loop_nanoseconds_ ){
+        total += nanoseconds;
+    }
+    std::vector<uint64_t> sorted = loop_nanoseconds_;
+    std::sort( sorted.begin(), sorted.end() );
+
+    fmt::memory_buffer out;
+    auto append = std::back_inserter( out );
+    fmt::format_to( append, "{{\n  \"benchmark\": \"ingest\",\n" );
+
+    // what was measured, and where
+#ifdef NDEBUG
+    const std::string_view build_type = "release";
+#else
+    const std::string_view build_type = "debug";
+#endif
+    fmt::format_to( append, "  \"build\": {{\"type\": \"{}\", \"compiler\": ", build_type );
+#ifdef __VERSION__
+    append_json_string( out, __VERSION__ );
+#else
+    append_json_string( out, "unknown" );
+#endif
+    fmt::format_to( append, "}},\n  \"host\": {{\"cpus\": {}}},\n", std::thread::hardware_concurrency() );
+
+    fmt::format_to( append, "  \"config\": {{\"loops\": {}, \"limit\": {}, \"sources\": [", loops_, limit_ );
+    for( size_t index = 0; index < specs_.size(); ++index ){
+        if( 0 < index ){
+            out.push_back( ',' );
+            out.push_back( ' ' );
+        }
+        append_json_string( out, specs_[index] );
+    }
+    fmt::format_to( append, "]}},\n" );
+
+    // totals, and rates over every loop
+    fmt::format_to( append, "  \"totals\": {{\"seconds\": {:.6f}, \"frames\": {}, \"bytes\": {}, \"messages\": {}, \"reports\": {}, \"updates\": {}}},\n",
+                            total / 1e9, frames_, bytes_, messages_, reports_, updates_ );
+    fmt::format_to( append, "  \"rates\": {{\"frames_per_second\": {:.1f}, \"messages_per_second\": {:.1f}, \"reports_per_second\": {:.1f}, \"bytes_per_second\": {:.1f}}},\n",
+                            rate(frames_, total), rate(messages_, total), rate(reports_, total), rate(bytes_, total) );
+
+    // where the time went: `other` is the loop's own overhead, and the clock reads
+    fmt::format_to( append, "  \"stages\": {{\n" );
+    uint64_t staged = 0;
+    for( size_t index = 0; index < stage_count; ++index ){
+        const uint64_t nanoseconds = stage_nanoseconds_[index];
+        staged += nanoseconds;
+        fmt::format_to( append, "    \"{}\": {{\"seconds\": {:.6f}, \"share\": {:.4f}, \"nanoseconds_per_frame\": {:.1f}}},\n",
+                                stage_names[index], nanoseconds / 1e9, (0 < total) ? (static_cast<double>(nanoseconds) / total) : 0.0,
+                                (0 < frames_) ? (static_cast<double>(nanoseconds) / frames_) : 0.0 );
+    }
+    const uint64_t other = (staged < total) ? (total - staged) : 0;
+    fmt::format_to( append, "    \"other\": {{\"seconds\": {:.6f}, \"share\": {:.4f}}}\n  }},\n",
+                            other / 1e9, (0 < total) ? (static_cast<double>(other) / total) : 0.0 );
+
+    // loop-to-loop spread; a wide one means a noisy host
+    const double minimum = sorted.empty() ? 0.0 : sorted.front() / 1e9;
+    const double median = sorted.empty() ? 0.0 : sorted[sorted.size() / 2] / 1e9;
+    const double maximum = sorted.empty() ? 0.0 : sorted.back() / 1e9;
+    fmt::format_to( append, "  \"loops\": {{\"min_seconds\": {:.6f}, \"median_seconds\": {:.6f}, \"max_seconds\": {:.6f}, \"warmup_seconds\": {:.6f}}}\n}}\n",
+                            minimum, median, maximum, warmup_nanoseconds_ / 1e9 );
+    return fmt::to_string( out );
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/track-cache.hpp"
+
+/// \brief `ingest --bench`: replay captures through every ingest step, on one thread, and time each step
+///
+/// Each loop re-opens every connector and starts from an empty cache; and an untimed warm-up loop
+/// first fills the process-wide `NameTable`, so the timed loops are identical.  The steps run inline,
+/// so their times add up to the loop's, and each is charged to exactly one of:
+///
+///     read             reader: frame out of the capture
+///     packet_parse     parser: frame => messages
+///     message_parse    parser: message => report
+///     projection       cache:  global => local coordinates
+///     cache_update     cache:  merge reports into tracks
+///
+/// Results are JSON, so runs can be diffed across builds and hardware.
+class IngestBench {
+public:
+    enum STAGE : uint8_t {
+        READ = 0,
+        PACKET_PARSE = 1,
+        MESSAGE_PARSE = 2,
+        PROJECTION = 3,
+        CACHE_UPDATE = 4
+    };
+    constexpr static size_t stage_count = 5;
+
+    /// \brief sets up each loop's cache: e.g. projection mode, and origin
+    typedef std::function<void( TrackCache& cache )> configure_function;
+
+public:
+    /// \param specs connectors to read; see: `connectors::Registry`
+    IngestBench( std::vector<std::string> specs, uint32_t loops );
+
+    /// \brief stop each connector after this many frames, per loop; 0 => never (default)
+    void set_limit( uint64_t frames );
+
+    /// \brief run on each loop's cache, before any report
+    void set_configure( configure_function configure );
+
+    /// \brief without a configured origin, use each loop's first global position: so projection is timed too.  (default: on)
+    void set_auto_origin( bool enable );
+
+    /// \return false if any connector could not be created.  (logged)
+    bool run();
+
+    /// \brief the results, as one JSON object
+    std::string to_json() const;
+
+    static std::string_view stage_name( STAGE stage );
+
+private:
+    std::vector<std::string> specs_;
+    uint32_t loops_;
+    uint64_t limit_;
+    configure_function configure_;
+    bool auto_origin_;
+
+    // summed over every loop
+    uint64_t frames_;
+    uint64_t bytes_;
+    uint64_t messages_;
+    uint64_t reports_;
+    uint64_t updates_;
+    uint64_t stage_nanoseconds_[stage_count];
+    std::vector<uint64_t> loop_nanoseconds_;
+
+    /// the untimed first loop; reported, but not in any total
+    uint64_t warmup_nanoseconds_;
+
+};
@@ -0,0 +1,294 @@
+// Standard Library Includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+// Dependency Includes
+#include <benchmark/benchmark.h>
+
+// Project Includes
+#include "core/checkpoint.hpp"
+#include "core/cpa-engine.hpp"
+#include "core/event-bus.hpp"
+#include "core/report.hpp"
+#include "core/sharded-track-cache.hpp"
+#include "core/track-cache.hpp"
+
+// ====== Utilities ======
+
+// count every heap allocation in this binary; so that benchmarks can report mallocs-per-operation
+static std::atomic<size_t> heap_allocations(0);
+
+void* operator new( size_t size ){
+    heap_allocations.fetch_add( 1, std::memory_order_relaxed );
+    if( void* allocated = std::malloc(size) ){
+        return allocated;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete( void* pointer ) noexcept {
+    std::free( pointer );
+}
+
+void operator delete( void* pointer, size_t ) noexcept {
+    std::free( pointer );
+}
+
+// MMSI-like ids: 9 digits, scattered
+static std::vector<uint64_t> generate_ids( size_t count ){
+    std::mt19937_64 generator(count);
+    std::uniform_int_distribution<uint64_t> distribution( 100'000'000, 999'999'999 );
+    std::vector<uint64_t> ids(count);
+    for( auto& id : ids ){
+        id = distribution(generator);
+    }
+    return ids;
+}
+
+// ====== Benchmarks ======
+
+/// \brief update throughput of a warm cache, holding `state.range(0)` tracks
+static void BM_TrackCache_update( benchmark::State& state ){
+    const size_t track_count = state.range(0);
+    const std::vector<uint64_t> ids = generate_ids( track_count );
+
+    TrackCache cache;
+    cache.reserve( track_count );
+
+    Report report( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+    for( const uint64_t id : ids ){
+        report.id = id;
+        cache.update( report );
+    }
+
+    // visit the ids in a random order, so the access pattern is not sequential
+    std::vector<uint64_t> order = ids;
+    std::shuffle( order.begin(), order.end(), std::mt19937_64(42) );
+
+    size_t index = 0;
+    const size_t allocations_before = heap_allocations.load();
+    for( auto _ : state ){
+        report.id = order[index];
+        ++report.timestamp;
+        benchmark::DoNotOptimize( cache.update(report) );
+        index = (index + 1 < order.size()) ? index + 1 : 0;
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+    state.counters["mallocs/update"] = static_cast<double>(heap_allocations.load() - allocations_before) / state.iterations();
+}
+BENCHMARK(BM_TrackCache_update)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+
+/// \brief cost of creating `state.range(0)` new tracks in an empty cache
+static void BM_TrackCache_insert( benchmark::State& state ){
+    const size_t track_count = state.range(0);
+    const std::vector<uint64_t> ids = generate_ids( track_count );
+
+    for( auto _ : state ){
+        TrackCache cache;
+        Report report( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+        for( const uint64_t id : ids ){
+            report.id = id;
+            cache.update( report );
+        }
+        benchmark::DoNotOptimize( cache.size() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * track_count );
+}
+BENCHMARK(BM_TrackCache_insert)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+
+/// \brief concurrent update throughput of a sharded cache, holding 100k tracks
+static void BM_ShardedTrackCache_update( benchmark::State& state ){
+    constexpr size_t track_count = 100'000;
+    static const std::vector<uint64_t> ids = generate_ids( track_count );
+    static std::unique_ptr<ShardedTrackCache> cache;
+
+    if( 0 == state.thread_index() ){
+        cache = std::make_unique<ShardedTrackCache>();
+        Report report( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+        for( const uint64_t id : ids ){
+            report.id = id;
+            cache->update( report );
+        }
+    }
+
+    // each thread walks the ids from its own starting point, at its own stride
+    Report report( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+    size_t index = (state.thread_index() * track_count) / state.threads();
+    const size_t stride = 2 * state.thread_index() + 1;
+    for( auto _ : state ){
+        report.id = ids[index];
+        ++report.timestamp;
+        benchmark::DoNotOptimize( cache->update(report) );
+        index = (index + stride) % track_count;
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK(BM_ShardedTrackCache_update)->Threads(1)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+
+/// \brief concurrent batch projection throughput, through one shared cache
+static void BM_TrackCache_project( benchmark::State& state ){
+    constexpr size_t batch_size = 256;
+    static std::unique_ptr<TrackCache> cache;
+
+    if( 0 == state.thread_index() ){
+        cache = std::make_unique<TrackCache>();
+        cache->set_origin( 42.358456, -71.087589 );
+    }
+
+    // each thread projects its own batch, scattered ~10km around the origin
+    std::mt19937_64 generator( state.thread_index() );
+    std::uniform_real_distribution<double> offset( -0.1, 0.1 );
+    std::vector<Report> batch( batch_size );
+    for( auto& report : batch ){
+        report.set_global( 42.358456 + offset(generator), -71.087589 + offset(generator) );
+    }
+
+    for( auto _ : state ){
+        benchmark::DoNotOptimize( cache->project(batch) );
+    }
+
+    state.SetItemsProcessed( state.iterations() * batch_size );
+}
+BENCHMARK(BM_TrackCache_project)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+
+/// \brief spatial query latency over 100k tracks, scattered +/-100km around the origin
+///
+/// state.range(0): 0 => 5km radius; 1 => 6x4km box; 2 => 10 nearest
+static void BM_TrackCache_query( benchmark::State& state ){
+    constexpr size_t track_count = 100'000;
+    const std::vector<uint64_t> ids = generate_ids( track_count );
+
+    TrackCache cache;
+    cache.set_grid( 2000.f );
+    std::mt19937_64 generator(7);
+    std::uniform_real_distribution<float> position( -100'000.f, 100'000.f );
+    Report report( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+    for( const uint64_t id : ids ){
+        report.id = id;
+        report.set_local( position(generator), position(generator) );
+        cache.update( report );
+    }
+
+    std::vector<const Track*> found;
+    size_t total = 0;
+    for( auto _ : state ){
+        const float easting = position(generator);
+        const float northing = position(generator);
+        switch( state.range(0) ){
+            case 0: total += cache.within_radius( easting, northing, 5000.f, found ); break;
+            case 1: total += cache.within_box( easting - 3000.f, northing - 2000.f, easting + 3000.f, northing + 2000.f, found ); break;
+            default: total += cache.nearest( easting, northing, 10, found ); break;
+        }
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+    state.counters["tracks/query"] = static_cast<double>(total) / state.iterations();
+}
+BENCHMARK(BM_TrackCache_query)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+/// \brief incremental CPA pass over `state.range(0)` tracks, after 1% of them move
+///
+/// Constant density: 10k tracks per 200km square; i.e. dense coastal traffic.
+static void BM_CpaEngine_update( benchmark::State& state ){
+    const size_t track_count = state.range(0);
+    const std::vector<uint64_t> ids = generate_ids( track_count );
+
+    TrackCache cache;
+    cache.set_grid( 2000.f );
+    std::mt19937_64 generator(11);
+    const float extent = 100'000.f * std::sqrt( track_count / 10'000.f );
+    std::uniform_real_distribution<float> position( -extent, extent );
+    std::uniform_real_distribution<float> course( 0.f, 360.f );
+    std::uniform_real_distribution<float> speed( 0.f, 10.f );
+    Report report( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+    for( const uint64_t id : ids ){
+        report.id = id;
+        report.set_local( position(generator), position(generator) );
+        report.set_course( course(generator) );
+        report.set_speed( speed(generator) );
+        cache.update( report );
+    }
+
+    CpaEngine cpa(cache);
+    cpa.configure( 500.f, 300'000'000, 10.f );
+    cpa.update();
+
+    size_t index = 0;
+    for( auto _ : state ){
+        state.PauseTiming();
+        for( size_t i = 0; i < track_count / 100; ++i ){
+            report.id = ids[index];
+            ++report.timestamp;
+            report.set_local( position(generator), position(generator) );
+            cache.update( report );
+            index = (index + 1 < ids.size()) ? index + 1 : 0;
+        }
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize( cpa.update() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * (track_count / 100) );
+}
+BENCHMARK(BM_CpaEngine_update)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+/// \brief warm start: load a checkpoint of `state.range(0)` tracks into an empty cache
+static void BM_Checkpoint_load( benchmark::State& state ){
+    const size_t track_count = state.range(0);
+    const std::vector<uint64_t> ids = generate_ids( track_count );
+    const std::string path = "trackmon-bench.ckpt";
+
+    {
+        TrackCache cache;
+        Report report( 0, 1, 1, 10.f, 20.f, 90.f, 90.f, 2.f );
+        for( const uint64_t id : ids ){
+            report.id = id;
+            cache.update( report );
+        }
+        Checkpoint::write( *cache.capture(false), path );
+    }
+
+    for( auto _ : state ){
+        TrackCache cache;
+        benchmark::DoNotOptimize( Checkpoint::load(path, cache) );
+    }
+
+    std::remove( path.c_str() );
+    state.SetItemsProcessed( state.iterations() * track_count );
+}
+BENCHMARK(BM_Checkpoint_load)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+/// \brief publish one event to one subscriber, under each policy: 0 drop-oldest, 1 coalesce, 2 block
+///
+/// The queue is drained every 1024 events, on this thread; so this is the publisher's cost alone.
+static void BM_EventBus_publish( benchmark::State& state ){
+    EventBus bus;
+    const auto subscription = bus.subscribe( 4096, static_cast<Subscription::POLICY>(state.range(0)) );
+    std::vector<TrackEvent> out;
+
+    TrackEvent event{};
+    event.type = TrackEvent::UPDATED;
+    uint64_t count = 0;
+    for( auto _ : state ){
+        event.report.id = 1 + (count & 1023);
+        event.version = ++count;
+        bus.publish( event );
+        if( 0 == (count & 1023) ){
+            subscription->drain( out );
+        }
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK(BM_EventBus_publish)->Arg(0)->Arg(1)->Arg(2);
@@ -0,0 +1,382 @@
+#include <charconv>
+#include <chrono>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+
+#include "parsers/ais/parser.hpp"
+#include "parsers/moos/message-parser.hpp"
+#include "parsers/moos/packet-parser.hpp"
+#include "parsers/nmea0183/packet-parser.hpp"
+#include "readers/nmea0183/text-log-reader.hpp"
+#include "readers/pcap/log-reader.hpp"
+#include "readers/udp/socket-reader.hpp"
+
+#include "registry.hpp"
+
+namespace connectors {
+
+// ======================= Utility Methods ===================================
+
+static bool parse_port( std::string_view text, uint16_t& port ){
+    const auto [end, error] = std::from_chars( text.data(), text.data() + text.size(), port );
+    return (std::errc() == error) && (text.data() + text.size() == end) && (0 < port);
+}
+
+static inline std::string_view trim( std::string_view text ){
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if( std::string_view::npos == first ){
+        return {};
+    }
+    const size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr( first, last - first + 1 );
+}
+
+static inline uint64_t now_usec(){
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>(now).count() );
+}
+
+// ======================= Built-in Readers ===================================
+
+/// \brief frames from a capture file; optionally filtered to one protocol and port
+class PcapReader : public FrameReader {
+public:
+    explicit PcapReader( const Spec& spec )
+        : reader_(spec.target)
+    {}
+
+    bool configure( const Spec& spec ){
+        const std::string protocol = spec.option("protocol");
+        if( "tcp" == protocol ){
+            reader_.set_filter_tcp();
+        }else if( "udp" == protocol ){
+            reader_.set_filter_udp();
+        }else if( ! protocol.empty() ){
+            spdlog::error("!! unrecognized protocol: '{}';  expected 'tcp' or 'udp'", protocol );
+            return false;
+        }
+
+        const std::string port_text = spec.option("port");
+        uint16_t port = 0;
+        if( port_text.empty() ){
+            return true;
+        }else if( ! parse_port(port_text, port) ){
+            spdlog::error("!! could not parse port: '{}'", port_text );
+            return false;
+        }
+        reader_.set_filter_port( port );
+        return true;
+    }
+
+    bool good() const override {
+        return reader_.good();
+    }
+
+    STATUS read( FrameBatch& frames, std::chrono::microseconds /*timeout*/ ) override {
+        const auto& chunk = reader_.next();
+        if( 0 < chunk.length ){
+            frames.append( chunk.timestamp, chunk.buffer, chunk.length );
+            return FRAME;
+        }
+        return reader_.good() ? SKIPPED : FINISHED;
+    }
+
+private:
+    readers::pcap::LogReader reader_;
+};
+
+/// \brief datagrams from a live UDP socket
+class UdpReader : public FrameReader {
+public:
+    UdpReader( const std::string& host, uint16_t port )
+        : reader_(host, port)
+    {}
+
+    bool good() const override {
+        return reader_.good();
+    }
+
+    STATUS read( FrameBatch& frames, std::chrono::microseconds timeout ) override {
+        // poll() counts whole milliseconds; round up, so a short timeout still waits, rather than spins
+        const auto& datagram = reader_.next( std::chrono::ceil<std::chrono::milliseconds>(timeout) );
+        if( 0 < datagram.length ){
+            frames.append( datagram.timestamp, datagram.buffer, datagram.length );
+            return FRAME;
+        }
+        return (0 == reader_.error()) ? SKIPPED : FAILED;
+    }
+
+private:
+    readers::udp::SocketReader reader_;
+};
+
+/// \brief one frame per line of a text log; stamped with the time it was read
+class TextReader : public FrameReader {
+public:
+    explicit TextReader( const Spec& spec )
+        : reader_(spec.target)
+    {}
+
+    bool good() const override {
+        return reader_.good();
+    }
+
+    STATUS read( FrameBatch& frames, std::chrono::microseconds /*timeout*/ ) override {
+        const std::string* line = reader_.next();
+        if( nullptr == line ){
+            return FINISHED;
+        }
+        if( line->empty() ){
+            return SKIPPED;
+        }
+        // restore the line ending the reader strips; so a line reads the same as a network frame
+        frame_.assign( *line );
+        frame_.append( "\r\n" );
+        frames.append( now_usec(), reinterpret_cast<const uint8_t*>(frame_.data()), frame_.size() );
+        return FRAME;
+    }
+
+private:
+    readers::nmea0183::TextLogReader reader_;
+    std::string frame_;
+};
+
+// ======================= Built-in Parsers ===================================
+
+/// \brief MOOS NODE_REPORTs, out of MOOS network packets
+class MoosParser : public FrameParser {
+public:
+    size_t parse( const FrameBatch::Frame& frame, std::vector<Report>& reports ) override {
+        const readers::pcap::FrameBuffer buffer{ frame.timestamp, frame.length, frame.data };
+        size_t rejected = 0;
+        uint64_t from = mark();
+        packets_.load( &buffer );
+        while( ! packets_.empty() ){
+            const std::string line = packets_.next();
+            charge( profile_.packet_nanoseconds, from );
+            if( line.empty() ){
+                // not a NODE_REPORT; filtered out, rather than rejected
+                continue;
+            }
+            ++profile_.messages;
+            Report* report = messages_.parse( line );
+            if( report ){
+                reports.push_back( *report );
+            }else{
+                ++rejected;
+            }
+            from = mark();
+        }
+        return rejected;
+    }
+
+private:
+    parsers::moos::PacketParser packets_;
+    parsers::moos::MessageParser messages_;
+};
+
+/// \brief AIS messages, out of NMEA-0183 sentences
+class AisParser : public FrameParser {
+public:
+    size_t parse( const FrameBatch::Frame& frame, std::vector<Report>& reports ) override {
+        const readers::pcap::FrameBuffer buffer{ frame.timestamp, frame.length, frame.data };
+        size_t rejected = 0;
+        uint64_t from = mark();
+        sentences_.load( &buffer );
+        while( ! sentences_.empty() ){
+            const std::string line = sentences_.next();
+            charge( profile_.packet_nanoseconds, from );
+            if( line.empty() ){
+                continue;
+            }
+            ++profile_.messages;
+            Report* report = messages_.parse( frame.timestamp, line );
+            if( report ){
+                reports.push_back( *report );
+            }else{
+                ++rejected;
+            }
+            from = mark();
+        }
+        return rejected;
+    }
+
+private:
+    parsers::nmea0183::PacketParser sentences_;
+    parsers::ais::Parser messages_;
+};
+
+// ======================= Spec ===================================
+
+std::string Spec::option( std::string_view key, std::string_view fallback ) const {
+    const auto found = options.find( key );
+    return std::string( (options.end() == found) ? fallback : std::string_view(found->second) );
+}
+
+bool Spec::parse( std::string_view text, Spec& spec ){
+    spec = Spec();
+
+    const size_t options_index = text.find(';');
+    const std::string_view head = text.substr( 0, options_index );
+    const size_t parser_end = head.find(':');
+    if( std::string_view::npos == parser_end ){
+        return false;
+    }
+    const size_t reader_end = head.find( ':', parser_end + 1 );
+    if( std::string_view::npos == reader_end ){
+        return false;
+    }
+    spec.parser = trim( head.substr(0, parser_end) );
+    spec.reader = trim( head.substr(parser_end + 1, reader_end - parser_end - 1) );
+    spec.target = trim( head.substr(reader_end + 1) );
+    if( spec.parser.empty() || spec.reader.empty() || spec.target.empty() ){
+        return false;
+    }
+
+    std::string_view rest = (std::string_view::npos == options_index) ? std::string_view() : text.substr( options_index + 1 );
+    while( ! rest.empty() ){
+        const size_t end = rest.find(';');
+        const std::string_view option = trim( rest.substr(0, end) );
+        rest = (std::string_view::npos == end) ? std::string_view() : rest.substr( end + 1 );
+        if( option.empty() ){
+            continue;
+        }
+        const size_t equals = option.find('=');
+        if( std::string_view::npos == equals ){
+            return false;
+        }
+        spec.options[std::string(trim(option.substr(0, equals)))] = trim( option.substr(equals + 1) );
+    }
+    return true;
+}
+
+// ======================= Registry ===================================
+
+Registry& Registry::global(){
+    static Registry registry;
+    return registry;
+}
+
+Registry::Registry(){
+    add_reader( "pcap", []( const Spec& spec ) -> std::unique_ptr<FrameReader> {
+        auto reader = std::make_unique<PcapReader>( spec );
+        if( ! reader->configure(spec) ){
+            return nullptr;
+        }
+        return reader;
+    });
+
+    add_reader( "udp", []( const Spec& spec ) -> std::unique_ptr<FrameReader> {
+        // "[HOST:]PORT"
+        const size_t separator = spec.target.rfind(':');
+        const std::string host = (std::string::npos == separator) ? std::string() : spec.target.substr( 0, separator );
+        const std::string port_text = (std::string::npos == separator) ? spec.target : spec.target.substr( separator + 1 );
+        uint16_t port = 0;
+        if( ! parse_port(port_text, port) ){
+            spdlog::error("!! could not parse UDP port: '{}'", port_text );
+            return nullptr;
+        }
+        return std::make_unique<UdpReader>( host, port );
+    });
+
+    add_reader( "text", []( const Spec& spec ) -> std::unique_ptr<FrameReader> {
+        return std::make_unique<TextReader>( spec );
+    });
+
+    add_parser( "moos", []( const Spec& ) -> std::unique_ptr<FrameParser> {
+        return std::make_unique<MoosParser>();
+    });
+
+    add_parser( "ais", []( const Spec& ) -> std::unique_ptr<FrameParser> {
+        return std::make_unique<AisParser>();
+    });
+}
+
+void Registry::add_reader( const std::string& name, reader_factory factory ){
+    readers_[name] = std::move(factory);
+}
+
+void Registry::add_parser( const std::string& name, parser_factory factory ){
+    parsers_[name] = std::move(factory);
+}
+
+std::vector<std::string> Registry::readers() const {
+    std::vector<std::string> names;
+    for( const auto& [name, factory] : readers_ ){
+        names.push_back( name );
+    }
+    return names;
+}
+
+std::vector<std::string> Registry::parsers() const {
+    std::vector<std::string> names;
+    for( const auto& [name, factory] : parsers_ ){
+        names.push_back( name );
+    }
+    return names;
+}
+
+std::unique_ptr<Connector> Registry::create( std::string_view text ) const {
+    Spec spec;
+    if( ! Spec::parse(text, spec) ){
+        spdlog::error("!! could not parse connector: '{}';  expected 'PARSER:READER:TARGET[;KEY=VALUE]...'", text );
+        return nullptr;
+    }
+
+    const auto reader_factory = readers_.find( spec.reader );
+    if( readers_.end() == reader_factory ){
+        spdlog::error("!! unknown reader: '{}';  in: '{}'", spec.reader, text );
+        return nullptr;
+    }
+    const auto parser_factory = parsers_.find( spec.parser );
+    if( parsers_.end() == parser_factory ){
+        spdlog::error("!! unknown parser: '{}';  in: '{}'", spec.parser, text );
+        return nullptr;
+    }
+
+    std::unique_ptr<FrameReader> reader = reader_factory->second( spec );
+    std::unique_ptr<FrameParser> parser = parser_factory->second( spec );
+    if( (! reader) || (! parser) || (! reader->good()) ){
+        spdlog::error("!! could not open connector: '{}'", text );
+        return nullptr;
+    }
+
+    const std::string name = spec.option( "name", spec.parser + ':' + spec.target );
+    return std::make_unique<Connector>( name, std::move(reader), std::move(parser) );
+}
+
+bool Registry::create( const std::vector<std::string>& specs, std::vector<std::unique_ptr<Connector>>& connectors ) const {
+    std::vector<std::unique_ptr<Connector>> created;
+    for( const std::string& spec : specs ){
+        auto connector = create( spec );
+        if( ! connector ){
+            return false;
+        }
+        created.push_back( std::move(connector) );
+    }
+    for( auto& connector : created ){
+        connectors.push_back( std::move(connector) );
+    }
+    return true;
+}
+
+bool Registry::load( const std::string& path, std::vector<std::string>& specs ){
+    std::ifstream source( path );
+    if( ! source.good() ){
+        spdlog::error("!! could not read connectors from: {}", path );
+        return false;
+    }
+
+    std::string line;
+    while( std::getline(source, line) ){
+        const std::string_view text = trim( line );
+        if( text.empty() || ('#' == text.front()) ){
+            continue;
+        }
+        specs.emplace_back( text );
+    }
+    return true;
+}
+
+}  // namespace connectors
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/connector.hpp"
+
+namespace connectors {
+
+/// \brief one connector, as text:  "PARSER:READER:TARGET[;KEY=VALUE]..."
+///
+/// e.g.
+///     moos:pcap:data/m2_berta.moos.p9000.pcap;protocol=tcp;port=9000
+///     ais:text:data/ais.nmea0183.2022-05-18.log
+///     ais:udp:0.0.0.0:4003;name=harbor
+///
+/// The target runs to the first ';' -- so it may itself contain ':'.  Every spec accepts
+/// `name=...`, for logs; the rest of the options depend on the reader.
+struct Spec {
+    std::string parser;
+    std::string reader;
+    std::string target;
+    std::map<std::string, std::string, std::less<>> options;
+
+    /// \return the option's value; or `fallback`, if absent
+    std::string option( std::string_view key, std::string_view fallback = "" ) const;
+
+    /// \return false if the text has no parser, reader, or target; or an option without a '='
+    static bool parse( std::string_view text, Spec& spec );
+};
+
+
+/// \brief named factories for frame readers, and frame parsers; so connectors are chosen at runtime
+///
+/// Built in:
+///   - readers:  "pcap" (capture file;  options: protocol=tcp|udp, port=N),
+///               "udp"  (live socket;  target: [HOST:]PORT),
+///               "text" (line-per-frame log file)
+///   - parsers:  "moos" (MOOS NODE_REPORTs),
+///               "ais"  (NMEA-0183 AIS sentences; with or without tag blocks)
+///
+/// Register more before creating connectors; creation is safe from any thread, registration is not.
+class Registry {
+public:
+    typedef std::function<std::unique_ptr<FrameReader>( const Spec& spec )> reader_factory;
+    typedef std::function<std::unique_ptr<FrameParser>( const Spec& spec )> parser_factory;
+
+public:
+    /// \brief the single, shared registry; with the built-in readers and parsers
+    static Registry& global();
+
+    /// \brief add, or replace, a reader
+    void add_reader( const std::string& name, reader_factory factory );
+
+    /// \brief add, or replace, a parser
+    void add_parser( const std::string& name, parser_factory factory );
+
+    std::vector<std::string> readers() const;
+
+    std::vector<std::string> parsers() const;
+
+    /// \return a connector; or nullptr, if the spec is malformed, names an unknown reader or parser,
+    ///         or its source cannot be opened.  (each logged)
+    std::unique_ptr<Connector> create( std::string_view text ) const;
+
+    /// \brief create a connector for every spec; all or nothing
+    /// \param connectors appended to
+    /// \return false if any spec fails.  (see: `create`)
+    bool create( const std::vector<std::string>& specs, std::vector<std::unique_ptr<Connector>>& connectors ) const;
+
+    /// \brief read specs from a file: one per line; skipping blank lines and '#' comments
+    /// \param specs appended to
+    /// \return false if the file cannot be read
+    static bool load( const std::string& path, std::vector<std::string>& specs );
+
+private:
+    Registry();
+
+private:
+    std::map<std::string, reader_factory, std::less<>> readers_;
+    std::map<std::string, parser_factory, std::less<>> parsers_;
+
+};
+
+}  // namespace connectors
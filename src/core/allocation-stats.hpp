@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+/// \brief counters for a pooled allocator; for monitoring memory growth
+///
+/// In steady state, `blocks` and `reserved` stay flat: new objects reuse released ones.
+struct AllocationStats {
+    /// \brief underlying heap allocations made by the pool (slabs, chunks)
+    size_t blocks = 0;
+
+    /// \brief bytes held by those blocks
+    size_t reserved = 0;
+
+    /// \brief bytes currently handed out
+    size_t used = 0;
+
+    /// \brief objects currently live
+    size_t live = 0;
+
+    /// \brief objects handed out / returned over the pool's lifetime
+    size_t allocations = 0;
+    size_t releases = 0;
+};
@@ -0,0 +1,343 @@
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint.hpp"
+#include "flat-index.hpp"
+#include "name-table.hpp"
+
+constexpr static char checkpoint_magic[8] = {'T','R','A','C','K','C','K','P'};
+
+// ====== CRC-32 ======
+
+static constexpr std::array<uint32_t, 256> make_crc_table(){
+    std::array<uint32_t, 256> table{};
+    for( uint32_t i = 0; i < 256; ++i ){
+        uint32_t crc = i;
+        for( int bit = 0; bit < 8; ++bit ){
+            crc = (crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr static std::array<uint32_t, 256> crc_table = make_crc_table();
+
+uint32_t Checkpoint::crc32( const void* data, size_t bytes, uint32_t crc ){
+    const uint8_t* cursor = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for( size_t i = 0; i < bytes; ++i ){
+        crc = crc_table[(crc ^ cursor[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// ====== Write ======
+
+bool Checkpoint::write( const TrackSnapshot& snapshot, const std::string& path ){
+    const std::string temporary = path + ".tmp";
+    FILE* file = fopen( temporary.c_str(), "wb" );
+    if( nullptr == file ){
+        fprintf( stderr, "!! could not open checkpoint for writing: %s\n", temporary.c_str() );
+        return false;
+    }
+
+    // every section after the header goes through here; so the CRC is computed as it is written
+    uint32_t crc = 0;
+    bool good = true;
+    const auto emit = [&]( const void* data, size_t bytes ){
+        if( good && (0 < bytes) ){
+            crc = crc32( data, bytes, crc );
+            good = (bytes == fwrite(data, 1, bytes, file));
+        }
+    };
+
+    // placeholder; rewritten once the counts and CRC are known
+    CheckpointHeader header{};
+    good = (1 == fwrite( &header, sizeof(header), 1, file ));
+
+    // .1. records; and the set of names they reference
+    FlatIndex seen;
+    std::vector<uint32_t> handles;
+    const bool with_history = (snapshot.history_end.size() == snapshot.reports.size());
+    uint32_t begin = 0;
+    for( size_t i = 0; i < snapshot.reports.size(); ++i ){
+        const Report& report = snapshot.reports[i];
+        const uint32_t end = with_history ? snapshot.history_end[i] : 0;
+
+        CheckpointRecord record{};
+        record.id = report.id;
+        record.timestamp = report.timestamp;
+        record.latitude = report.latitude;
+        record.longitude = report.longitude;
+        record.easting = report.easting;
+        record.northing = report.northing;
+        record.heading = report.heading;
+        record.course = report.course;
+        record.speed = report.speed;
+        record.name = report.name;
+        record.station = report.station;
+        record.samples = end - begin;
+        record.fields = report.fields;
+        record.source = report.source;
+        record.status = report.status;
+        record.stale = snapshot.stale[i];
+        emit( &record, sizeof(record) );
+        begin = end;
+
+        for( const uint32_t handle : {report.name, report.station} ){
+            if( (0 != handle) && seen.insert(handle, 0).second ){
+                handles.push_back( handle );
+            }
+        }
+    }
+
+    // .2. history
+    const size_t sample_count = with_history ? snapshot.history.size() : 0;
+    emit( snapshot.history.data(), sample_count * sizeof(CheckpointSample) );
+
+    // .3. names: the index, then the text
+    uint64_t offset = 0;
+    for( const uint32_t handle : handles ){
+        const std::string_view text = NameTable::global().lookup( handle );
+        const CheckpointName name = { handle, static_cast<uint32_t>(text.size()), offset };
+        emit( &name, sizeof(name) );
+        offset += text.size();
+    }
+    for( const uint32_t handle : handles ){
+        const std::string_view text = NameTable::global().lookup( handle );
+        emit( text.data(), text.size() );
+    }
+
+    // .4. header
+    std::memcpy( header.magic, checkpoint_magic, sizeof(header.magic) );
+    header.format = format;
+    header.crc = crc;
+    header.version = snapshot.version;
+    header.origin_latitude = snapshot.origin_latitude;
+    header.origin_longitude = snapshot.origin_longitude;
+    header.track_count = snapshot.reports.size();
+    header.sample_count = sample_count;
+    header.name_count = handles.size();
+    header.text_bytes = offset;
+    good = good && (0 == fseek(file, 0, SEEK_SET)) && (1 == fwrite(&header, sizeof(header), 1, file));
+
+    // durable before it replaces the previous checkpoint
+    good = good && (0 == fflush(file)) && (0 == fsync(fileno(file)));
+    good = (0 == fclose(file)) && good;
+    if( ! good ){
+        fprintf( stderr, "!! could not write checkpoint: %s\n", temporary.c_str() );
+        unlink( temporary.c_str() );
+        return false;
+    }
+
+    if( 0 != rename(temporary.c_str(), path.c_str()) ){
+        fprintf( stderr, "!! could not move checkpoint into place: %s\n", path.c_str() );
+        unlink( temporary.c_str() );
+        return false;
+    }
+    return true;
+}
+
+// ====== Load ======
+
+/// \brief read-only mapping of a whole file; unmapped on destruction
+class MappedFile {
+public:
+    explicit MappedFile( const std::string& path ){
+        const int descriptor = open( path.c_str(), O_RDONLY );
+        if( descriptor < 0 ){
+            return;
+        }
+        struct stat status;
+        if( (0 == fstat(descriptor, &status)) && (0 < status.st_size) ){
+            void* mapped = mmap( nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+            if( MAP_FAILED != mapped ){
+                data = static_cast<const uint8_t*>(mapped);
+                size = status.st_size;
+                // read front-to-back, exactly once
+                madvise( mapped, size, MADV_SEQUENTIAL );
+            }
+        }
+        close( descriptor );
+    }
+
+    ~MappedFile(){
+        if( nullptr != data ){
+            munmap( const_cast<uint8_t*>(data), size );
+        }
+    }
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+size_t Checkpoint::load( const std::string& path, TrackCache& cache ){
+    const MappedFile file( path );
+    if( nullptr == file.data ){
+        return 0;
+    }
+
+    // .1. validate: header, sizes, then checksum -- before touching the cache
+    if( file.size < sizeof(CheckpointHeader) ){
+        fprintf( stderr, "!! checkpoint is truncated; skipping: %s\n", path.c_str() );
+        return 0;
+    }
+    CheckpointHeader header;
+    std::memcpy( &header, file.data, sizeof(header) );
+    if( (0 != std::memcmp(header.magic, checkpoint_magic, sizeof(header.magic))) || (format != header.format) ){
+        fprintf( stderr, "!! not a checkpoint, or an unsupported format; skipping: %s\n", path.c_str() );
+        return 0;
+    }
+
+    // each count is bounded by the file size first; so the sum below cannot overflow
+    const size_t body = file.size - sizeof(header);
+    if( (body / sizeof(CheckpointRecord) < header.track_count)
+            || (body / sizeof(CheckpointSample) < header.sample_count)
+            || (body / sizeof(CheckpointName) < header.name_count)
+            || (body < header.text_bytes)
+            || (body != header.track_count * sizeof(CheckpointRecord) + header.sample_count * sizeof(CheckpointSample)
+                        + header.name_count * sizeof(CheckpointName) + header.text_bytes) ){
+        fprintf( stderr, "!! checkpoint size does not match its header; skipping: %s\n", path.c_str() );
+        return 0;
+    }
+
+    const uint8_t* cursor = file.data + sizeof(header);
+    if( header.crc != crc32(cursor, body) ){
+        fprintf( stderr, "!! checkpoint failed its checksum; skipping: %s\n", path.c_str() );
+        return 0;
+    }
+
+    // every section is a multiple of 8 bytes, up to the text; and mmap is page-aligned: so these casts are aligned
+    const CheckpointRecord* const records = reinterpret_cast<const CheckpointRecord*>(cursor);
+    cursor += header.track_count * sizeof(CheckpointRecord);
+    const CheckpointSample* const samples = reinterpret_cast<const CheckpointSample*>(cursor);
+    cursor += header.sample_count * sizeof(CheckpointSample);
+    const CheckpointName* const names = reinterpret_cast<const CheckpointName*>(cursor);
+    cursor += header.name_count * sizeof(CheckpointName);
+    const char* const text = reinterpret_cast<const char*>(cursor);
+
+    // .2. re-intern names: old handle => new handle
+    FlatIndex handles;
+    handles.reserve( header.name_count );
+    for( size_t i = 0; i < header.name_count; ++i ){
+        const CheckpointName& name = names[i];
+        if( (0 == name.handle) || (header.text_bytes < name.offset) || (header.text_bytes - name.offset < name.length) ){
+            continue;
+        }
+        handles.insert( name.handle, NameTable::global().intern({text + name.offset, name.length}) );
+    }
+    const auto remap = [&]( uint32_t handle ) -> uint32_t {
+        const uint32_t found = (0 == handle) ? FlatIndex::npos : handles.find(handle);
+        return (FlatIndex::npos == found) ? 0 : found;
+    };
+
+    // .3. history is in the checkpoint's local frame; only usable if the cache shares it
+    double latitude, longitude;
+    const bool same_frame = (! cache.origin(latitude, longitude))
+                         || ((latitude == header.origin_latitude) && (longitude == header.origin_longitude));
+    if( (0 < header.sample_count) && (! same_frame) ){
+        fprintf( stderr, "!! checkpoint has a different origin; skipping its history: %s\n", path.c_str() );
+    }
+
+    // .4. restore
+    cache.reserve( cache.size() + header.track_count );
+    size_t restored = 0;
+    uint64_t sample_offset = 0;
+    for( size_t i = 0; i < header.track_count; ++i ){
+        const CheckpointRecord& record = records[i];
+        if( header.sample_count - sample_offset < record.samples ){
+            // inconsistent counts; despite a good checksum
+            break;
+        }
+
+        Report report;
+        report.id = record.id;
+        report.timestamp = record.timestamp;
+        report.latitude = record.latitude;
+        report.longitude = record.longitude;
+        report.easting = record.easting;
+        report.northing = record.northing;
+        report.heading = record.heading;
+        report.course = record.course;
+        report.speed = record.speed;
+        report.name = remap( record.name );
+        report.station = remap( record.station );
+        report.fields = record.fields;
+        report.source = static_cast<Report::SOURCE_SENSOR>( (record.source <= Report::VISUAL) ? record.source : Report::UNKNOWN );
+        report.status = record.status;
+
+        const std::span<const CheckpointSample> history( samples + sample_offset, same_frame ? record.samples : 0 );
+        sample_offset += record.samples;
+
+        restored += cache.restore( report, 0 != record.stale, history );
+    }
+
+    return restored;
+}
+
+// ====== CheckpointWriter ======
+
+CheckpointWriter::CheckpointWriter( const std::string& path )
+    : path_(path)
+    , stop_(false)
+    , written_(0)
+    , failed_(0)
+    , worker_( &CheckpointWriter::run, this )
+{}
+
+CheckpointWriter::~CheckpointWriter(){
+    {
+        std::lock_guard lock(guard_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+void CheckpointWriter::submit( std::shared_ptr<const TrackSnapshot> snapshot ){
+    {
+        std::lock_guard lock(guard_);
+        pending_ = std::move(snapshot);
+    }
+    wake_.notify_one();
+}
+
+size_t CheckpointWriter::written() const {
+    return written_.load();
+}
+
+size_t CheckpointWriter::failed() const {
+    return failed_.load();
+}
+
+void CheckpointWriter::run(){
+    std::unique_lock lock(guard_);
+    while( true ){
+        wake_.wait( lock, [this]{ return stop_ || pending_; } );
+        if( ! pending_ ){
+            // stopping, with nothing left to write
+            return;
+        }
+
+        std::shared_ptr<const TrackSnapshot> snapshot = std::move(pending_);
+        pending_.reset();
+
+        // write without the lock; so `submit` never waits on the disk
+        lock.unlock();
+        if( Checkpoint::write(*snapshot, path_) ){
+            ++written_;
+        }else{
+            ++failed_;
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "track-cache.hpp"
+#include "track-snapshot.hpp"
+
+// ====== On-Disk Layout ======
+//
+// Native byte order; one file per checkpoint:
+//
+//     CheckpointHeader
+//     CheckpointRecord[track_count]         sorted by id
+//     CheckpointSample[sample_count]        each track's history, oldest first, in record order
+//     CheckpointName[name_count]
+//     char[text_bytes]                      name text; unterminated
+//
+// Names are NameTable handles, which are only meaningful within one process: so every handle
+// referenced by a record is written out with its text, and re-interned on load.
+
+/// \brief first bytes of every checkpoint file
+struct CheckpointHeader {
+    char magic[8];
+    /// \brief layout version; see: `Checkpoint::format`
+    uint32_t format;
+    /// \brief CRC-32 of every byte after the header
+    uint32_t crc;
+
+    /// \brief cache version at capture
+    uint64_t version;
+
+    /// \brief origin of the records' local frame; NaN if none
+    double origin_latitude;
+    double origin_longitude;
+
+    uint64_t track_count;
+    uint64_t sample_count;
+    uint64_t name_count;
+    uint64_t text_bytes;
+};
+static_assert( 72 == sizeof(CheckpointHeader) );
+static_assert( std::is_trivially_copyable_v<CheckpointHeader> );
+
+/// \brief one track: its merged report, stale flag, and number of history samples
+struct CheckpointRecord {
+    uint64_t id;
+    uint64_t timestamp;
+    double latitude;
+    double longitude;
+    float easting;
+    float northing;
+    float heading;
+    float course;
+    float speed;
+    /// \brief NameTable handles, as written; see: CheckpointName
+    uint32_t name;
+    uint32_t station;
+    uint32_t samples;
+    uint16_t fields;
+    uint8_t source;
+    uint8_t status;
+    uint8_t stale;
+    uint8_t reserved[3];
+};
+static_assert( 72 == sizeof(CheckpointRecord) );
+static_assert( std::is_trivially_copyable_v<CheckpointRecord> );
+
+typedef TrackSnapshot::Sample CheckpointSample;
+static_assert( 24 == sizeof(CheckpointSample) );
+static_assert( std::is_trivially_copyable_v<CheckpointSample> );
+
+/// \brief one interned name: its handle when written, and its text
+struct CheckpointName {
+    uint32_t handle;
+    uint32_t length;
+    /// \brief offset into the text section
+    uint64_t offset;
+};
+static_assert( 16 == sizeof(CheckpointName) );
+static_assert( std::is_trivially_copyable_v<CheckpointName> );
+
+
+/// \brief compact binary checkpoint of a TrackCache; for a warm start
+class Checkpoint {
+public:
+    constexpr static uint32_t format = 1;
+
+public:
+    /// \brief write the snapshot to `path`
+    ///
+    /// Writes a temporary file alongside, then renames it into place: so a crash mid-write
+    /// leaves the previous checkpoint intact.  Safe to call from any thread.
+    /// \return false on any I/O error
+    static bool write( const TrackSnapshot& snapshot, const std::string& path );
+
+    /// \brief restore every track in the checkpoint into the cache
+    ///
+    /// The file is mapped, not read.  A missing, truncated, corrupt (by CRC), or incompatible
+    /// file is skipped, and leaves the cache untouched.  History is restored only if the
+    /// checkpoint's origin matches the cache's; or the cache has none.
+    /// \return number of tracks restored; 0 if skipped
+    static size_t load( const std::string& path, TrackCache& cache );
+
+    /// \brief CRC-32 (IEEE 802.3)
+    /// \param crc previous result, to continue a running checksum
+    static uint32_t crc32( const void* data, size_t bytes, uint32_t crc = 0 );
+};
+
+
+/// \brief writes checkpoints on its own thread; so that ingest never waits on the disk
+///
+/// Ingest captures a snapshot (see: `TrackCache::capture`) and submits it; the writer writes
+/// the latest submitted snapshot, and drops any it did not get to in time.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter( const std::string& path );
+    CheckpointWriter( const CheckpointWriter& ) = delete;
+    CheckpointWriter& operator=( const CheckpointWriter& ) = delete;
+
+    /// \brief writes any snapshot still pending; then stops
+    ~CheckpointWriter();
+
+    /// \brief queue the snapshot for writing; replaces any snapshot not yet written
+    ///
+    /// Never blocks on I/O.
+    void submit( std::shared_ptr<const TrackSnapshot> snapshot );
+
+    /// \return number of checkpoints written successfully
+    size_t written() const;
+
+    /// \return number of checkpoints which failed to write
+    size_t failed() const;
+
+private:
+    void run();
+
+private:
+    const std::string path_;
+
+    std::mutex guard_;
+    std::condition_variable wake_;
+    std::shared_ptr<const TrackSnapshot> pending_;
+    bool stop_;
+
+    std::atomic<size_t> written_;
+    std::atomic<size_t> failed_;
+
+    // last: so the thread starts after every other member is ready
+    std::thread worker_;
+
+};
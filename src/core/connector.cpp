@@ -0,0 +1,95 @@
+#include "connector.hpp"
+
+/// \brief each counter has one writer; so a load and a store, not a locked add
+static inline void add( std::atomic<uint64_t>& counter, uint64_t amount ){
+    counter.store( counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed );
+}
+
+// ====== FrameParser ======
+
+void FrameParser::set_profiling( bool enable ){
+    profiling_ = enable;
+}
+
+const ParseProfile& FrameParser::profile() const {
+    return profile_;
+}
+
+// ====== Connector ======
+
+Connector::Connector( std::string name, std::unique_ptr<FrameReader> reader, std::unique_ptr<FrameParser> parser )
+    : name_(std::move(name))
+    , reader_(std::move(reader))
+    , parser_(std::move(parser))
+    , limit_(0)
+    , frames_(0)
+    , bytes_(0)
+    , read_errors_(0)
+    , reports_(0)
+    , rejected_(0)
+{}
+
+const std::string& Connector::name() const {
+    return name_;
+}
+
+bool Connector::good() const {
+    return reader_ && parser_ && reader_->good();
+}
+
+void Connector::set_limit( uint64_t frames ){
+    limit_ = frames;
+}
+
+bool Connector::read( FrameBatch& frames, std::chrono::microseconds timeout ){
+    const uint64_t count = frames_.load( std::memory_order_relaxed );
+    if( (0 < limit_) && (limit_ <= count) ){
+        return false;
+    }
+
+    const size_t bytes = frames.bytes();
+    switch( reader_->read(frames, timeout) ){
+        case FrameReader::FRAME:
+            add( frames_, 1 );
+            add( bytes_, frames.bytes() - bytes );
+            return true;
+        case FrameReader::SKIPPED:
+            return true;
+        case FrameReader::FAILED:
+            add( read_errors_, 1 );
+            return true;
+        case FrameReader::FINISHED:
+            break;
+    }
+    return false;
+}
+
+void Connector::parse( FrameBatch& frames, std::vector<Report>& reports ){
+    const size_t before = reports.size();
+    size_t rejected = 0;
+    for( size_t index = 0; index < frames.size(); ++index ){
+        rejected += parser_->parse( frames[index], reports );
+    }
+    add( reports_, reports.size() - before );
+    if( 0 < rejected ){
+        add( rejected_, rejected );
+    }
+}
+
+ConnectorStats Connector::stats() const {
+    ConnectorStats stats;
+    stats.frames = frames_.load( std::memory_order_relaxed );
+    stats.bytes = bytes_.load( std::memory_order_relaxed );
+    stats.reports = reports_.load( std::memory_order_relaxed );
+    stats.errors = read_errors_.load( std::memory_order_relaxed );
+    stats.rejected = rejected_.load( std::memory_order_relaxed );
+    return stats;
+}
+
+void Connector::set_profiling( bool enable ){
+    parser_->set_profiling( enable );
+}
+
+const ParseProfile& Connector::profile() const {
+    return parser_->profile();
+}
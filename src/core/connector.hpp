@@ -1,6 +1,157 @@
 #pragma once
 
-class ConnectorTemplate {
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ingest-pipeline.hpp"
+#include "report.hpp"
+
+/// \brief reads raw frames from one source: e.g. a capture file, a socket, or a text log
+///
+/// Called from one thread only: the source's read stage.
+class FrameReader {
+public:
+    enum STATUS : uint8_t {
+        /// appended a frame to the batch
+        FRAME = 0,
+        /// nothing to append: e.g. filtered traffic, or no data yet
+        SKIPPED = 1,
+        /// read a bad frame, and skipped it; counted as an error
+        FAILED = 2,
+        /// the source is exhausted, or broken for good
+        FINISHED = 3
+    };
+
+public:
+    virtual ~FrameReader() = default;
+
+    /// \return false if the source could not be opened
+    virtual bool good() const = 0;
+
+    /// \brief copy (at most) the next frame onto the end of the batch
+    /// \param timeout longest to wait for a frame to arrive; sources which never wait (e.g. files) ignore it
+    virtual STATUS read( FrameBatch& frames, std::chrono::microseconds timeout ) = 0;
+};
+
+
+/// \brief what a parser has seen; and, while profiling, where its time went  (see: `ingest --bench`)
+struct ParseProfile {
+    /// \brief messages split out of frames, and handed to the message parser; lines the packet parser filters out are not counted
+    uint64_t messages = 0;
+    /// \brief time spent splitting frames into messages; only counted while profiling
+    uint64_t packet_nanoseconds = 0;
+};
+
+
+/// \brief turns one frame into track reports: e.g. MOOS NODE_REPORTs, or NMEA/AIS sentences
+///
+/// Called from one thread only: the source's parse stage.
+class FrameParser {
+public:
+    virtual ~FrameParser() = default;
+
+    /// \brief append every report in the frame
+    /// \return number of messages rejected: malformed, or of a type the parser does not support
+    virtual size_t parse( const FrameBatch::Frame& frame, std::vector<Report>& reports ) = 0;
+
+    /// \brief time each step of `parse`; off by default, since it costs a clock read per message
+    void set_profiling( bool enable );
+
+    const ParseProfile& profile() const;
+
+protected:
+    /// \return a mark to `charge` from; or 0, if not profiling
+    uint64_t mark() const {
+        return profiling_ ? clock_nanoseconds() : 0;
+    }
+
+    /// \brief while profiling: add the time since `from` to `bucket`; and restart `from`
+    void charge( uint64_t& bucket, uint64_t& from ) const {
+        if( profiling_ ){
+            const uint64_t now = clock_nanoseconds();
+            bucket += now - from;
+            from = now;
+        }
+    }
+
+    static uint64_t clock_nanoseconds(){
+        return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count() );
+    }
+
+protected:
+    bool profiling_ = false;
+    ParseProfile profile_;
+};
+
+
+/// \brief counters for one connector; each read independently, so only approximately consistent
+struct ConnectorStats {
+    /// \brief frames read; and their payload bytes
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    /// \brief reports parsed out of those frames
+    uint64_t reports = 0;
+    /// \brief bad frames; e.g. failed receives
+    uint64_t errors = 0;
+    /// \brief messages the parser rejected.  (see: `FrameParser::parse`)
+    uint64_t rejected = 0;
+};
+
+
+/// \brief one input feed: a reader, and the parser for what it reads
+///
+/// Connectors are built at runtime, from a spec (see: `connectors::Registry`), and any number of
+/// them may feed one IngestPipeline (see: `IngestPipeline::add_source`): `read` then runs on the
+/// connector's read thread, and `parse` on its parse thread.  Each counts its own traffic.
+class Connector {
 public:
+    Connector( std::string name, std::unique_ptr<FrameReader> reader, std::unique_ptr<FrameParser> parser );
+    Connector( const Connector& ) = delete;
+    Connector& operator=( const Connector& ) = delete;
+
+    /// \brief as given in the connector's spec; for logs
+    const std::string& name() const;
+
+    /// \return false if the reader could not open its source
+    bool good() const;
+
+    /// \brief stop after this many frames; 0 => never (default)
+    void set_limit( uint64_t frames );
+
+    /// \brief read stage: append (at most) one frame to the batch
+    /// \param timeout longest to wait for a frame to arrive.  (see: `FrameReader::read`)
+    /// \return false once the source is exhausted
+    bool read( FrameBatch& frames, std::chrono::microseconds timeout = std::chrono::milliseconds(100) );
+
+    /// \brief parse stage: append every report in the batch's frames
+    void parse( FrameBatch& frames, std::vector<Report>& reports );
+
+    ConnectorStats stats() const;
+
+    /// \brief profile the parser; see: `FrameParser::set_profiling`.  Call before parsing starts.
+    void set_profiling( bool enable );
+
+    /// \brief the parser's profile; read on the parse thread, or after it finishes
+    const ParseProfile& profile() const;
+
+private:
+    const std::string name_;
+    std::unique_ptr<FrameReader> reader_;
+    std::unique_ptr<FrameParser> parser_;
+    uint64_t limit_;
+
+    // written by the read thread
+    alignas(64) std::atomic<uint64_t> frames_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> read_errors_;
+
+    // written by the parse thread
+    alignas(64) std::atomic<uint64_t> reports_;
+    std::atomic<uint64_t> rejected_;
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "flat-index.hpp"
+#include "track.hpp"
+#include "track-cache.hpp"
+
+/// \brief one pair of tracks predicted to pass within the distance threshold
+struct CpaPair {
+    /// \brief track ids; `first` < `second`
+    uint64_t first;
+    uint64_t second;
+
+    /// \brief time of closest approach (usec; same clock as report timestamps)
+    uint64_t time;
+
+    /// \brief separation at closest approach (meters)
+    float distance;
+
+    /// \brief separation at the time the pair was computed (meters)
+    float range;
+};
+
+/// \brief immutable, point-in-time copy of every pair below the thresholds
+///
+/// Published by the CpaEngine's thread, and read by any other -- e.g. the UI -- without locks.
+class CpaSnapshot {
+public:
+    /// \return the closest pair involving the given track; nullptr if none
+    const CpaPair* closest( uint64_t id ) const;
+
+public:
+    /// \brief latest report timestamp seen, at the time of the pass (usec)
+    uint64_t clock = 0;
+
+    /// \brief sorted by distance, nearest first
+    std::vector<CpaPair> pairs;
+
+    /// \brief maps track id => index of its closest pair
+    FlatIndex by_track;
+
+};
+
+/// \brief closest-point-of-approach screening over every track in a cache
+///
+/// Each track moves in a straight line from its latest local position, along its latest
+/// course and speed; tracks without course or speed are treated as stationary.  For each pair,
+/// the engine finds the minimum separation within the horizon, and keeps the pairs whose
+/// minimum falls below the distance threshold.
+///
+/// - candidates are pruned with the cache's spatial index: a track can only come within
+///   `max_distance` of another within `horizon` if it is already within
+///   `max_distance + horizon * (its speed + max_speed)`.
+/// - each pass recomputes only the tracks which moved since the previous pass (see: `TrackCache::changes_since`),
+///   against all of their candidates; pairs between unchanged tracks are kept as-is.
+/// - the candidates of each track are batched into parallel arrays, for a vectorizable kernel.
+///
+/// Not thread-safe: call `update` from the thread that updates the cache.  `snapshot` is safe from any thread.
+class CpaEngine {
+public:
+    typedef std::function<bool(const Track&)> track_filter;
+
+public:
+    explicit CpaEngine( const TrackCache& cache );
+    CpaEngine( const CpaEngine& ) = delete;
+    CpaEngine& operator=( const CpaEngine& ) = delete;
+
+    ~CpaEngine() = default;
+
+    /// \param max_distance report pairs passing within this distance (meters)
+    /// \param horizon only look this far ahead (usec)
+    /// \param max_speed assumed upper bound on any track's speed, for pruning (meters-per-second)
+    ///
+    /// Forgets every pair; the next pass recomputes every track.
+    void configure( float max_distance, uint64_t horizon, float max_speed = 25.f );
+
+    /// \brief only report pairs where at least one track passes the filter -- e.g. our own vehicles
+    ///
+    /// An empty filter (default) => screen every pair.  Forgets every pair, as above.
+    void set_filter( track_filter filter );
+
+    /// \brief recompute the tracks updated since the last pass; then publish, if anything changed
+    /// \return number of tracks recomputed
+    size_t update();
+
+    /// \brief every pair below the thresholds, as of the last pass
+    /// \param out reusable buffer; cleared, then filled nearest-first
+    size_t pairs( std::vector<CpaPair>& out ) const;
+
+    /// \brief the pairs involving one track, as of the last pass
+    /// \param out reusable buffer; cleared, then filled nearest-first
+    size_t pairs( uint64_t id, std::vector<CpaPair>& out ) const;
+
+    /// \brief latest published results
+    std::shared_ptr<const CpaSnapshot> snapshot() const;
+
+    float max_distance() const;
+
+    uint64_t horizon() const;
+
+private:
+    /// \brief clear every pair; so that the next pass recomputes every track
+    void reset();
+
+    /// \brief compute every pair between `track` and its candidates; append those below the thresholds
+    void screen( const Track& track );
+
+    /// \brief fill `batch_` from the given candidates; relative to `track`
+    void load( const Track& track, const std::vector<const Track*>& candidates );
+
+    /// \brief minimum separation within the horizon, for every entry in `batch_`
+    void kernel( float east_velocity, float north_velocity );
+
+    void publish();
+
+private:
+    /// \brief structure-of-arrays batch: one lane per candidate
+    struct Batch {
+        std::vector<uint64_t> ids;
+        /// seconds from the track's timestamp to the candidate's
+        std::vector<float> dt;
+        std::vector<float> easting;
+        std::vector<float> northing;
+        std::vector<float> east_velocity;
+        std::vector<float> north_velocity;
+
+        // outputs
+        std::vector<float> distance_squared;
+        std::vector<float> range_squared;
+        /// seconds from the track's timestamp to closest approach
+        std::vector<float> time;
+
+        void clear();
+        void resize( size_t count );
+        size_t size() const;
+    };
+
+    const TrackCache& cache;
+
+    float max_distance_;
+    float horizon_seconds;
+    float max_speed_;
+    track_filter filter_;
+
+    /// cache version at the last pass
+    uint64_t version_;
+
+    /// latest report timestamp seen (usec)
+    uint64_t clock_;
+
+    std::vector<CpaPair> pairs_;
+
+    /// pairs changed since the last publish
+    bool dirty_;
+
+    // scratch; reused by every pass
+    std::vector<const Track*> changed_;
+    FlatIndex changed_ids_;
+    std::vector<const Track*> candidates_;
+    Batch batch_;
+
+    std::atomic<std::shared_ptr<const CpaSnapshot>> published_;
+
+};
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+#include "event-bus.hpp"
+
+// ====== EventQueue ======
+
+EventQueue::EventQueue( size_t capacity )
+    : mask_( std::bit_ceil(std::max<size_t>(capacity, 2)) - 1 )
+    , cells_( new Cell[mask_ + 1] )
+    , enqueue_(0)
+    , dequeue_(0)
+{
+    for( size_t i = 0; i <= mask_; ++i ){
+        cells_[i].sequence.store( i, std::memory_order_relaxed );
+    }
+}
+
+bool EventQueue::push( const TrackEvent& event ){
+    size_t position = enqueue_.load( std::memory_order_relaxed );
+    while( true ){
+        Cell& cell = cells_[position & mask_];
+        const size_t sequence = cell.sequence.load( std::memory_order_acquire );
+        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if( 0 == difference ){
+            // the cell is free; claim it
+            if( enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) ){
+                cell.event = event;
+                cell.sequence.store( position + 1, std::memory_order_release );
+                return true;
+            }
+        }else if( difference < 0 ){
+            // the cell still holds an event from one lap ago: full
+            return false;
+        }else{
+            // another producer claimed it first
+            position = enqueue_.load( std::memory_order_relaxed );
+        }
+    }
+}
+
+bool EventQueue::pop( TrackEvent& event ){
+    size_t position = dequeue_.load( std::memory_order_relaxed );
+    while( true ){
+        Cell& cell = cells_[position & mask_];
+        const size_t sequence = cell.sequence.load( std::memory_order_acquire );
+        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+        if( 0 == difference ){
+            if( dequeue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) ){
+                event = cell.event;
+                // free for the producers' next lap
+                cell.sequence.store( position + mask_ + 1, std::memory_order_release );
+                return true;
+            }
+        }else if( difference < 0 ){
+            // empty
+            return false;
+        }else{
+            position = dequeue_.load( std::memory_order_relaxed );
+        }
+    }
+}
+
+size_t EventQueue::size() const {
+    const size_t dequeued = dequeue_.load( std::memory_order_relaxed );
+    const size_t enqueued = enqueue_.load( std::memory_order_relaxed );
+    return (dequeued < enqueued) ? (enqueued - dequeued) : 0;
+}
+
+size_t EventQueue::capacity() const {
+    return mask_ + 1;
+}
+
+// ====== Subscription ======
+
+/// \brief add to a counter with a single writer; a plain load and store, rather than a locked read-modify-write
+static inline void bump( std::atomic<uint64_t>& counter, uint64_t amount = 1 ){
+    counter.store( counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed );
+}
+
+Subscription::Subscription( size_t capacity, POLICY policy, uint8_t types, std::chrono::microseconds timeout )
+    : queue_(capacity)
+    , policy_(policy)
+    , types_(types)
+    , timeout_(timeout)
+    , stalled_(false)
+    , held_head_(0)
+    , published_(0)
+    , delivered_(0)
+    , dropped_(0)
+    , coalesced_(0)
+    , blocked_(0)
+    , max_depth_(0)
+    , pending_(0)
+{}
+
+bool Subscription::pop( TrackEvent& event ){
+    if( ! queue_.pop(event) ){
+        return false;
+    }
+    bump( delivered_ );
+    return true;
+}
+
+size_t Subscription::drain( std::vector<TrackEvent>& out, size_t limit ){
+    out.clear();
+    TrackEvent event;
+    while( (out.size() < limit) && queue_.pop(event) ){
+        out.push_back( event );
+    }
+    bump( delivered_, out.size() );
+    return out.size();
+}
+
+SubscriptionStats Subscription::stats() const {
+    SubscriptionStats stats;
+    stats.published = published_.load( std::memory_order_relaxed );
+    stats.delivered = delivered_.load( std::memory_order_relaxed );
+    stats.dropped = dropped_.load( std::memory_order_relaxed );
+    stats.coalesced = coalesced_.load( std::memory_order_relaxed );
+    stats.blocked = blocked_.load( std::memory_order_relaxed );
+    stats.depth = queue_.size();
+    stats.max_depth = max_depth_.load( std::memory_order_relaxed );
+    stats.pending = pending_.load( std::memory_order_relaxed );
+    return stats;
+}
+
+Subscription::POLICY Subscription::policy() const {
+    return policy_;
+}
+
+uint8_t Subscription::types() const {
+    return types_;
+}
+
+void Subscription::note_depth(){
+    // only the publisher writes; so no CAS loop
+    const size_t depth = queue_.size();
+    if( max_depth_.load(std::memory_order_relaxed) < depth ){
+        max_depth_.store( depth, std::memory_order_relaxed );
+    }
+}
+
+void Subscription::offer( const TrackEvent& event ){
+    switch( policy_ ){
+        case DROP_OLDEST: {
+            TrackEvent discard;
+            while( ! queue_.push(event) ){
+                // the consumer may pop concurrently; either way, there is room on the next try
+                if( queue_.pop(discard) ){
+                    bump( dropped_ );
+                }
+            }
+            break;
+        }
+
+        case COALESCE:
+            // order is kept per queue: nothing may overtake the held-back events
+            if( (! release()) || (! queue_.push(event)) ){
+                hold( event );
+                return;
+            }
+            break;
+
+        case BLOCK:
+            if( queue_.push(event) ){
+                stalled_ = false;
+            }else if( stalled_ ){
+                bump( dropped_ );
+                return;
+            }else{
+                bump( blocked_ );
+                const auto deadline = std::chrono::steady_clock::now() + timeout_;
+                bool queued = false;
+                while( (! queued) && (std::chrono::steady_clock::now() < deadline) ){
+                    std::this_thread::yield();
+                    queued = queue_.push( event );
+                }
+                if( ! queued ){
+                    stalled_ = true;
+                    bump( dropped_ );
+                    return;
+                }
+            }
+            break;
+    }
+
+    bump( published_ );
+    note_depth();
+}
+
+bool Subscription::release(){
+    if( held_head_ == held_.size() ){
+        return true;
+    }
+
+    size_t released = 0;
+    while( (held_head_ < held_.size()) && queue_.push(held_[held_head_]) ){
+        held_index_.erase( held_[held_head_].report.id );
+        ++held_head_;
+        ++released;
+    }
+    if( 0 < released ){
+        bump( published_, released );
+        note_depth();
+    }
+
+    if( held_head_ < held_.size() ){
+        // under sustained backpressure the held events never all drain; so drop the released
+        // prefix once it outgrows the rest, rather than only once everything is released
+        if( held_.size() < 2 * held_head_ ){
+            compact();
+        }
+        pending_.store( held_.size() - held_head_, std::memory_order_relaxed );
+        return false;
+    }
+    held_.clear();
+    held_head_ = 0;
+    pending_.store( 0, std::memory_order_relaxed );
+    return true;
+}
+
+void Subscription::compact(){
+    held_.erase( held_.begin(), held_.begin() + held_head_ );
+    held_head_ = 0;
+    // every position moved; this costs no more than the events released since the last compaction
+    held_index_.clear();
+    for( size_t position = 0; position < held_.size(); ++position ){
+        held_index_.insert( held_[position].report.id, static_cast<uint32_t>(position) );
+    }
+}
+
+void Subscription::hold( const TrackEvent& event ){
+    const uint32_t found = held_index_.find( event.report.id );
+    if( FlatIndex::npos == found ){
+        held_index_.insert( event.report.id, static_cast<uint32_t>(held_.size()) );
+        held_.push_back( event );
+        pending_.store( held_.size() - held_head_, std::memory_order_relaxed );
+        return;
+    }
+
+    // the latest state wins; but a subscriber must still learn that the track is new, and everything that changed
+    TrackEvent& merged = held_[found];
+    const uint16_t changed = merged.changed | event.changed;
+    const bool created = (TrackEvent::CREATED == merged.type) && (TrackEvent::UPDATED == event.type);
+    merged = event;
+    merged.changed = changed;
+    merged.type = created ? TrackEvent::CREATED : event.type;
+    bump( coalesced_ );
+}
+
+// ====== EventBus ======
+
+EventBus::EventBus()
+    : subscriptions_( std::make_shared<const subscription_list>() )
+    , generation_(0)
+    , types_(0)
+    , active_generation_(0)
+{}
+
+std::shared_ptr<Subscription> EventBus::subscribe( size_t capacity, Subscription::POLICY policy,
+                                                   uint8_t types, std::chrono::microseconds timeout ){
+    auto subscription = std::make_shared<Subscription>( capacity, policy, types, timeout );
+
+    std::lock_guard lock(guard_);
+    auto next = std::make_shared<subscription_list>( *subscriptions_ );
+    next->push_back( subscription );
+    subscriptions_ = std::move(next);
+    types_.fetch_or( types, std::memory_order_relaxed );
+    generation_.fetch_add( 1, std::memory_order_release );
+    return subscription;
+}
+
+void EventBus::unsubscribe( const std::shared_ptr<Subscription>& subscription ){
+    std::lock_guard lock(guard_);
+    auto next = std::make_shared<subscription_list>( *subscriptions_ );
+    std::erase( *next, subscription );
+    uint8_t types = 0;
+    for( const auto& each : *next ){
+        types |= each->types();
+    }
+    subscriptions_ = std::move(next);
+    types_.store( types, std::memory_order_relaxed );
+    generation_.fetch_add( 1, std::memory_order_release );
+}
+
+bool EventBus::wants( uint8_t types ) const {
+    return 0 != (types_.load(std::memory_order_relaxed) & types);
+}
+
+void EventBus::refresh(){
+    const uint64_t generation = generation_.load( std::memory_order_acquire );
+    if( generation == active_generation_ ){
+        return;
+    }
+    std::lock_guard lock(guard_);
+    active_ = *subscriptions_;
+    active_generation_ = generation_.load( std::memory_order_relaxed );
+}
+
+void EventBus::publish( const TrackEvent& event ){
+    refresh();
+    for( const auto& subscription : active_ ){
+        if( subscription->types() & event.type ){
+            subscription->offer( event );
+        }
+    }
+}
+
+void EventBus::flush(){
+    refresh();
+    for( const auto& subscription : active_ ){
+        subscription->release();
+    }
+}
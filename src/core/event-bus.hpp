@@ -0,0 +1,239 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flat-index.hpp"
+#include "report.hpp"
+
+/// \brief one change to one track, as published by a TrackCache.  (see: `TrackCache::set_events`)
+struct TrackEvent {
+    /// \brief one bit each; so subscribers can select several
+    enum TYPE : uint8_t {
+        /// first report of a new track
+        CREATED = 1 << 0,
+        /// a report changed at least one field of an existing track, or revived a stale one; redundant reports publish nothing
+        UPDATED = 1 << 1,
+        /// no update within the stale age of the track's source
+        STALE   = 1 << 2,
+        /// removed: no update within the expire age of the track's source
+        EXPIRED = 1 << 3,
+        /// removed: least-recently-updated track, at the cache's budget
+        EVICTED = 1 << 4,
+    };
+
+    constexpr static uint8_t ALL = CREATED | UPDATED | STALE | EXPIRED | EVICTED;
+
+    /// \brief the track's merged report, as of this event
+    Report report;
+
+    /// \brief cache version at this event
+    uint64_t version;
+
+    /// \brief Report::FIELD bits changed by this event.  (CREATED, UPDATED only)
+    uint16_t changed;
+
+    TYPE type;
+};
+
+
+/// \brief bounded, lock-free, multi-producer / multi-consumer queue of events
+///
+/// After Dmitry Vyukov's bounded MPMC queue: each cell carries a sequence number, so producers
+/// and consumers only contend on their own cursor, with one CAS each.  Multi-consumer, so that
+/// the producer can also pop -- to drop the oldest event.
+class EventQueue {
+public:
+    /// \param capacity rounded up to a power of two
+    explicit EventQueue( size_t capacity );
+    EventQueue( const EventQueue& ) = delete;
+    EventQueue& operator=( const EventQueue& ) = delete;
+
+    /// \return false if full
+    bool push( const TrackEvent& event );
+
+    /// \return false if empty
+    bool pop( TrackEvent& event );
+
+    /// \return number of events queued; approximate, while other threads push or pop
+    size_t size() const;
+
+    size_t capacity() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        TrackEvent event;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // each on its own cache line; so producers and consumers do not false-share
+    alignas(64) std::atomic<size_t> enqueue_;
+    alignas(64) std::atomic<size_t> dequeue_;
+};
+
+
+/// \brief counters for one subscription; each read independently, so only approximately consistent
+struct SubscriptionStats {
+    /// \brief events queued for delivery
+    uint64_t published = 0;
+    /// \brief events taken by the subscriber
+    uint64_t delivered = 0;
+    /// \brief events lost to a full queue
+    uint64_t dropped = 0;
+    /// \brief events merged into a pending event for the same track.  (COALESCE only)
+    uint64_t coalesced = 0;
+    /// \brief times the publisher waited for room.  (BLOCK only)
+    uint64_t blocked = 0;
+
+    /// \brief events in the queue now; and the most ever
+    size_t depth = 0;
+    size_t max_depth = 0;
+
+    /// \brief events held back, waiting for room.  (COALESCE only)
+    size_t pending = 0;
+};
+
+
+/// \brief one subscriber's queue, and its backpressure policy
+///
+/// The consumer polls: `pop` or `drain`, from any one thread.  Everything else is for the bus.
+class Subscription {
+public:
+    /// \brief what the publisher does when this subscriber's queue is full
+    enum POLICY : uint8_t {
+        /// discard the oldest queued event, to make room
+        DROP_OLDEST = 0,
+        /// hold events back, keeping only the latest per track, until there is room.  (never loses a track's final state)
+        COALESCE = 1,
+        /// wait for room, up to the subscription's timeout; then drop the event.  Once a wait times out,
+        /// events are dropped without waiting until the subscriber makes room: so a stuck subscriber costs one timeout, not one per event.
+        BLOCK = 2
+    };
+
+public:
+    Subscription( size_t capacity, POLICY policy, uint8_t types, std::chrono::microseconds timeout );
+    Subscription( const Subscription& ) = delete;
+    Subscription& operator=( const Subscription& ) = delete;
+
+    /// \brief take the oldest event
+    /// \return false if none
+    bool pop( TrackEvent& event );
+
+    /// \brief take up to `limit` events, oldest first
+    /// \param out reusable buffer; cleared, then filled
+    /// \return number of events taken
+    size_t drain( std::vector<TrackEvent>& out, size_t limit = SIZE_MAX );
+
+    SubscriptionStats stats() const;
+
+    POLICY policy() const;
+
+    /// \return TrackEvent::TYPE bits this subscriber receives
+    uint8_t types() const;
+
+private:
+    friend class EventBus;
+
+    /// \brief publisher only: queue the event, per the policy
+    void offer( const TrackEvent& event );
+
+    /// \brief publisher only: move held-back events into the queue, while there is room.  (COALESCE only)
+    /// \return true if nothing is held back
+    bool release();
+
+    /// \brief publisher only: drop the released prefix of the held-back events
+    void compact();
+
+    /// \brief publisher only: merge the event into the held-back events
+    void hold( const TrackEvent& event );
+
+    void note_depth();
+
+private:
+    EventQueue queue_;
+    const POLICY policy_;
+    const uint8_t types_;
+    const std::chrono::microseconds timeout_;
+
+    // publisher-side; the last wait timed out, and the queue has not had room since.  (BLOCK only)
+    bool stalled_;
+
+    // publisher-side; held-back events, in arrival order, and track id => position.  (COALESCE only)
+    std::vector<TrackEvent> held_;
+    size_t held_head_;
+    FlatIndex held_index_;
+
+    std::atomic<uint64_t> published_;
+    std::atomic<uint64_t> delivered_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> coalesced_;
+    std::atomic<uint64_t> blocked_;
+    std::atomic<size_t> max_depth_;
+    std::atomic<size_t> pending_;
+
+};
+
+
+/// \brief typed, in-process publish / subscribe of track events
+///
+/// A TrackCache publishes every create, change, stale flag, and removal (see: `TrackCache::set_events`);
+/// each subscriber receives them through its own bounded queue, under its own backpressure policy.
+/// So a slow subscriber only ever affects itself: ingest never waits on it for longer than its
+/// BLOCK timeout, if any.
+///
+/// `publish` and `flush` must be called from a single thread -- the cache's updating thread.
+/// `subscribe` and `unsubscribe` are safe from any thread.
+class EventBus {
+public:
+    EventBus();
+    EventBus( const EventBus& ) = delete;
+    EventBus& operator=( const EventBus& ) = delete;
+
+    /// \param capacity queue size, in events; rounded up to a power of two
+    /// \param types TrackEvent::TYPE bits to receive
+    /// \param timeout (BLOCK only) longest the publisher waits for room, per event
+    std::shared_ptr<Subscription> subscribe( size_t capacity, Subscription::POLICY policy,
+                                             uint8_t types = TrackEvent::ALL,
+                                             std::chrono::microseconds timeout = std::chrono::microseconds(1000) );
+
+    /// \brief stop delivering to the subscription; events already queued stay poppable
+    void unsubscribe( const std::shared_ptr<Subscription>& subscription );
+
+    /// \return true if anyone is subscribed to any of the given TrackEvent::TYPE bits; so publishers can skip building events
+    bool wants( uint8_t types ) const;
+
+    /// \brief deliver the event to every subscription that selected its type
+    void publish( const TrackEvent& event );
+
+    /// \brief move any held-back (COALESCE) events into their queues, as room allows
+    ///
+    /// `publish` does this too; call it directly to keep delivering while no events arrive.
+    void flush();
+
+private:
+    typedef std::vector<std::shared_ptr<Subscription>> subscription_list;
+
+    /// \brief publisher only: pick up any change to the subscription list
+    void refresh();
+
+private:
+    std::mutex guard_;
+    /// every subscription; written under `guard_`
+    std::shared_ptr<const subscription_list> subscriptions_;
+    /// incremented on every (un)subscribe; so the publisher only copies the list when it changes
+    std::atomic<uint64_t> generation_;
+    /// union of every subscription's types
+    std::atomic<uint8_t> types_;
+
+    // publisher-side copy of the subscription list
+    subscription_list active_;
+    uint64_t active_generation_;
+
+};
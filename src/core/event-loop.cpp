@@ -0,0 +1,207 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "event-loop.hpp"
+
+/// \brief upper bound on descriptors handled per wake-up
+constexpr static int events_per_wait = 16;
+
+EventLoop::EventLoop()
+    : epoll_( epoll_create1(EPOLL_CLOEXEC) )
+    , stop_event_(-1)
+    , stopped_(false)
+{
+    if( epoll_ < 0 ){
+        fprintf( stderr, "!! could not create epoll instance: %s\n", strerror(errno) );
+        return;
+    }
+
+    stop_event_ = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+    if( stop_event_ < 0 ){
+        fprintf( stderr, "!! could not create stop event: %s\n", strerror(errno) );
+        return;
+    }
+    epoll_event request{};
+    request.events = EPOLLIN;
+    request.data.fd = stop_event_;
+    epoll_ctl( epoll_, EPOLL_CTL_ADD, stop_event_, &request );
+}
+
+EventLoop::~EventLoop(){
+    for( const auto& [fd, source] : sources_ ){
+        if( READER != source.kind ){
+            close( fd );
+        }
+    }
+    if( 0 <= stop_event_ ){
+        close( stop_event_ );
+    }
+    if( 0 <= epoll_ ){
+        close( epoll_ );
+    }
+}
+
+bool EventLoop::block_signals( std::initializer_list<int> signals ){
+    sigset_t mask;
+    sigemptyset( &mask );
+    for( const int signal : signals ){
+        sigaddset( &mask, signal );
+    }
+    const int error = pthread_sigmask( SIG_BLOCK, &mask, nullptr );
+    if( 0 != error ){
+        fprintf( stderr, "!! could not block signals: %s\n", strerror(error) );
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::good() const {
+    return (0 <= epoll_) && (0 <= stop_event_);
+}
+
+bool EventLoop::watch( int fd, Source source ){
+    epoll_event request{};
+    request.events = EPOLLIN;
+    request.data.fd = fd;
+    if( 0 != epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &request) ){
+        fprintf( stderr, "!! could not watch descriptor %d: %s\n", fd, strerror(errno) );
+        return false;
+    }
+    sources_[fd] = std::move(source);
+    return true;
+}
+
+bool EventLoop::add_reader( int fd, callback on_ready ){
+    return watch( fd, {READER, std::move(on_ready), nullptr} );
+}
+
+int EventLoop::add_timer( callback on_expire ){
+    const int timer = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+    if( timer < 0 ){
+        fprintf( stderr, "!! could not create timer: %s\n", strerror(errno) );
+        return -1;
+    }
+    if( ! watch(timer, {TIMER, std::move(on_expire), nullptr}) ){
+        close( timer );
+        return -1;
+    }
+    return timer;
+}
+
+static timespec to_timespec( std::chrono::microseconds duration ){
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>( duration );
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>( duration - seconds );
+    return { static_cast<time_t>(seconds.count()), static_cast<long>(nanoseconds.count()) };
+}
+
+bool EventLoop::arm_timer( int timer, std::chrono::microseconds delay, std::chrono::microseconds interval ){
+    itimerspec setting{};
+    setting.it_interval = to_timespec( interval );
+    setting.it_value = to_timespec( delay );
+    if( (0 == setting.it_value.tv_sec) && (0 == setting.it_value.tv_nsec) ){
+        // a zero value disarms the timer; so "now" means "as soon as possible"
+        setting.it_value.tv_nsec = 1;
+    }
+    if( 0 != timerfd_settime(timer, 0, &setting, nullptr) ){
+        fprintf( stderr, "!! could not arm timer %d: %s\n", timer, strerror(errno) );
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::add_signals( std::initializer_list<int> signals, signal_callback on_signal ){
+    sigset_t mask;
+    sigemptyset( &mask );
+    for( const int signal : signals ){
+        sigaddset( &mask, signal );
+    }
+    const int fd = signalfd( -1, &mask, SFD_NONBLOCK | SFD_CLOEXEC );
+    if( fd < 0 ){
+        fprintf( stderr, "!! could not create signalfd: %s\n", strerror(errno) );
+        return false;
+    }
+    if( ! watch(fd, {SIGNALS, nullptr, std::move(on_signal)}) ){
+        close( fd );
+        return false;
+    }
+    return true;
+}
+
+int EventLoop::add_event( callback on_notify ){
+    const int event = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+    if( event < 0 ){
+        fprintf( stderr, "!! could not create event: %s\n", strerror(errno) );
+        return -1;
+    }
+    if( ! watch(event, {EVENT, std::move(on_notify), nullptr}) ){
+        close( event );
+        return -1;
+    }
+    return event;
+}
+
+void EventLoop::notify( int event ) const {
+    const uint64_t one = 1;
+    // only fails when the counter would overflow; which still leaves the event readable
+    [[maybe_unused]] const ssize_t written = write( event, &one, sizeof(one) );
+}
+
+void EventLoop::stop(){
+    stopped_.store( true, std::memory_order_release );
+    notify( stop_event_ );
+}
+
+void EventLoop::run(){
+    epoll_event ready[events_per_wait];
+    while( ! stopped_.load(std::memory_order_acquire) ){
+        const int count = epoll_wait( epoll_, ready, events_per_wait, -1 );
+        if( count < 0 ){
+            if( EINTR == errno ){
+                continue;
+            }
+            fprintf( stderr, "!! epoll_wait failed: %s\n", strerror(errno) );
+            return;
+        }
+
+        for( int index = 0; (index < count) && (! stopped_.load(std::memory_order_acquire)); ++index ){
+            const int fd = ready[index].data.fd;
+            const auto found = sources_.find( fd );
+            if( sources_.end() == found ){
+                continue;
+            }
+
+            Source& source = found->second;
+            switch( source.kind ){
+                case READER:
+                    source.on_ready();
+                    break;
+                case TIMER:
+                case EVENT: {
+                    // consume the expiration (or notification) count; so the descriptor reads idle again
+                    uint64_t expirations = 0;
+                    if( sizeof(expirations) == read(fd, &expirations, sizeof(expirations)) ){
+                        source.on_ready();
+                    }
+                    break;
+                }
+                case SIGNALS: {
+                    signalfd_siginfo info;
+                    while( sizeof(info) == read(fd, &info, sizeof(info)) ){
+                        source.on_signal( static_cast<int>(info.ssi_signo) );
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
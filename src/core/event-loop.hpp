@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <map>
+
+/// \brief a single-threaded epoll loop: sleeps until a watched descriptor, timer, signal, or event is ready
+///
+/// Every source is a file descriptor -- timers are timerfds, signals a signalfd, and events eventfds --
+/// so one `epoll_wait` covers them all, and an idle loop costs nothing.  Callbacks run on the thread
+/// which calls `run`; only `notify` and `stop` may be called from other threads.
+///
+/// Linux only.
+class EventLoop {
+public:
+    typedef std::function<void()> callback;
+    typedef std::function<void( int signal )> signal_callback;
+
+public:
+    EventLoop();
+    EventLoop( const EventLoop& ) = delete;
+    EventLoop& operator=( const EventLoop& ) = delete;
+    ~EventLoop();
+
+    /// \brief block these signals in the calling thread, and every thread it starts afterwards
+    ///
+    /// Call before starting any thread: a signal is only delivered to a signalfd (see: `add_signals`)
+    /// if no thread leaves it unblocked.
+    /// \return false on failure
+    static bool block_signals( std::initializer_list<int> signals );
+
+    /// \return false if the loop could not be created
+    bool good() const;
+
+    /// \brief call `on_ready` whenever `fd` is readable; the loop does not own `fd`
+    /// \return false on failure
+    bool add_reader( int fd, callback on_ready );
+
+    /// \brief add a disarmed timer; see: `arm_timer`
+    /// \return the timer's handle; or -1 on failure
+    int add_timer( callback on_expire );
+
+    /// \brief fire once, after `delay`; then every `interval`, unless zero.  Re-arming replaces any earlier setting.
+    bool arm_timer( int timer, std::chrono::microseconds delay, std::chrono::microseconds interval = std::chrono::microseconds(0) );
+
+    /// \brief receive these signals through the loop; they must already be blocked (see: `block_signals`)
+    /// \return false on failure
+    bool add_signals( std::initializer_list<int> signals, signal_callback on_signal );
+
+    /// \brief add an event, for other threads to wake the loop with; see: `notify`
+    /// \return the event's handle; or -1 on failure
+    int add_event( callback on_notify );
+
+    /// \brief wake the loop to run the event's callback; notifications before it runs are merged into one
+    ///
+    /// Safe from any thread; never blocks.
+    void notify( int event ) const;
+
+    /// \brief dispatch callbacks until `stop`
+    void run();
+
+    /// \brief return from `run`, once the current callback finishes.  Safe from any thread.
+    void stop();
+
+private:
+    enum KIND : uint8_t { READER, TIMER, SIGNALS, EVENT };
+
+    struct Source {
+        KIND kind;
+        callback on_ready;
+        signal_callback on_signal;
+    };
+
+    bool watch( int fd, Source source );
+
+private:
+    int epoll_;
+
+    /// \brief wakes `run`, on `stop`
+    int stop_event_;
+    std::atomic<bool> stopped_;
+
+    /// \brief every watched descriptor; the loop owns all but the readers'
+    std::map<int, Source> sources_;
+
+};
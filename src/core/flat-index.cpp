@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "flat-index.hpp"
+
+static size_t next_power_of_two( size_t value ){
+    size_t result = 8;
+    while( result < value ){
+        result <<= 1;
+    }
+    return result;
+}
+
+FlatIndex::FlatIndex( size_t initial_capacity )
+    : entries_( next_power_of_two(initial_capacity), Entry{0, npos} )
+    , mask_( entries_.size() - 1 )
+    , size_(0)
+{}
+
+size_t FlatIndex::capacity() const {
+    return entries_.size();
+}
+
+void FlatIndex::clear(){
+    std::fill( entries_.begin(), entries_.end(), Entry{0, npos} );
+    size_ = 0;
+}
+
+bool FlatIndex::erase( uint64_t key ){
+    if( 0 == key ){
+        return false;
+    }
+
+    size_t index = mix(key) & mask_;
+    while( key != entries_[index].key ){
+        if( 0 == entries_[index].key ){
+            return false;
+        }
+        index = (index + 1) & mask_;
+    }
+
+    // backward-shift: pull each following entry back into the hole, if its home
+    // position allows it.  Keeps every probe sequence unbroken, without tombstones.
+    size_t hole = index;
+    size_t next = (hole + 1) & mask_;
+    while( 0 != entries_[next].key ){
+        const size_t home = mix(entries_[next].key) & mask_;
+        // distance from home to next vs. from home to hole (cyclic)
+        if( ((next - home) & mask_) >= ((next - hole) & mask_) ){
+            entries_[hole] = entries_[next];
+            hole = next;
+        }
+        next = (next + 1) & mask_;
+    }
+    entries_[hole] = Entry{0, npos};
+
+    --size_;
+    return true;
+}
+
+uint32_t FlatIndex::find( uint64_t key ) const {
+    if( 0 == key ){
+        return npos;
+    }
+
+    size_t index = mix(key) & mask_;
+    while( true ){
+        const Entry& entry = entries_[index];
+        if( key == entry.key ){
+            return entry.slot;
+        }else if( 0 == entry.key ){
+            return npos;
+        }
+        index = (index + 1) & mask_;
+    }
+}
+
+void FlatIndex::grow( size_t next_capacity ){
+    std::vector<Entry> previous( next_capacity, Entry{0, npos} );
+    previous.swap( entries_ );
+    mask_ = entries_.size() - 1;
+
+    for( const Entry& entry : previous ){
+        if( 0 != entry.key ){
+            size_t index = mix(entry.key) & mask_;
+            while( 0 != entries_[index].key ){
+                index = (index + 1) & mask_;
+            }
+            entries_[index] = entry;
+        }
+    }
+}
+
+std::pair<uint32_t, bool> FlatIndex::insert( uint64_t key, uint32_t slot ){
+    assert( 0 != key && "key 0 is reserved for empty entries!" );
+
+    if( (entries_.size() * max_load_numerator) <= ((size_ + 1) * max_load_denominator) ){
+        grow( entries_.size() * 2 );
+    }
+
+    size_t index = mix(key) & mask_;
+    while( true ){
+        Entry& entry = entries_[index];
+        if( key == entry.key ){
+            return { entry.slot, false };
+        }else if( 0 == entry.key ){
+            entry = Entry{ key, slot };
+            ++size_;
+            return { slot, true };
+        }
+        index = (index + 1) & mask_;
+    }
+}
+
+void FlatIndex::reserve( size_t count ){
+    const size_t required = next_power_of_two( (count * max_load_denominator) / max_load_numerator + 1 );
+    if( entries_.size() < required ){
+        grow( required );
+    }
+}
+
+size_t FlatIndex::size() const {
+    return size_;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// \brief open-addressing hash table which maps track ids to slots in a dense track array
+///
+/// - linear probing over a flat, power-of-two array of {key, slot} pairs
+/// - key 0 marks an empty entry; (0 is also the invalid report id)
+/// - erase uses backward-shift deletion, so there are no tombstones
+///
+/// Compared to a std::map, a lookup is usually a single cache line, rather than a
+/// pointer-chase per tree level.
+class FlatIndex {
+public:
+    constexpr static uint32_t npos = UINT32_MAX;
+
+    FlatIndex( size_t initial_capacity = 64 );
+
+    void clear();
+
+    /// \return true if the key was present and has been removed
+    bool erase( uint64_t key );
+
+    /// \return slot of the given key; `npos` if missing
+    uint32_t find( uint64_t key ) const;
+
+    /// \brief find-or-insert
+    /// \return {slot, inserted} -- the existing slot if the key is present; else `slot`
+    std::pair<uint32_t, bool> insert( uint64_t key, uint32_t slot );
+
+    /// \brief hint the cpu to fetch the key's home entry; see: batch lookups
+    inline void prefetch( uint64_t key ) const {
+        __builtin_prefetch( &entries_[mix(key) & mask_] );
+    }
+
+    /// \brief pre-size the table to hold `count` keys without growing
+    void reserve( size_t count );
+
+    size_t capacity() const;
+
+    size_t size() const;
+
+    /// \brief splitmix64 finalizer: MMSIs & name-hashes are not well-distributed in the low bits
+    static inline uint64_t mix( uint64_t key ){
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return key;
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t slot;
+    };
+
+    void grow( size_t next_capacity );
+
+private:
+    // resize when size exceeds (max_load_numerator / max_load_denominator) of capacity
+    constexpr static size_t max_load_numerator = 3;
+    constexpr static size_t max_load_denominator = 4;
+
+    std::vector<Entry> entries_;
+    size_t mask_;
+    size_t size_;
+
+};
@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "connector.hpp"
+#include "ingest-pipeline.hpp"
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr static std::string_view stage_names[IngestPipeline::stage_count] = { "read", "parse", "apply" };
+
+/// \brief while its batch is empty, the read stage waits this long for a frame; so `stop` takes effect within it
+constexpr static std::chrono::microseconds read_timeout = std::chrono::milliseconds(100);
+
+/// \brief yield this many times, waiting on a ring, before sleeping: a neighbouring stage is often about to deliver
+constexpr static unsigned spin_attempts = 64;
+
+/// \brief while idle, the apply stage still ticks this often; e.g. for periodic checkpoints
+constexpr static std::chrono::microseconds idle_tick_interval = std::chrono::seconds(1);
+
+/// \brief an idle stage re-checks its rings at least this often; only a backstop, since every hand-off wakes it
+constexpr static std::chrono::microseconds idle_timeout = std::chrono::seconds(1);
+
+// ====== Utility Methods ======
+
+/// \brief wait on a ring: yield on the first few attempts; then sleep, until woken, or `ready()`
+template<typename Predicate>
+static inline void pause( StageWaiter& self, unsigned& attempt, Predicate ready ){
+    if( attempt < spin_attempts ){
+        ++attempt;
+        std::this_thread::yield();
+    }else{
+        self.wait( ready, idle_timeout );
+    }
+}
+
+/// \brief single-writer counter; so a load and a store suffice
+static inline void add( std::atomic<uint64_t>& counter, uint64_t amount ){
+    counter.store( counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed );
+}
+
+static inline uint64_t nanoseconds( clock_type::time_point from, clock_type::time_point to ){
+    return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count() );
+}
+
+/// \brief wait for the next item from upstream; then wake the producer, which may be waiting for room
+/// \return false once upstream has finished, and its ring is drained
+template<typename T>
+static bool receive( SpscRing<T>& ring, const std::atomic<bool>& done, StageWaiter& self, StageWaiter& producer, T& item ){
+    unsigned attempt = 0;
+    while( ! ring.pop(item) ){
+        if( done.load(std::memory_order_acquire) ){
+            // upstream may have pushed its last item just before it finished
+            return ring.pop( item );
+        }
+        pause( self, attempt, [&](){
+            return (0 < ring.size()) || done.load(std::memory_order_relaxed);
+        });
+    }
+    producer.wake();
+    return true;
+}
+
+/// \brief wait for an emptied buffer to come back from downstream; then wake the returning stage, as `receive`
+template<typename T>
+static void reclaim( SpscRing<T>& ring, StageWaiter& self, StageWaiter& producer, T& item ){
+    unsigned attempt = 0;
+    while( ! ring.pop(item) ){
+        pause( self, attempt, [&](){ return 0 < ring.size(); } );
+    }
+    producer.wake();
+}
+
+/// \brief wait for room in the ring; then hand the item on, and wake its consumer
+template<typename T>
+static void send( SpscRing<T>& ring, T& item, StageWaiter& self, StageWaiter& consumer ){
+    unsigned attempt = 0;
+    while( ! ring.push(std::move(item)) ){
+        pause( self, attempt, [&](){ return ring.size() < ring.capacity(); } );
+    }
+    consumer.wake();
+}
+
+// ====== FrameBatch ======
+
+void FrameBatch::append( uint64_t timestamp, const uint8_t* data, size_t length ){
+    const size_t offset = bytes_.size();
+    bytes_.resize( offset + length );
+    std::memcpy( bytes_.data() + offset, data, length );
+    entries_.push_back( {timestamp, offset, length} );
+}
+
+void FrameBatch::clear(){
+    bytes_.clear();
+    entries_.clear();
+}
+
+// ====== StageStats ======
+
+double StageStats::utilization() const {
+    const uint64_t total = busy + starved + blocked;
+    return (0 == total) ? 0.0 : static_cast<double>(busy) / static_cast<double>(total);
+}
+
+// ====== IngestPipeline ======
+
+IngestPipeline::IngestPipeline( apply_function apply )
+    : apply_(std::move(apply))
+    , tick_interval_(std::chrono::milliseconds(20))
+    , batch_frames_(64)
+    , batch_latency_(2000)
+    , depth_(64)
+    , cpus_{-1, -1, -1}
+    , stop_(false)
+    , apply_done_(false)
+{}
+
+IngestPipeline::IngestPipeline( read_function read, parse_function parse, apply_function apply )
+    : IngestPipeline( std::move(apply) )
+{
+    add_source( std::move(read), std::move(parse) );
+}
+
+IngestPipeline::~IngestPipeline(){
+    stop();
+    join();
+}
+
+size_t IngestPipeline::add_source( read_function read, parse_function parse ){
+    if( apply_thread_.joinable() || apply_done_ ){
+        return npos;
+    }
+    auto source = std::make_unique<Source>();
+    source->read = std::move(read);
+    source->parse = std::move(parse);
+    sources_.push_back( std::move(source) );
+    return sources_.size() - 1;
+}
+
+size_t IngestPipeline::add_source( Connector& connector ){
+    return add_source( [&connector]( FrameBatch& frames, std::chrono::microseconds timeout ){ return connector.read(frames, timeout); },
+                       [&connector]( FrameBatch& frames, std::vector<Report>& reports ){ connector.parse(frames, reports); } );
+}
+
+size_t IngestPipeline::sources() const {
+    return sources_.size();
+}
+
+void IngestPipeline::set_batch( size_t frames, std::chrono::microseconds latency ){
+    batch_frames_ = std::max<size_t>( frames, 1 );
+    batch_latency_ = latency;
+}
+
+void IngestPipeline::set_depth( size_t batches ){
+    depth_ = std::max<size_t>( batches, 2 );
+}
+
+void IngestPipeline::set_tick( tick_function tick, std::chrono::microseconds interval ){
+    tick_ = std::move(tick);
+    tick_interval_ = interval;
+}
+
+void IngestPipeline::pin( STAGE stage, int cpu ){
+    cpus_[stage] = cpu;
+}
+
+bool IngestPipeline::pin( std::string_view cpus ){
+    int parsed[stage_count] = {-1, -1, -1};
+    size_t stage = 0;
+    const char* cursor = cpus.data();
+    const char* end = cpus.data() + cpus.size();
+    while( cursor < end ){
+        if( stage_count <= stage ){
+            return false;
+        }
+        const auto [next, error] = std::from_chars( cursor, end, parsed[stage] );
+        if( (std::errc() != error) || ((next < end) && (',' != *next)) ){
+            return false;
+        }
+        ++stage;
+        cursor = next + 1;
+    }
+    if( 0 == stage ){
+        return false;
+    }
+
+    for( size_t i = 0; i < stage_count; ++i ){
+        cpus_[i] = parsed[i];
+    }
+    return true;
+}
+
+bool IngestPipeline::start(){
+    if( apply_thread_.joinable() || apply_done_ || sources_.empty() ){
+        return false;
+    }
+
+    for( auto& source : sources_ ){
+        source->frames = std::make_unique<SpscRing<FrameBatch>>( depth_ );
+        source->frames_free = std::make_unique<SpscRing<FrameBatch>>( depth_ );
+        source->reports = std::make_unique<SpscRing<std::vector<Report>>>( depth_ );
+        source->reports_free = std::make_unique<SpscRing<std::vector<Report>>>( depth_ );
+
+        // every buffer the source will ever use; each circulates between two stages
+        for( size_t i = 0; i < depth_; ++i ){
+            FrameBatch frames;
+            source->frames_free->push( std::move(frames) );
+            std::vector<Report> reports;
+            reports.reserve( batch_frames_ * 4 );
+            source->reports_free->push( std::move(reports) );
+        }
+    }
+
+    apply_thread_ = std::thread( &IngestPipeline::run_apply, this );
+    for( size_t index = 0; index < sources_.size(); ++index ){
+        Source& source = *sources_[index];
+        source.threads[PARSE] = std::thread( &IngestPipeline::run_parse, this, std::ref(source), index );
+        source.threads[READ] = std::thread( &IngestPipeline::run_read, this, std::ref(source), index );
+    }
+    return true;
+}
+
+void IngestPipeline::stop(){
+    stop_.store( true, std::memory_order_relaxed );
+}
+
+void IngestPipeline::join(){
+    for( auto& source : sources_ ){
+        for( auto& thread : source->threads ){
+            if( thread.joinable() ){
+                thread.join();
+            }
+        }
+    }
+    if( apply_thread_.joinable() ){
+        apply_thread_.join();
+    }
+}
+
+bool IngestPipeline::running() const {
+    return apply_thread_.joinable() && (! apply_done_.load(std::memory_order_acquire));
+}
+
+StageStats IngestPipeline::Counters::load() const {
+    StageStats stats;
+    stats.batches = batches.load( std::memory_order_relaxed );
+    stats.items = items.load( std::memory_order_relaxed );
+    stats.busy = busy.load( std::memory_order_relaxed );
+    stats.starved = starved.load( std::memory_order_relaxed );
+    stats.blocked = blocked.load( std::memory_order_relaxed );
+    return stats;
+}
+
+StageStats IngestPipeline::stats( STAGE stage ) const {
+    if( APPLY == stage ){
+        return apply_counters_.load();
+    }
+
+    StageStats total;
+    for( size_t index = 0; index < sources_.size(); ++index ){
+        const StageStats each = stats( index, stage );
+        total.batches += each.batches;
+        total.items += each.items;
+        total.busy += each.busy;
+        total.starved += each.starved;
+        total.blocked += each.blocked;
+    }
+    return total;
+}
+
+StageStats IngestPipeline::stats( size_t source, STAGE stage ) const {
+    if( (sources_.size() <= source) || (APPLY == stage) ){
+        return {};
+    }
+    return sources_[source]->counters[stage].load();
+}
+
+std::string_view IngestPipeline::stage_name( STAGE stage ){
+    return (stage < stage_count) ? stage_names[stage] : std::string_view("unknown");
+}
+
+void IngestPipeline::enter( STAGE stage, size_t index ) const {
+    char name[16];
+    if( APPLY == stage ){
+        snprintf( name, sizeof(name), "ingest-%s", stage_names[stage].data() );
+    }else{
+        snprintf( name, sizeof(name), "ingest-%s-%zu", stage_names[stage].data(), index );
+    }
+    pthread_setname_np( pthread_self(), name );
+
+    const int cpu = cpus_[stage];
+    if( cpu < 0 ){
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( cpu, &set );
+    const int error = pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+    if( 0 != error ){
+        fprintf( stderr, "!! could not pin the %s stage to CPU %d: %s\n", stage_names[stage].data(), cpu, strerror(error) );
+    }
+}
+
+void IngestPipeline::run_read( Source& source, size_t index ){
+    enter( READ, index );
+    Counters& counters = source.counters[READ];
+    StageWaiter& self = source.waiters[READ];
+    StageWaiter& parse = source.waiters[PARSE];
+
+    FrameBatch batch;
+    bool holding = false;
+    bool more = true;
+    while( more ){
+        auto mark = clock_type::now();
+        if( ! holding ){
+            // a batch the parse stage has finished with
+            reclaim( *source.frames_free, self, parse, batch );
+            holding = true;
+            const auto now = clock_type::now();
+            add( counters.blocked, nanoseconds(mark, now) );
+            mark = now;
+        }
+
+        // fill by count; but under a trickle of frames, hand on whatever arrived within the latency
+        // bound of the first: so a read never waits past the batch's deadline
+        auto deadline = clock_type::time_point::max();
+        while( batch.size() < batch_frames_ ){
+            std::chrono::microseconds timeout = read_timeout;
+            if( ! batch.empty() ){
+                const auto now = clock_type::now();
+                if( deadline <= now ){
+                    break;
+                }
+                timeout = std::chrono::duration_cast<std::chrono::microseconds>( deadline - now );
+            }
+
+            if( stop_.load(std::memory_order_relaxed) || (! source.read(batch, timeout)) ){
+                more = false;
+                break;
+            }
+            if( (clock_type::time_point::max() == deadline) && (! batch.empty()) ){
+                deadline = clock_type::now() + batch_latency_;
+            }
+        }
+
+        const auto sent = clock_type::now();
+        add( counters.busy, nanoseconds(mark, sent) );
+        if( ! batch.empty() ){
+            add( counters.items, batch.size() );
+            add( counters.batches, 1 );
+            send( *source.frames, batch, self, parse );
+            holding = false;
+            add( counters.blocked, nanoseconds(sent, clock_type::now()) );
+        }
+    }
+
+    source.read_done.store( true, std::memory_order_release );
+    parse.wake();
+}
+
+void IngestPipeline::run_parse( Source& source, size_t index ){
+    enter( PARSE, index );
+    Counters& counters = source.counters[PARSE];
+    StageWaiter& self = source.waiters[PARSE];
+    StageWaiter& read = source.waiters[READ];
+
+    FrameBatch frames;
+    std::vector<Report> reports;
+    bool holding = false;
+    while( true ){
+        auto mark = clock_type::now();
+        if( ! receive(*source.frames, source.read_done, self, read, frames) ){
+            add( counters.starved, nanoseconds(mark, clock_type::now()) );
+            break;
+        }
+        auto now = clock_type::now();
+        add( counters.starved, nanoseconds(mark, now) );
+        mark = now;
+
+        if( ! holding ){
+            // a report buffer the apply stage has finished with
+            reclaim( *source.reports_free, self, apply_waiter_, reports );
+            holding = true;
+            now = clock_type::now();
+            add( counters.blocked, nanoseconds(mark, now) );
+            mark = now;
+        }
+
+        source.parse( frames, reports );
+        frames.clear();
+        send( *source.frames_free, frames, self, read );
+
+        now = clock_type::now();
+        add( counters.busy, nanoseconds(mark, now) );
+        mark = now;
+
+        // frames without any reports (e.g. only registrations) hand nothing on; and keep the buffer
+        if( ! reports.empty() ){
+            add( counters.items, reports.size() );
+            add( counters.batches, 1 );
+            send( *source.reports, reports, self, apply_waiter_ );
+            holding = false;
+            add( counters.blocked, nanoseconds(mark, clock_type::now()) );
+        }
+    }
+
+    source.parse_done.store( true, std::memory_order_release );
+    apply_waiter_.wake();
+}
+
+void IngestPipeline::run_apply(){
+    enter( APPLY, 0 );
+    Counters& counters = apply_counters_;
+
+    const size_t count = sources_.size();
+    std::vector<Report> reports;
+    size_t next = 0;
+
+    // idle: is there anything to take?  Or has every source finished?
+    const auto ready = [this](){
+        bool finished = true;
+        for( const auto& source : sources_ ){
+            if( 0 < source->reports->size() ){
+                return true;
+            }
+            finished = finished && source->parse_done.load( std::memory_order_relaxed );
+        }
+        return finished;
+    };
+
+    // a batch was applied since the last idle tick; so the tick may have work it deferred
+    bool tick_pending = false;
+    while( true ){
+        auto mark = clock_type::now();
+
+        // take from each source in turn, starting after the last one served; so a busy source cannot starve the rest
+        size_t served = npos;
+        unsigned attempt = 0;
+        while( true ){
+            bool finished = true;
+            for( size_t offset = 0; offset < count; ++offset ){
+                const size_t index = (next + offset) % count;
+                Source& source = *sources_[index];
+                // read the flag before popping: once it is set, an empty ring stays empty
+                const bool done = source.parse_done.load( std::memory_order_acquire );
+                if( source.reports->pop(reports) ){
+                    // the parse stage may be waiting for room
+                    source.waiters[PARSE].wake();
+                    served = index;
+                    break;
+                }
+                finished = finished && done;
+            }
+            if( (npos != served) || finished ){
+                break;
+            }
+            if( attempt < spin_attempts ){
+                ++attempt;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // idle: sleep until a parse stage hands a batch on; or it is time to tick
+            apply_waiter_.wait( ready, tick_pending ? tick_interval_ : (tick_ ? idle_tick_interval : idle_timeout) );
+            if( tick_ ){
+                tick_( false );
+            }
+            tick_pending = false;
+        }
+
+        const auto now = clock_type::now();
+        add( counters.starved, nanoseconds(mark, now) );
+        if( npos == served ){
+            break;
+        }
+        mark = now;
+        next = served + 1;
+
+        apply_( reports );
+        add( counters.items, reports.size() );
+        add( counters.batches, 1 );
+        reports.clear();
+        send( *sources_[served]->reports_free, reports, apply_waiter_, sources_[served]->waiters[PARSE] );
+
+        if( tick_ ){
+            tick_( false );
+            tick_pending = true;
+        }
+        add( counters.busy, nanoseconds(mark, clock_type::now()) );
+    }
+
+    if( tick_ ){
+        tick_( true );
+    }
+
+    apply_done_.store( true, std::memory_order_release );
+}
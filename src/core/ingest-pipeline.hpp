@@ -0,0 +1,289 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "report.hpp"
+#include "spsc-ring.hpp"
+
+/// \brief frames copied out of a reader; packed back-to-back into one reusable buffer
+///
+/// Readers only lend out their frames until the next read; so the read stage copies each one
+/// here, and the whole batch crosses to the parse stage in one hand-off.
+class FrameBatch {
+public:
+    struct Frame {
+        uint64_t timestamp;
+        uint8_t* data;
+        size_t length;
+    };
+
+public:
+    /// \brief copy the frame onto the end of the batch
+    void append( uint64_t timestamp, const uint8_t* data, size_t length );
+
+    /// \brief empty the batch; keeping its capacity
+    void clear();
+
+    bool empty() const { return entries_.empty(); }
+
+    /// \return number of frames
+    size_t size() const { return entries_.size(); }
+
+    /// \return number of payload bytes, in all frames
+    size_t bytes() const { return bytes_.size(); }
+
+    /// \return view of one frame; valid until the next `append` or `clear`
+    Frame operator[]( size_t index ){
+        const Entry& entry = entries_[index];
+        return { entry.timestamp, bytes_.data() + entry.offset, entry.length };
+    }
+
+private:
+    struct Entry {
+        uint64_t timestamp;
+        size_t offset;
+        size_t length;
+    };
+
+    std::vector<uint8_t> bytes_;
+    std::vector<Entry> entries_;
+};
+
+
+/// \brief counters for one pipeline stage; each read independently, so only approximately consistent
+struct StageStats {
+    /// \brief batches handed on; or, for the last stage, applied
+    uint64_t batches = 0;
+    /// \brief frames read; or reports parsed, or applied
+    uint64_t items = 0;
+
+    /// \brief time in the stage's own work (nsec)
+    uint64_t busy = 0;
+    /// \brief time waiting for input (nsec)
+    uint64_t starved = 0;
+    /// \brief time waiting for room, or buffers, downstream (nsec)
+    uint64_t blocked = 0;
+
+    /// \return fraction of the stage's time spent working; the bottleneck stage is the one near 1
+    double utilization() const;
+};
+
+
+/// \brief where an idle pipeline stage sleeps; until a neighbouring stage hands it work, or room
+///
+/// The waking side only takes the lock while the other side sleeps; so while both are busy, a
+/// hand-off costs one fence, and no system call.  One thread sleeps on each waiter; any may wake it.
+class StageWaiter {
+public:
+    /// \brief sleep until `ready()`, a `wake`, or the timeout -- whichever comes first
+    template<typename Predicate>
+    void wait( Predicate ready, std::chrono::microseconds timeout ){
+        std::unique_lock<std::mutex> lock( mutex_ );
+        sleeping_.store( true, std::memory_order_relaxed );
+        // pairs with the fence in `wake`: either this sees the new work, or `wake` sees the sleeper
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( ! ready() ){
+            condition_.wait_for( lock, timeout );
+        }
+        sleeping_.store( false, std::memory_order_relaxed );
+    }
+
+    /// \brief wake the sleeper, if there is one; call after handing it the work
+    void wake(){
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( sleeping_.load(std::memory_order_relaxed) ){
+            // the sleeper holds the lock until it is waiting; so this cannot slip in between
+            std::lock_guard<std::mutex> lock( mutex_ );
+            condition_.notify_one();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::atomic<bool> sleeping_ = false;
+};
+
+
+class Connector;
+
+/// \brief read -> parse -> apply, each on its own thread
+///
+/// Stages hand batches to each other over lock-free single-producer / single-consumer rings; and
+/// hand the emptied batches back over a second ring each, so that in steady state nothing is
+/// allocated.  A slow stage only stalls the others once the ring in front of it fills.
+///
+/// An idle stage sleeps, rather than polls: each hand-off wakes the stage on the other side of the
+/// ring; so an idle pipeline costs (almost) no CPU.
+///
+/// Any number of sources may feed one pipeline: each source gets its own read and parse threads,
+/// and one apply thread serves every source in turn.  Order is preserved within each source: its
+/// reports are applied in the order their frames were read.
+///
+/// The apply function runs on the pipeline's apply thread; so that thread becomes the only one
+/// which may update the cache.  (i.e. between `start` and `join`)
+class IngestPipeline {
+public:
+    enum STAGE : uint8_t {
+        READ = 0,
+        PARSE = 1,
+        APPLY = 2
+    };
+    constexpr static size_t stage_count = 3;
+
+    /// \brief append (usually one) frame to the batch
+    /// \param timeout longest to wait for a frame to arrive
+    /// \return false once the source is exhausted
+    typedef std::function<bool( FrameBatch& frames, std::chrono::microseconds timeout )> read_function;
+
+    /// \brief parse every frame in the batch into reports
+    /// \param reports reusable buffer; arrives empty
+    typedef std::function<void( FrameBatch& frames, std::vector<Report>& reports )> parse_function;
+
+    /// \brief apply one batch of reports; e.g. `TrackCache::update`
+    typedef std::function<void( std::vector<Report>& reports )> apply_function;
+
+    /// \brief apply-thread housekeeping: called after every batch; and while idle, once the tick's
+    /// interval after the last batch (see: `set_tick`), then once a second
+    /// \param finished true on the final call, once the last batch is applied
+    typedef std::function<void( bool finished )> tick_function;
+
+public:
+    /// \brief add sources with `add_source`, before `start`
+    explicit IngestPipeline( apply_function apply );
+
+    /// \brief with a single source
+    IngestPipeline( read_function read, parse_function parse, apply_function apply );
+
+    IngestPipeline( const IngestPipeline& ) = delete;
+    IngestPipeline& operator=( const IngestPipeline& ) = delete;
+
+    /// \brief stops, and joins, the stage threads
+    ~IngestPipeline();
+
+    /// \brief add a source: its frames are read, and parsed, on two threads of its own
+    /// \return the source's index; for `stats`.  npos if already started
+    size_t add_source( read_function read, parse_function parse );
+
+    /// \brief add a connector as a source; it must outlive the pipeline
+    size_t add_source( Connector& connector );
+
+    /// \return number of sources
+    size_t sources() const;
+
+    /// \brief hand a frame batch on once it holds this many frames, or is this old -- whichever comes first
+    void set_batch( size_t frames, std::chrono::microseconds latency );
+
+    /// \brief batches in flight between each pair of stages
+    void set_depth( size_t batches );
+
+    /// \param interval while idle, call the tick this long after the last batch: so work the tick
+    ///                 deferred (e.g. a rate-limited publish) is not held back until the next batch
+    void set_tick( tick_function tick, std::chrono::microseconds interval = std::chrono::milliseconds(20) );
+
+    /// \brief pin a stage's threads to one CPU -- every source's, for READ and PARSE; -1 => unpinned (default)
+    void pin( STAGE stage, int cpu );
+
+    /// \brief pin every stage, from a list of CPUs: "READ,PARSE,APPLY"; e.g. "0,1,2", or "2,-1,3"
+    /// \return false if unparseable
+    bool pin( std::string_view cpus );
+
+    /// \brief start the stage threads; configure before this
+    /// \return false if already started, or without any source
+    bool start();
+
+    /// \brief ask every read stage to stop early; frames already read are still parsed and applied
+    void stop();
+
+    /// \brief wait for every stage to drain, and finish
+    void join();
+
+    /// \return true from `start`, until every stage has finished
+    bool running() const;
+
+    /// \return one stage's counters; summed over every source, for READ and PARSE
+    StageStats stats( STAGE stage ) const;
+
+    /// \return one source's counters, for READ or PARSE
+    StageStats stats( size_t source, STAGE stage ) const;
+
+    static std::string_view stage_name( STAGE stage );
+
+    constexpr static size_t npos = SIZE_MAX;
+
+private:
+    /// \brief counters written by one stage thread only; so plain stores, not read-modify-writes.
+    /// One cache line per stage; so stages do not false-share.
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> batches = 0;
+        std::atomic<uint64_t> items = 0;
+        std::atomic<uint64_t> busy = 0;
+        std::atomic<uint64_t> starved = 0;
+        std::atomic<uint64_t> blocked = 0;
+
+        StageStats load() const;
+    };
+
+    /// \brief one source's read and parse stages, and the rings between them and the apply stage
+    struct Source {
+        read_function read;
+        parse_function parse;
+
+        // forward: full batches.  return: emptied batches, for reuse.  (created by `start`)
+        std::unique_ptr<SpscRing<FrameBatch>> frames;
+        std::unique_ptr<SpscRing<FrameBatch>> frames_free;
+        std::unique_ptr<SpscRing<std::vector<Report>>> reports;
+        std::unique_ptr<SpscRing<std::vector<Report>>> reports_free;
+
+        // set by each stage once it has handed on its last batch
+        std::atomic<bool> read_done = false;
+        std::atomic<bool> parse_done = false;
+
+        Counters counters[2];
+
+        // where the read and parse threads sleep, while idle
+        StageWaiter waiters[2];
+
+        std::thread threads[2];
+    };
+
+    void run_read( Source& source, size_t index );
+
+    void run_parse( Source& source, size_t index );
+
+    void run_apply();
+
+    /// \brief name, and pin, the calling thread
+    void enter( STAGE stage, size_t index ) const;
+
+private:
+    apply_function apply_;
+    tick_function tick_;
+    std::chrono::microseconds tick_interval_;
+
+    size_t batch_frames_;
+    std::chrono::microseconds batch_latency_;
+    size_t depth_;
+    int cpus_[stage_count];
+
+    std::vector<std::unique_ptr<Source>> sources_;
+
+    std::atomic<bool> stop_;
+    std::atomic<bool> apply_done_;
+
+    Counters apply_counters_;
+    StageWaiter apply_waiter_;
+
+    std::thread apply_thread_;
+
+};
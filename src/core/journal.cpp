@@ -0,0 +1,528 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "journal.hpp"
+#include "name-table.hpp"
+
+constexpr static char journal_magic[8] = {'T','R','A','C','K','J','N','L'};
+
+/// \brief wake the writer early once this many records are pending
+constexpr static size_t commit_threshold = 16384;
+
+/// \brief `count` is the commit point: so it is stored after, and loaded before, the records it covers
+static inline void store_count( JournalHeader& header, uint64_t count ){
+    std::atomic_ref<uint64_t>( header.count ).store( count, std::memory_order_release );
+}
+
+static inline uint64_t load_count( const JournalHeader& header ){
+    // a plain load, on every supported platform; so a read-only mapping is fine
+    return std::atomic_ref<uint64_t>( const_cast<uint64_t&>(header.count) ).load( std::memory_order_acquire );
+}
+
+static inline size_t header_bytes_for( size_t capacity ){
+    const size_t blocks = capacity / Journal::block_records;
+    const size_t bytes = sizeof(JournalHeader) + blocks * sizeof(JournalBlock);
+    // page-aligned; so the records start on a page boundary
+    return (bytes + 4095) & ~static_cast<size_t>(4095);
+}
+
+// ====== Journal ======
+
+std::string Journal::segment_path( const std::string& directory, uint32_t number ){
+    char name[32];
+    snprintf( name, sizeof(name), "journal-%06u.dat", number );
+    return directory + "/" + name;
+}
+
+std::string Journal::names_path( const std::string& directory, uint32_t number ){
+    char name[32];
+    snprintf( name, sizeof(name), "journal-%06u.names", number );
+    return directory + "/" + name;
+}
+
+std::vector<uint32_t> Journal::segments( const std::string& directory ){
+    std::vector<uint32_t> numbers;
+    std::error_code error;
+    for( const auto& entry : std::filesystem::directory_iterator(directory, error) ){
+        const std::string name = entry.path().filename().string();
+        uint32_t number = 0;
+        char suffix[8] = {};
+        if( (2 == sscanf(name.c_str(), "journal-%6u.%7s", &number, suffix)) && (0 == strcmp(suffix, "dat")) ){
+            numbers.push_back( number );
+        }
+    }
+    std::sort( numbers.begin(), numbers.end() );
+    return numbers;
+}
+
+// ====== JournalWriter ======
+
+JournalWriter::JournalWriter( const std::string& directory, size_t segment_records,
+                              std::chrono::milliseconds commit_interval, size_t max_pending )
+    : directory_(directory)
+    , segment_records_( ((std::max<size_t>(segment_records, 1) + Journal::block_records - 1) / Journal::block_records) * Journal::block_records )
+    , commit_interval_(commit_interval)
+    , max_pending_(max_pending)
+    , next_number_(0)
+    , stop_(false)
+    , good_(false)
+    , written_(0)
+    , dropped_(0)
+    , commits_(0)
+    , worker_( &JournalWriter::run, this )
+{
+    // the writer thread only touches the segment after taking the lock; so set it up under the lock
+    std::lock_guard lock(guard_);
+
+    std::error_code error;
+    std::filesystem::create_directories( directory_, error );
+    if( error ){
+        fprintf( stderr, "!! could not create journal directory: %s\n", directory_.c_str() );
+        return;
+    }
+
+    const std::vector<uint32_t> existing = Journal::segments( directory_ );
+    next_number_ = existing.empty() ? 0 : (existing.back() + 1);
+
+    pending_.reserve( commit_threshold );
+    good_ = open_segment();
+}
+
+JournalWriter::~JournalWriter(){
+    {
+        std::lock_guard lock(guard_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+bool JournalWriter::good() const {
+    return good_.load();
+}
+
+void JournalWriter::append( const Report& report ){
+    JournalRecord record;
+    record.timestamp = report.timestamp;
+    record.id = report.id;
+    record.latitude = report.latitude;
+    record.longitude = report.longitude;
+    record.easting = report.easting;
+    record.northing = report.northing;
+    record.heading = report.heading;
+    record.course = report.course;
+    record.speed = report.speed;
+    record.name = report.name;
+    record.station = report.station;
+    record.fields = report.fields;
+    record.source = report.source;
+    record.status = report.status;
+
+    std::lock_guard lock(guard_);
+    if( max_pending_ <= pending_.size() ){
+        dropped_.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+    pending_.push_back( record );
+    if( commit_threshold == pending_.size() ){
+        wake_.notify_one();
+    }
+}
+
+size_t JournalWriter::written() const {
+    return written_.load();
+}
+
+size_t JournalWriter::dropped() const {
+    return dropped_.load();
+}
+
+size_t JournalWriter::commits() const {
+    return commits_.load();
+}
+
+void JournalWriter::run(){
+    // swapped with `pending_` on each commit; so both keep their capacity, and ingest never reallocates
+    std::vector<JournalRecord> batch;
+
+    std::unique_lock lock(guard_);
+    while( true ){
+        wake_.wait_for( lock, commit_interval_, [this]{ return stop_ || (commit_threshold <= pending_.size()); } );
+        const bool stopping = stop_;
+        batch.swap( pending_ );
+
+        // commit without the lock; so `append` never waits on the disk
+        lock.unlock();
+        if( ! batch.empty() ){
+            commit( batch );
+            batch.clear();
+        }
+        if( stopping ){
+            seal();
+            return;
+        }
+        lock.lock();
+    }
+}
+
+void JournalWriter::commit( const std::vector<JournalRecord>& batch ){
+    size_t offset = 0;
+    while( offset < batch.size() ){
+        if( (nullptr == segment_.data) || (segment_.header->capacity == segment_.count) ){
+            seal();
+            if( ! (good_ && open_segment()) ){
+                good_ = false;
+                dropped_ += batch.size() - offset;
+                return;
+            }
+        }
+
+        // .1. records: one copy, up to the end of this segment
+        const size_t count = std::min<size_t>( batch.size() - offset, segment_.header->capacity - segment_.count );
+        std::memcpy( segment_.records + segment_.count, batch.data() + offset, count * sizeof(JournalRecord) );
+
+        // .2. time index, and names
+        JournalHeader& header = *segment_.header;
+        for( size_t i = 0; i < count; ++i ){
+            const JournalRecord& record = batch[offset + i];
+            JournalBlock& block = segment_.blocks[ (segment_.count + i) / Journal::block_records ];
+            block.min_timestamp = std::min( block.min_timestamp, record.timestamp );
+            block.max_timestamp = std::max( block.max_timestamp, record.timestamp );
+            header.min_timestamp = std::min( header.min_timestamp, record.timestamp );
+            header.max_timestamp = std::max( header.max_timestamp, record.timestamp );
+            note_name( record.name );
+            note_name( record.station );
+        }
+        if( ! flush_names() ){
+            fprintf( stderr, "!! could not write journal names: %s\n", Journal::names_path(directory_, segment_.number).c_str() );
+        }
+
+        // .3. commit point
+        segment_.count += count;
+        store_count( header, segment_.count );
+        written_ += count;
+        offset += count;
+    }
+    ++commits_;
+}
+
+bool JournalWriter::open_segment(){
+    const uint32_t number = next_number_++;
+    const std::string path = Journal::segment_path( directory_, number );
+    const size_t header_bytes = header_bytes_for( segment_records_ );
+    const size_t bytes = header_bytes + segment_records_ * sizeof(JournalRecord);
+
+    const int descriptor = open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if( descriptor < 0 ){
+        fprintf( stderr, "!! could not create journal segment: %s\n", path.c_str() );
+        return false;
+    }
+    // reserve the blocks up front, where supported; so that appends do not fragment, or fail, mid-segment
+    if( (0 != posix_fallocate(descriptor, 0, bytes)) && (0 != ftruncate(descriptor, bytes)) ){
+        fprintf( stderr, "!! could not size journal segment: %s\n", path.c_str() );
+        close( descriptor );
+        unlink( path.c_str() );
+        return false;
+    }
+    void* mapped = mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0 );
+    if( MAP_FAILED == mapped ){
+        fprintf( stderr, "!! could not map journal segment: %s\n", path.c_str() );
+        close( descriptor );
+        unlink( path.c_str() );
+        return false;
+    }
+
+    const std::string names = Journal::names_path( directory_, number );
+    const int names_descriptor = open( names.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644 );
+    if( names_descriptor < 0 ){
+        fprintf( stderr, "!! could not create journal names: %s\n", names.c_str() );
+        munmap( mapped, bytes );
+        close( descriptor );
+        unlink( path.c_str() );
+        return false;
+    }
+
+    segment_.number = number;
+    segment_.descriptor = descriptor;
+    segment_.names_descriptor = names_descriptor;
+    segment_.data = static_cast<uint8_t*>(mapped);
+    segment_.bytes = bytes;
+    segment_.header = reinterpret_cast<JournalHeader*>(segment_.data);
+    segment_.blocks = reinterpret_cast<JournalBlock*>(segment_.data + sizeof(JournalHeader));
+    segment_.records = reinterpret_cast<JournalRecord*>(segment_.data + header_bytes);
+    segment_.count = 0;
+    segment_.names.clear();
+
+    JournalHeader& header = *segment_.header;
+    header.format = Journal::format;
+    header.record_size = sizeof(JournalRecord);
+    header.header_bytes = header_bytes;
+    header.block_records = Journal::block_records;
+    header.capacity = segment_records_;
+    header.min_timestamp = UINT64_MAX;
+    header.max_timestamp = 0;
+    std::fill_n( segment_.blocks, segment_records_ / Journal::block_records, JournalBlock{UINT64_MAX, 0} );
+    store_count( header, 0 );
+    // last: a reader rejects the segment until its header is complete
+    std::memcpy( header.magic, journal_magic, sizeof(header.magic) );
+    return true;
+}
+
+void JournalWriter::seal(){
+    if( nullptr == segment_.data ){
+        return;
+    }
+
+    const std::string path = Journal::segment_path( directory_, segment_.number );
+    const size_t header_bytes = segment_.header->header_bytes;
+    const uint64_t count = segment_.count;
+
+    msync( segment_.data, segment_.bytes, MS_SYNC );
+    munmap( segment_.data, segment_.bytes );
+    segment_.data = nullptr;
+    segment_.header = nullptr;
+    segment_.blocks = nullptr;
+    segment_.records = nullptr;
+
+    if( 0 == count ){
+        // nothing committed; leave no empty segment behind
+        unlink( path.c_str() );
+        unlink( Journal::names_path(directory_, segment_.number).c_str() );
+    }else if( (0 != ftruncate(segment_.descriptor, header_bytes + count * sizeof(JournalRecord)))
+                || (0 != fsync(segment_.descriptor)) || (0 != fsync(segment_.names_descriptor)) ){
+        fprintf( stderr, "!! could not seal journal segment: %s\n", path.c_str() );
+    }
+    close( segment_.descriptor );
+    close( segment_.names_descriptor );
+    segment_.descriptor = -1;
+    segment_.names_descriptor = -1;
+}
+
+void JournalWriter::note_name( uint32_t handle ){
+    if( (0 == handle) || (! segment_.names.insert(handle, 0).second) ){
+        return;
+    }
+    const std::string_view text = NameTable::global().lookup( handle );
+    const uint32_t entry[2] = { handle, static_cast<uint32_t>(text.size()) };
+    names_buffer_.append( reinterpret_cast<const char*>(entry), sizeof(entry) );
+    names_buffer_.append( text );
+}
+
+bool JournalWriter::flush_names(){
+    const char* cursor = names_buffer_.data();
+    size_t remaining = names_buffer_.size();
+    while( 0 < remaining ){
+        const ssize_t sent = write( segment_.names_descriptor, cursor, remaining );
+        if( sent <= 0 ){
+            names_buffer_.clear();
+            return false;
+        }
+        cursor += sent;
+        remaining -= sent;
+    }
+    names_buffer_.clear();
+    return true;
+}
+
+// ====== JournalSegment ======
+
+JournalSegment::JournalSegment( JournalSegment&& other ){
+    *this = std::move(other);
+}
+
+JournalSegment& JournalSegment::operator=( JournalSegment&& other ){
+    if( this != &other ){
+        release();
+        data_ = std::exchange( other.data_, nullptr );
+        bytes_ = std::exchange( other.bytes_, 0 );
+        header_ = std::exchange( other.header_, nullptr );
+        count_ = std::exchange( other.count_, 0 );
+        text_ = std::move( other.text_ );
+        names_ = std::move( other.names_ );
+        offsets_ = std::move( other.offsets_ );
+        lengths_ = std::move( other.lengths_ );
+        interned_ = std::move( other.interned_ );
+    }
+    return *this;
+}
+
+JournalSegment::~JournalSegment(){
+    release();
+}
+
+void JournalSegment::release(){
+    if( nullptr != data_ ){
+        munmap( const_cast<uint8_t*>(data_), bytes_ );
+    }
+    data_ = nullptr;
+    bytes_ = 0;
+    header_ = nullptr;
+    count_ = 0;
+}
+
+bool JournalSegment::open( const std::string& directory, uint32_t number ){
+    release();
+
+    const std::string path = Journal::segment_path( directory, number );
+    const int descriptor = ::open( path.c_str(), O_RDONLY );
+    if( descriptor < 0 ){
+        return false;
+    }
+    struct stat status;
+    if( (0 != fstat(descriptor, &status)) || (status.st_size < static_cast<off_t>(sizeof(JournalHeader))) ){
+        close( descriptor );
+        return false;
+    }
+    // shared, not private: a segment still being written is mapped as it is, not as a copy
+    void* mapped = mmap( nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0 );
+    close( descriptor );
+    if( MAP_FAILED == mapped ){
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(mapped);
+    bytes_ = status.st_size;
+    header_ = reinterpret_cast<const JournalHeader*>(data_);
+
+    // .1. validate; then take the count once, so every record read below is committed
+    const JournalHeader& header = *header_;
+    const size_t blocks = (0 == header.block_records) ? 0 : (header.capacity / header.block_records);
+    count_ = load_count( header );
+    if( (0 != std::memcmp(header.magic, journal_magic, sizeof(header.magic)))
+            || (Journal::format != header.format)
+            || (sizeof(JournalRecord) != header.record_size)
+            || (0 == header.block_records)
+            || (header.header_bytes < sizeof(JournalHeader) + blocks * sizeof(JournalBlock))
+            || (bytes_ < header.header_bytes)
+            || (header.capacity < count_)
+            || ((bytes_ - header.header_bytes) / sizeof(JournalRecord) < count_) ){
+        release();
+        return false;
+    }
+    madvise( const_cast<uint8_t*>(data_), bytes_, MADV_SEQUENTIAL );
+
+    // .2. names: after the count; so every name a committed record references is already written
+    text_.clear();
+    names_.clear();
+    offsets_.clear();
+    lengths_.clear();
+    interned_.clear();
+    FILE* file = fopen( Journal::names_path(directory, number).c_str(), "rb" );
+    if( nullptr != file ){
+        char buffer[4096];
+        size_t read = 0;
+        while( 0 < (read = fread(buffer, 1, sizeof(buffer), file)) ){
+            text_.append( buffer, read );
+        }
+        fclose( file );
+    }
+    size_t cursor = 0;
+    while( cursor + 2 * sizeof(uint32_t) <= text_.size() ){
+        uint32_t entry[2];
+        std::memcpy( entry, text_.data() + cursor, sizeof(entry) );
+        cursor += sizeof(entry);
+        if( text_.size() - cursor < entry[1] ){
+            // partially written; by a writer still running
+            break;
+        }
+        if( 0 != entry[0] ){
+            names_.insert( entry[0], static_cast<uint32_t>(offsets_.size()) );
+            offsets_.push_back( cursor );
+            lengths_.push_back( entry[1] );
+        }
+        cursor += entry[1];
+    }
+
+    return true;
+}
+
+std::span<const JournalRecord> JournalSegment::records() const {
+    if( nullptr == header_ ){
+        return {};
+    }
+    return { reinterpret_cast<const JournalRecord*>(data_ + header_->header_bytes), count_ };
+}
+
+std::span<const JournalBlock> JournalSegment::blocks() const {
+    if( nullptr == header_ ){
+        return {};
+    }
+    return { reinterpret_cast<const JournalBlock*>(data_ + sizeof(JournalHeader)), header_->capacity / header_->block_records };
+}
+
+const JournalHeader& JournalSegment::header() const {
+    return *header_;
+}
+
+std::string_view JournalSegment::name( uint32_t handle ) const {
+    const uint32_t found = (0 == handle) ? FlatIndex::npos : names_.find( handle );
+    if( FlatIndex::npos == found ){
+        return {};
+    }
+    return { text_.data() + offsets_[found], lengths_[found] };
+}
+
+Report JournalSegment::report( const JournalRecord& record ) const {
+    const auto remap = [this]( uint32_t handle ) -> uint32_t {
+        if( 0 == handle ){
+            return 0;
+        }
+        const uint32_t found = interned_.find( handle );
+        if( FlatIndex::npos != found ){
+            return found;
+        }
+        const std::string_view text = name( handle );
+        const uint32_t interned = text.empty() ? 0 : NameTable::global().intern( text );
+        interned_.insert( handle, interned );
+        return interned;
+    };
+
+    Report report;
+    report.timestamp = record.timestamp;
+    report.id = record.id;
+    report.latitude = record.latitude;
+    report.longitude = record.longitude;
+    report.easting = record.easting;
+    report.northing = record.northing;
+    report.heading = record.heading;
+    report.course = record.course;
+    report.speed = record.speed;
+    report.name = remap( record.name );
+    report.station = remap( record.station );
+    report.fields = record.fields;
+    report.source = static_cast<Report::SOURCE_SENSOR>( (record.source <= Report::VISUAL) ? record.source : Report::UNKNOWN );
+    report.status = record.status;
+    return report;
+}
+
+// ====== JournalReader ======
+
+JournalReader::JournalReader( const std::string& directory ){
+    for( const uint32_t number : Journal::segments(directory) ){
+        JournalSegment segment;
+        if( segment.open(directory, number) ){
+            segments_.push_back( std::move(segment) );
+        }else{
+            fprintf( stderr, "!! could not open journal segment; skipping: %s\n", Journal::segment_path(directory, number).c_str() );
+        }
+    }
+}
+
+const std::vector<JournalSegment>& JournalReader::segments() const {
+    return segments_;
+}
+
+size_t JournalReader::size() const {
+    size_t count = 0;
+    for( const JournalSegment& segment : segments_ ){
+        count += segment.records().size();
+    }
+    return count;
+}
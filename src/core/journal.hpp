@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "flat-index.hpp"
+#include "report.hpp"
+
+// ====== On-Disk Layout ======
+//
+// Native byte order.  A journal is a directory of numbered segments; each segment is a pair of files:
+//
+//     journal-NNNNNN.dat
+//         JournalHeader
+//         JournalBlock[block_count]         time index: one entry per `block_records` records
+//         (zero padding, to `header_bytes`)
+//         JournalRecord[capacity]           only the first `count` are committed
+//
+//     journal-NNNNNN.names
+//         { uint32_t handle; uint32_t length; char text[length]; } ...
+//
+// A segment is created at full size, and mapped; records are appended in arrival order, and
+// `count` is published last -- so a reader never sees a partial record.  A sealed segment is
+// truncated to its committed records.
+//
+// Names are NameTable handles, which are only meaningful within one process: so each segment's
+// `.names` file holds the text of every handle its records reference, written before the records
+// that reference it are committed.
+
+/// \brief first bytes of every segment
+struct JournalHeader {
+    char magic[8];
+    /// \brief layout version; see: `Journal::format`
+    uint32_t format;
+    uint32_t record_size;
+
+    /// \brief offset of the first record
+    uint32_t header_bytes;
+    /// \brief records per time-index entry
+    uint32_t block_records;
+
+    uint64_t capacity;
+
+    /// \brief committed records; written last, by each commit
+    uint64_t count;
+
+    /// \brief range of committed timestamps (usec)
+    uint64_t min_timestamp;
+    uint64_t max_timestamp;
+
+    uint64_t reserved;
+};
+static_assert( 64 == sizeof(JournalHeader) );
+static_assert( std::is_trivially_copyable_v<JournalHeader> );
+
+/// \brief time range of one block of records
+struct JournalBlock {
+    uint64_t min_timestamp;
+    uint64_t max_timestamp;
+};
+static_assert( 16 == sizeof(JournalBlock) );
+
+/// \brief one update, as applied to the cache: i.e. after projection
+struct JournalRecord {
+    uint64_t timestamp;
+    uint64_t id;
+    double latitude;
+    double longitude;
+    float easting;
+    float northing;
+    float heading;
+    float course;
+    float speed;
+    /// \brief NameTable handles, as written; see: `JournalSegment::name`
+    uint32_t name;
+    uint32_t station;
+    uint16_t fields;
+    uint8_t source;
+    uint8_t status;
+};
+static_assert( 64 == sizeof(JournalRecord) );
+static_assert( std::is_trivially_copyable_v<JournalRecord> );
+
+
+class Journal {
+public:
+    constexpr static uint32_t format = 1;
+
+    /// \brief default segment size: 1M records, i.e. 64 MB
+    constexpr static size_t segment_records = 1 << 20;
+
+    /// \brief records per time-index entry
+    constexpr static size_t block_records = 4096;
+
+public:
+    /// \return path of the given segment's record file, within `directory`
+    static std::string segment_path( const std::string& directory, uint32_t number );
+
+    /// \return path of the given segment's name file, within `directory`
+    static std::string names_path( const std::string& directory, uint32_t number );
+
+    /// \return every segment number in `directory`, ascending
+    static std::vector<uint32_t> segments( const std::string& directory );
+};
+
+
+/// \brief appends every update to a journal; on its own thread, so that ingest never waits on the disk
+///
+/// `append` copies the update into a pending buffer, and returns.  The writer thread wakes every
+/// `commit_interval` -- or sooner, once enough records are pending -- and commits the whole
+/// buffer at once: one copy into the mapped segment, one write of any new names, then one
+/// update of the segment's count.  (group commit)
+///
+/// Records are durable against a crash of this process as soon as they are committed; against a
+/// crash of the host only once their segment is sealed.  (by `msync`)
+///
+/// If the disk falls behind far enough that `max_pending` records are waiting, further
+/// updates are dropped, and counted, rather than blocking ingest.
+class JournalWriter {
+public:
+    /// \param directory created if missing.  Segments already present are kept; new segments are numbered after them.
+    /// \param segment_records records per segment; rounded up to a whole number of time-index blocks
+    explicit JournalWriter( const std::string& directory,
+                            size_t segment_records = Journal::segment_records,
+                            std::chrono::milliseconds commit_interval = std::chrono::milliseconds(50),
+                            size_t max_pending = 1 << 20 );
+    JournalWriter( const JournalWriter& ) = delete;
+    JournalWriter& operator=( const JournalWriter& ) = delete;
+
+    /// \brief commits every pending record, and seals the current segment; then stops
+    ~JournalWriter();
+
+    /// \return false if the journal directory, or a segment, could not be created
+    bool good() const;
+
+    /// \brief queue one update for the journal
+    ///
+    /// Never blocks on I/O.  Safe from any thread.
+    void append( const Report& report );
+
+    /// \return number of records committed
+    size_t written() const;
+
+    /// \return number of records dropped: by a full pending buffer, or a failed segment
+    size_t dropped() const;
+
+    /// \return number of group commits
+    size_t commits() const;
+
+private:
+    /// \brief the segment being written; mapped read-write
+    struct Segment {
+        uint32_t number = 0;
+        int descriptor = -1;
+        int names_descriptor = -1;
+        uint8_t* data = nullptr;
+        size_t bytes = 0;
+        JournalHeader* header = nullptr;
+        JournalBlock* blocks = nullptr;
+        JournalRecord* records = nullptr;
+        uint64_t count = 0;
+
+        /// handles already written to this segment's `.names`
+        FlatIndex names;
+    };
+
+    void run();
+
+    /// \brief copy the batch into the current segment(s), then publish the new count
+    void commit( const std::vector<JournalRecord>& batch );
+
+    /// \brief create, size, and map the next segment
+    bool open_segment();
+
+    /// \brief publish, flush, and unmap the current segment; then truncate it to its committed records
+    void seal();
+
+    /// \brief queue the handle's text for the current segment's `.names`, if not already written
+    void note_name( uint32_t handle );
+
+    /// \brief write the queued names; before the records which reference them are committed
+    bool flush_names();
+
+private:
+    const std::string directory_;
+    const size_t segment_records_;
+    const std::chrono::milliseconds commit_interval_;
+    const size_t max_pending_;
+
+    // written only by the writer thread
+    Segment segment_;
+    uint32_t next_number_;
+    std::string names_buffer_;
+
+    std::mutex guard_;
+    std::condition_variable wake_;
+    /// filled by `append`; swapped out whole by each commit
+    std::vector<JournalRecord> pending_;
+    bool stop_;
+
+    std::atomic<bool> good_;
+    std::atomic<size_t> written_;
+    std::atomic<size_t> dropped_;
+    std::atomic<size_t> commits_;
+
+    // last: so the thread starts after every other member is ready
+    std::thread worker_;
+
+};
+
+
+/// \brief one segment of a journal; mapped read-only
+///
+/// Sees every record committed before `open`; including those of a segment still being written.
+class JournalSegment {
+public:
+    JournalSegment() = default;
+    JournalSegment( const JournalSegment& ) = delete;
+    JournalSegment& operator=( const JournalSegment& ) = delete;
+    JournalSegment( JournalSegment&& other );
+    JournalSegment& operator=( JournalSegment&& other );
+
+    ~JournalSegment();
+
+    /// \brief map the segment, and load its names
+    /// \return false if missing, truncated, or not a journal segment
+    bool open( const std::string& directory, uint32_t number );
+
+    /// \brief every committed record, in arrival order; points into the mapping
+    std::span<const JournalRecord> records() const;
+
+    /// \brief the time index: one entry per `Journal::block_records` records
+    std::span<const JournalBlock> blocks() const;
+
+    const JournalHeader& header() const;
+
+    /// \return text of the handle, as written; empty if unknown
+    std::string_view name( uint32_t handle ) const;
+
+    /// \brief convert a record back into a report; re-interning its names into this process's NameTable
+    Report report( const JournalRecord& record ) const;
+
+private:
+    void release();
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t bytes_ = 0;
+    const JournalHeader* header_ = nullptr;
+    uint64_t count_ = 0;
+
+    /// text of every name in the segment; handle => entry in `offsets_` / `lengths_`
+    std::string text_;
+    FlatIndex names_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> lengths_;
+
+    /// handle => handle in this process; filled lazily by `report`
+    mutable FlatIndex interned_;
+
+};
+
+
+/// \brief reads a journal: every segment, in order
+class JournalReader {
+public:
+    /// \brief map every segment in the directory; skips (and logs) any that fail to open
+    explicit JournalReader( const std::string& directory );
+
+    const std::vector<JournalSegment>& segments() const;
+
+    /// \return number of committed records, over every segment
+    size_t size() const;
+
+    /// \brief visit every record with `begin <= timestamp < end`, in journal order, without copying
+    /// \param visitor called as `visitor( const JournalRecord&, const JournalSegment& )`
+    /// \return number of records visited
+    ///
+    /// Segments and blocks entirely outside the range are skipped by the time index.
+    template<typename visitor_t>
+    size_t scan( uint64_t begin, uint64_t end, visitor_t&& visitor ) const;
+
+private:
+    std::vector<JournalSegment> segments_;
+
+};
+
+
+template<typename visitor_t>
+size_t JournalReader::scan( uint64_t begin, uint64_t end, visitor_t&& visitor ) const {
+    size_t visited = 0;
+    for( const JournalSegment& segment : segments_ ){
+        const JournalHeader& header = segment.header();
+        const std::span<const JournalRecord> records = segment.records();
+        if( records.empty() || (end <= header.min_timestamp) || (header.max_timestamp < begin) ){
+            continue;
+        }
+
+        const std::span<const JournalBlock> blocks = segment.blocks();
+        for( size_t block = 0; (block * header.block_records) < records.size(); ++block ){
+            if( (block < blocks.size()) && ((end <= blocks[block].min_timestamp) || (blocks[block].max_timestamp < begin)) ){
+                continue;
+            }
+            const size_t first = block * header.block_records;
+            const size_t last = std::min<size_t>( first + header.block_records, records.size() );
+            for( size_t i = first; i < last; ++i ){
+                const JournalRecord& record = records[i];
+                if( (begin <= record.timestamp) && (record.timestamp < end) ){
+                    visitor( record, segment );
+                    ++visited;
+                }
+            }
+        }
+    }
+    return visited;
+}
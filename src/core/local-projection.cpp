@@ -0,0 +1,181 @@
+#include <cmath>
+
+#include "local-projection.hpp"
+
+// finite-difference step (degrees); ~1km.  Large enough that UTM round-off is negligible.
+constexpr static double step = 0.01;
+
+// calibration searches radii from `radius_minimum` up to `radius_maximum` (meters)
+constexpr static double radius_minimum = 100.;
+constexpr static double radius_maximum = 500'000.;
+
+// number of bearings sampled per calibration ring; the error varies with bearing, so too few miss its peak
+constexpr static int ring_samples = 64;
+
+// approximate meters per degree of latitude; only used to place calibration samples
+constexpr static double meters_per_degree = 111'320.;
+
+bool LocalProjection::calibrate( PJ* projection, double latitude, double longitude, double max_error ){
+    radius_ = 0;
+    if( (nullptr == projection) || std::isnan(latitude) || std::isnan(longitude) || !(0 < max_error) ){
+        return false;
+    }
+
+    anchor_latitude_ = latitude;
+    anchor_longitude_ = longitude;
+    max_error_ = max_error;
+
+    const PJ_COORD origin = proj_trans( projection, PJ_FWD, proj_coord(latitude, longitude, 0, 0) );
+
+    // the exact transform, relative to the anchor
+    auto exact = [&]( double dlat, double dlon, double& easting, double& northing ){
+        const PJ_COORD result = proj_trans( projection, PJ_FWD, proj_coord(latitude + dlat, longitude + dlon, 0, 0) );
+        easting = result.enu.e - origin.enu.e;
+        northing = result.enu.n - origin.enu.n;
+    };
+
+    // central differences: first derivatives, pure second derivatives, and the mixed derivative
+    double e_pp, n_pp, e_mm, n_mm;  // (+dlat, +dlon), (-dlat, -dlon)
+    double e_pm, n_pm, e_mp, n_mp;  // (+dlat, -dlon), (-dlat, +dlon)
+    double e_p0, n_p0, e_m0, n_m0;  // (+dlat, 0), (-dlat, 0)
+    double e_0p, n_0p, e_0m, n_0m;  // (0, +dlon), (0, -dlon)
+    exact(  step,  step, e_pp, n_pp );
+    exact( -step, -step, e_mm, n_mm );
+    exact(  step, -step, e_pm, n_pm );
+    exact( -step,  step, e_mp, n_mp );
+    exact(  step,     0, e_p0, n_p0 );
+    exact( -step,     0, e_m0, n_m0 );
+    exact(     0,  step, e_0p, n_0p );
+    exact(     0, -step, e_0m, n_0m );
+
+    // (the exact value at the anchor is zero, by construction)
+    east_[0] = (e_p0 - e_m0) / (2*step);
+    east_[1] = (e_0p - e_0m) / (2*step);
+    east_[2] = (e_p0 + e_m0) / (2*step*step);
+    east_[3] = (e_pp - e_pm - e_mp + e_mm) / (4*step*step);
+    east_[4] = (e_0p + e_0m) / (2*step*step);
+
+    north_[0] = (n_p0 - n_m0) / (2*step);
+    north_[1] = (n_0p - n_0m) / (2*step);
+    north_[2] = (n_p0 + n_m0) / (2*step*step);
+    north_[3] = (n_pp - n_pm - n_mp + n_mm) / (4*step*step);
+    north_[4] = (n_0p + n_0m) / (2*step*step);
+
+    // worst error on a ring of the given radius, vs. the exact transform
+    //
+    // `forward` tests the radius in the projected frame; so place each sample at exactly that
+    // distance, rather than trusting `meters_per_degree`: error grows with the cube of distance, so
+    // a ring 2% short under-states the error at the radius by 6%.
+    const double cos_latitude = std::cos( latitude * M_PI / 180. );
+    auto ring_error = [&]( double radius ){
+        double worst = 0;
+        for( int i = 0; i < ring_samples; ++i ){
+            const double bearing = (2 * M_PI * i) / ring_samples;
+            double dlat = radius * std::cos(bearing) / meters_per_degree;
+            double dlon = radius * std::sin(bearing) / (meters_per_degree * cos_latitude);
+            double exact_e, exact_n, approx_e, approx_n;
+            exact( dlat, dlon, exact_e, exact_n );
+            // the map is near-linear over the ring; one rescale lands within a few ppm of it
+            const double scale = radius / std::hypot( exact_e, exact_n );
+            dlat *= scale;
+            dlon *= scale;
+            exact( dlat, dlon, exact_e, exact_n );
+            evaluate( dlat, dlon, approx_e, approx_n );
+            worst = std::fmax( worst, std::hypot(exact_e - approx_e, exact_n - approx_n) );
+        }
+        return worst;
+    };
+
+    // grow the radius until the error bound breaks; then bisect down to within 1%
+    double inside = 0;
+    double outside = radius_minimum;
+    while( ring_error(outside) <= max_error ){
+        inside = outside;
+        outside *= 2;
+        if( radius_maximum < outside ){
+            radius_ = radius_maximum;
+            return true;
+        }
+    }
+    while( (outside - inside) > (0.01 * outside) ){
+        const double middle = 0.5 * (inside + outside);
+        if( ring_error(middle) <= max_error ){
+            inside = middle;
+        }else{
+            outside = middle;
+        }
+    }
+
+    radius_ = inside;
+    return (0 < radius_);
+}
+
+size_t LocalProjection::forward( double* __restrict x, double* __restrict y, uint8_t* __restrict outside, size_t count ) const {
+    const double radius_squared = radius_ * radius_;
+    const double latitude0 = anchor_latitude_;
+    const double longitude0 = anchor_longitude_;
+
+    // .1. evaluate every point; branch-free, and only touching doubles, so this vectorizes
+    for( size_t i = 0; i < count; ++i ){
+        double easting, northing;
+        evaluate( x[i] - latitude0, y[i] - longitude0, easting, northing );
+        x[i] = easting;
+        y[i] = northing;
+    }
+
+    // .2. flag, and count, the points which need the exact transform
+    size_t outside_count = 0;
+    for( size_t i = 0; i < count; ++i ){
+        const bool beyond = (radius_squared < (x[i]*x[i] + y[i]*y[i]));
+        outside[i] = beyond;
+        outside_count += beyond;
+    }
+
+    return outside_count;
+}
+
+bool LocalProjection::forward( double latitude, double longitude, double& easting, double& northing ) const {
+    evaluate( latitude - anchor_latitude_, longitude - anchor_longitude_, easting, northing );
+    return ((easting*easting + northing*northing) <= (radius_ * radius_));
+}
+
+bool LocalProjection::inverse( double easting, double northing, double& latitude, double& longitude ) const {
+    // Newton's method on the polynomial; start from the inverse of the linear terms
+    const double determinant = east_[0]*north_[1] - east_[1]*north_[0];
+    double dlat = ( north_[1]*easting - east_[1]*northing) / determinant;
+    double dlon = (-north_[0]*easting + east_[0]*northing) / determinant;
+
+    // quadratic convergence: within the valid radius, 3 iterations reach round-off
+    for( int iteration = 0; iteration < 3; ++iteration ){
+        double guess_e, guess_n;
+        evaluate( dlat, dlon, guess_e, guess_n );
+        const double residual_e = easting - guess_e;
+        const double residual_n = northing - guess_n;
+
+        // jacobian at the current guess
+        const double de_dlat = east_[0]  + 2*east_[2]*dlat  + east_[3]*dlon;
+        const double de_dlon = east_[1]  + east_[3]*dlat    + 2*east_[4]*dlon;
+        const double dn_dlat = north_[0] + 2*north_[2]*dlat + north_[3]*dlon;
+        const double dn_dlon = north_[1] + north_[3]*dlat   + 2*north_[4]*dlon;
+        const double jacobian_determinant = de_dlat*dn_dlon - de_dlon*dn_dlat;
+
+        dlat += ( dn_dlon*residual_e - de_dlon*residual_n) / jacobian_determinant;
+        dlon += (-dn_dlat*residual_e + de_dlat*residual_n) / jacobian_determinant;
+    }
+
+    latitude = anchor_latitude_ + dlat;
+    longitude = anchor_longitude_ + dlon;
+    return ((easting*easting + northing*northing) <= (radius_ * radius_));
+}
+
+double LocalProjection::max_error() const {
+    return max_error_;
+}
+
+double LocalProjection::radius() const {
+    return radius_;
+}
+
+bool LocalProjection::valid() const {
+    return (0 < radius_);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <proj.h>
+
+/// \brief fast approximation of the cache's local frame, around its anchor
+///
+/// The cache's local frame is (UTM easting/northing) - (UTM of the anchor). This
+/// class fits a second-order Taylor expansion of that exact mapping, in degrees of
+/// latitude/longitude from the anchor:
+///
+///     easting  = e0*dlat + e1*dlon + e2*dlat^2 + e3*dlat*dlon + e4*dlon^2
+///     northing = n0*dlat + n1*dlon + n2*dlat^2 + n3*dlat*dlon + n4*dlon^2
+///
+/// The coefficients come from finite differences of the real PROJ transform, so the
+/// fit includes the UTM scale factor and grid convergence.  A plain ENU tangent plane
+/// would differ from PROJ by tens of meters at 20km; this fit does not.
+///
+/// ## Accuracy
+/// Error grows with the cube of the distance from the anchor.  At mid-latitudes,
+/// compared against the full UTM transform:
+///
+///  distance from anchor |  5 km  | 10 km  | 20 km  | 30 km  | 50 km  | 100 km
+/// ---------------------:|-------:|-------:|-------:|-------:|-------:|-------:
+///      worst-case error | < 1 mm |   5 mm |  4 cm  |  13 cm |  60 cm |  4.8 m
+///
+/// `calibrate` measures this against PROJ, and finds the radius within which the error
+/// stays below the requested bound.  Callers must fall back to PROJ beyond that radius.
+class LocalProjection {
+public:
+    LocalProjection() = default;
+
+    /// \brief fit the approximation to `projection` around the given anchor
+    /// \param max_error error bound, in meters; sets the valid radius
+    /// \return true on success
+    bool calibrate( PJ* projection, double latitude, double longitude, double max_error );
+
+    /// \brief batch forward transform, in place: (latitude, longitude) => (easting, northing)
+    ///
+    /// Points beyond the valid radius are flagged in `outside`; their outputs are approximate,
+    /// and should be replaced with the exact transform.
+    /// The loops are branch-free over plain arrays, so that the compiler vectorizes them.
+    /// \return number of points outside the valid radius
+    size_t forward( double* x, double* y, uint8_t* outside, size_t count ) const;
+
+    /// \brief single-point forward transform
+    /// \return false if the point is beyond the valid radius -- (outputs are still set)
+    bool forward( double latitude, double longitude, double& easting, double& northing ) const;
+
+    /// \brief inverse transform: (easting, northing) => (latitude, longitude)
+    /// \return false if the point is beyond the valid radius -- (outputs are still set)
+    bool inverse( double easting, double northing, double& latitude, double& longitude ) const;
+
+    /// \return the error bound this projection was calibrated to (meters)
+    double max_error() const;
+
+    /// \return radius around the anchor in which the error bound holds (meters); 0 if uncalibrated
+    double radius() const;
+
+    bool valid() const;
+
+private:
+    /// \brief evaluate the polynomial for degree-offsets from the anchor
+    inline void evaluate( double dlat, double dlon, double& easting, double& northing ) const {
+        const double dlat2 = dlat*dlat;
+        const double dlatlon = dlat*dlon;
+        const double dlon2 = dlon*dlon;
+        easting  = east_[0]*dlat  + east_[1]*dlon  + east_[2]*dlat2  + east_[3]*dlatlon  + east_[4]*dlon2;
+        northing = north_[0]*dlat + north_[1]*dlon + north_[2]*dlat2 + north_[3]*dlatlon + north_[4]*dlon2;
+    }
+
+private:
+    double anchor_latitude_ = 0;
+    double anchor_longitude_ = 0;
+
+    double east_[5] = {};
+    double north_[5] = {};
+
+    double max_error_ = 0;
+    double radius_ = 0;
+
+};
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+
+#include "name-table.hpp"
+
+NameTable& NameTable::global(){
+    static NameTable table;
+    return table;
+}
+
+uint32_t NameTable::intern( std::string_view text ){
+    if( text.empty() ){
+        return 0;
+    }
+
+    const size_t hash = std::hash<std::string_view>{}(text);
+
+    {   // fast path: already interned
+        std::shared_lock lock(guard_);
+        if( ! table_.empty() ){
+            const uint32_t found = table_[probe(text, hash)];
+            if( 0 != found ){
+                return found;
+            }
+        }
+    }
+
+    std::unique_lock lock(guard_);
+    if( table_.size() <= (2 * (strings_.size() + 1)) ){
+        grow();
+    }
+
+    // re-check; another thread may have inserted between the locks
+    const size_t position = probe(text, hash);
+    if( 0 != table_[position] ){
+        return table_[position];
+    }
+
+    strings_.push_back( store(text) );
+    const uint32_t handle = static_cast<uint32_t>(strings_.size());
+    table_[position] = handle;
+    return handle;
+}
+
+uint32_t NameTable::find( std::string_view text ) const {
+    if( text.empty() ){
+        return 0;
+    }
+
+    const size_t hash = std::hash<std::string_view>{}(text);
+
+    std::shared_lock lock(guard_);
+    if( table_.empty() ){
+        return 0;
+    }
+    return table_[probe(text, hash)];
+}
+
+std::string_view NameTable::lookup( uint32_t handle ) const {
+    std::shared_lock lock(guard_);
+    if( (0 == handle) || (strings_.size() < handle) ){
+        return {};
+    }
+    return strings_[handle - 1];
+}
+
+size_t NameTable::size() const {
+    std::shared_lock lock(guard_);
+    return strings_.size();
+}
+
+AllocationStats NameTable::allocations() const {
+    std::shared_lock lock(guard_);
+    AllocationStats stats;
+    stats.blocks = chunks_.size();
+    stats.reserved = reserved_
+                   + strings_.capacity() * sizeof(std::string_view)
+                   + table_.capacity() * sizeof(uint32_t);
+    stats.used = used_;
+    stats.live = strings_.size();
+    stats.allocations = strings_.size();
+    return stats;
+}
+
+size_t NameTable::probe( std::string_view text, size_t hash ) const {
+    const size_t mask = table_.size() - 1;
+    for( size_t position = hash & mask; ; position = (position + 1) & mask ){
+        const uint32_t handle = table_[position];
+        if( (0 == handle) || (text == strings_[handle - 1]) ){
+            return position;
+        }
+    }
+}
+
+std::string_view NameTable::store( std::string_view text ){
+    if( remaining_ < text.size() ){
+        const size_t size = std::max( chunk_size, text.size() );
+        chunks_.emplace_back( new char[size] );
+        cursor_ = chunks_.back().get();
+        remaining_ = size;
+        reserved_ += size;
+    }
+
+    char* const stored = cursor_;
+    std::memcpy( stored, text.data(), text.size() );
+    cursor_ += text.size();
+    remaining_ -= text.size();
+    used_ += text.size();
+    return { stored, text.size() };
+}
+
+void NameTable::grow(){
+    const size_t capacity = table_.empty() ? 1024 : 2 * table_.size();
+    table_.assign( capacity, 0 );
+
+    const size_t mask = capacity - 1;
+    for( uint32_t handle = 1; handle <= strings_.size(); ++handle ){
+        size_t position = std::hash<std::string_view>{}(strings_[handle - 1]) & mask;
+        while( 0 != table_[position] ){
+            position = (position + 1) & mask;
+        }
+        table_[position] = handle;
+    }
+}
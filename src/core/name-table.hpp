@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include "allocation-stats.hpp"
+
+/// \brief process-wide table of interned strings -- i.e. track names and station names
+///
+/// Reports and tracks carry a 32-bit handle instead of an inline `std::string`.
+/// Handle 0 is reserved for "no name".  Interned strings are never freed, and
+/// the views returned by `lookup` stay valid for the life of the process.
+///
+/// Strings are packed into 64KB arena chunks, and indexed by an open-addressing table of
+/// handles; so interning a new name costs no per-string heap allocation.
+///
+/// Safe to call from any thread.
+class NameTable {
+public:
+    /// \brief the single, shared table
+    static NameTable& global();
+
+    /// \brief find-or-insert the given text
+    /// \return handle to the text; 0 if the text is empty
+    uint32_t intern( std::string_view text );
+
+    /// \brief find the given text, without inserting it
+    /// \return handle to the text; 0 if the text is empty or not present
+    uint32_t find( std::string_view text ) const;
+
+    /// \return the text for a handle; an empty view for 0 or an unknown handle
+    std::string_view lookup( uint32_t handle ) const;
+
+    size_t size() const;
+
+    /// \return allocation counters for the string arena and its index
+    AllocationStats allocations() const;
+
+private:
+    NameTable() = default;
+
+    /// \return position in `table_` of the text's handle; or of the empty slot where it belongs
+    size_t probe( std::string_view text, size_t hash ) const;
+
+    /// \brief copy the text into the arena
+    std::string_view store( std::string_view text );
+
+    /// \brief double the index's capacity
+    void grow();
+
+private:
+    /// bytes per arena chunk.  (longer strings get a chunk of their own)
+    constexpr static size_t chunk_size = 64 * 1024;
+
+    mutable std::shared_mutex guard_;
+
+    /// arena: append-only chunks; never moved or freed, so views into them stay valid
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* cursor_ = nullptr;
+    size_t remaining_ = 0;
+    size_t reserved_ = 0;
+    size_t used_ = 0;
+
+    /// indexed by handle - 1
+    std::vector<std::string_view> strings_;
+
+    /// hash set of handles, probed linearly.  0 => empty; capacity is a power of two, at most half full
+    std::vector<uint32_t> table_;
+
+};
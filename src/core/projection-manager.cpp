@@ -0,0 +1,73 @@
+#include <cmath>
+#include <cstdio>
+
+#include "projection-manager.hpp"
+
+
+ProjectionManager::ProjectionManager()
+    : context(proj_context_create())
+{
+    zones.fill( nullptr );
+}
+
+ProjectionManager::~ProjectionManager(){
+    for( PJ*& each : zones ){
+        proj_destroy( each );
+        each = nullptr;
+    }
+
+    proj_context_destroy( context );
+    context = nullptr;
+}
+
+int ProjectionManager::zone_of( double longitude ){
+    // wrap into [-180, 180)
+    const double wrapped = longitude - 360. * std::floor( (longitude + 180.) / 360. );
+    return (static_cast<int>((wrapped + 180.) / 6.) % zone_count) + 1;
+}
+
+PJ* ProjectionManager::get( int zone ){
+    if( (zone < 1) || (zone_count < zone) ){
+        return nullptr;
+    }
+
+    PJ*& cached = zones[zone - 1];
+    if( nullptr == cached ){
+        char projection_definition[36];
+        snprintf( projection_definition, sizeof(projection_definition), "+proj=utm +zone=%d +datum=WGS84", zone );
+        cached = proj_create_crs_to_crs( context, "EPSG:4326", projection_definition, nullptr );
+        if( nullptr == cached ){
+            fprintf( stderr, "!! could not create projection: %s\n", projection_definition );
+        }
+    }
+
+    return cached;
+}
+
+PJ* ProjectionManager::find( int zone ) const {
+    if( (zone < 1) || (zone_count < zone) ){
+        return nullptr;
+    }
+    return zones[zone - 1];
+}
+
+PJ* ProjectionManager::clone( int zone, const PJ* prototype ){
+    if( (zone < 1) || (zone_count < zone) || (nullptr == prototype) ){
+        return nullptr;
+    }
+
+    PJ*& cached = zones[zone - 1];
+    if( nullptr == cached ){
+        cached = proj_clone( context, prototype );
+    }
+
+    return cached;
+}
+
+size_t ProjectionManager::size() const {
+    size_t count = 0;
+    for( const PJ* each : zones ){
+        count += (nullptr != each);
+    }
+    return count;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <proj.h>
+
+/// \brief owns a PROJ context, and a lazily-built WGS84 => UTM projection per zone
+///
+/// Building a projection (`proj_create_crs_to_crs`) costs milliseconds, and allocates; so
+/// each zone's projection is built once, on first use, then reused for the life of the
+/// manager.  Any number of zones may be held at once.
+///
+/// Not thread-safe: PROJ objects belong to their context, and a context must only be used
+/// from one thread at a time.
+class ProjectionManager {
+public:
+    /// number of UTM zones
+    constexpr static int zone_count = 60;
+
+public:
+    ProjectionManager();
+    ProjectionManager( const ProjectionManager& ) = delete;
+    ProjectionManager& operator=( const ProjectionManager& ) = delete;
+
+    ~ProjectionManager();
+
+    /// \return UTM zone (1-60) containing the given longitude
+    ///
+    /// Reference: https://mangomap.com/robertyoung/maps/69585/what-utm-zone-am-i-in-#
+    static int zone_of( double longitude );
+
+    /// \return the WGS84 => UTM projection for the given zone; nullptr on failure
+    PJ* get( int zone );
+
+    /// \return the projection for the given zone, if already built; else nullptr
+    PJ* find( int zone ) const;
+
+    /// \brief copy another manager's projection into this manager's context
+    ///
+    /// Cheaper than building the projection from scratch.  `prototype` must not be in use
+    /// by another thread during this call.
+    /// \return the (cached) clone; nullptr on failure
+    PJ* clone( int zone, const PJ* prototype );
+
+    /// \return number of zone projections built so far
+    size_t size() const;
+
+private:
+    PJ_CONTEXT* context;
+
+    /// indexed by zone - 1
+    std::array<PJ*, zone_count> zones;
+
+};
@@ -0,0 +1,89 @@
+#include <atomic>
+#include <vector>
+
+#include "projection-service.hpp"
+
+namespace {
+
+/// \brief per-thread cache of (service => manager), so that steady-state lookups skip the lock
+struct LocalEntry {
+    uint64_t serial;
+    ProjectionManager* manager;
+};
+
+// a thread rarely uses more than a handful of services; so a short list beats a map
+constexpr size_t local_entry_limit = 16;
+
+thread_local std::vector<LocalEntry> local_entries;
+
+std::atomic<uint64_t> next_serial(1);
+
+}  // namespace
+
+
+ProjectionService::ProjectionService()
+    : serial(next_serial.fetch_add(1))
+{}
+
+ProjectionService::~ProjectionService(){
+    // the prototypes are destroyed last, after every clone
+    std::lock_guard lock(guard);
+    threads.clear();
+}
+
+PJ* ProjectionService::get( int zone ){
+    ProjectionManager& mine = local();
+
+    // .1. fast path: this thread already holds a clone
+    PJ* cached = mine.find( zone );
+    if( nullptr != cached ){
+        return cached;
+    }
+
+    // .2. slow path: clone from the shared prototype, building that first if needed
+    std::lock_guard lock(guard);
+    return mine.clone( zone, prototypes.get(zone) );
+}
+
+void ProjectionService::release(){
+    for( auto it = local_entries.begin(); it != local_entries.end(); ++it ){
+        if( serial == it->serial ){
+            local_entries.erase( it );
+            break;
+        }
+    }
+
+    std::lock_guard lock(guard);
+    threads.erase( std::this_thread::get_id() );
+}
+
+size_t ProjectionService::thread_count() const {
+    std::lock_guard lock(guard);
+    return threads.size();
+}
+
+ProjectionManager& ProjectionService::local(){
+    for( const LocalEntry& each : local_entries ){
+        if( serial == each.serial ){
+            return *each.manager;
+        }
+    }
+
+    ProjectionManager* manager = nullptr;
+    {
+        std::lock_guard lock(guard);
+        auto& slot = threads[std::this_thread::get_id()];
+        if( ! slot ){
+            slot = std::make_unique<ProjectionManager>();
+        }
+        manager = slot.get();
+    }
+
+    // entries for destroyed services are never matched again; so just start over when full
+    if( local_entry_limit <= local_entries.size() ){
+        local_entries.clear();
+    }
+    local_entries.push_back( {serial, manager} );
+
+    return *manager;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <proj.h>
+
+#include "projection-manager.hpp"
+
+/// \brief hands out WGS84 => UTM projections that are safe to use from any thread
+///
+/// A PROJ context (and every `PJ` built in it) must only be used by one thread at a time.
+/// So each calling thread gets its own context, holding clones of a single set of
+/// prototype projections.  Both are built lazily: the prototype on the first request for
+/// a zone from any thread, and the clone on the first request from each thread.
+///
+/// After its first request for a zone, a thread's lookups take no locks.
+///
+/// Every per-thread context is destroyed with the service, or earlier, by `release()`.
+class ProjectionService {
+public:
+    ProjectionService();
+    ProjectionService( const ProjectionService& ) = delete;
+    ProjectionService& operator=( const ProjectionService& ) = delete;
+
+    ~ProjectionService();
+
+    /// \return the projection for the given zone, owned by the calling thread; nullptr on failure
+    ///
+    /// Valid until this thread calls `release()`, or the service is destroyed.
+    PJ* get( int zone );
+
+    /// \brief destroy the calling thread's context, and its projections
+    ///
+    /// Optional: e.g. from a worker thread, before it exits.
+    void release();
+
+    /// \return number of threads holding a context
+    size_t thread_count() const;
+
+private:
+    /// \return the calling thread's manager; created if missing
+    ProjectionManager& local();
+
+private:
+    /// unique per service instance; keys the thread-local lookup cache (addresses may be reused)
+    const uint64_t serial;
+
+    /// guards `prototypes` and `threads`
+    mutable std::mutex guard;
+
+    /// one projection per zone, only used as a source for clones
+    ProjectionManager prototypes;
+
+    std::unordered_map<std::thread::id, std::unique_ptr<ProjectionManager>> threads;
+
+};
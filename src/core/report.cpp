@@ -1,23 +1,16 @@
 #include <cmath>
 #include <cstdlib>
-#include <iostream>
-#include <string>
-#include <string_view>
-
-#include <proj.h>
 
 #include "report.hpp"
 
-using std::isnan;
-using std::atof;
-
-Report::Report( std::string _name, uint64_t _id, double _ts,
-                double _x, double _y, double _heading, 
-                double _course, double _speed)
-    : name(_name), id(_id), timestamp(_ts)
-    //, latitude(NAN), longitude(NAN)
+Report::Report( uint32_t _name, uint64_t _id, uint64_t _ts,
+                float _x, float _y, float _heading, 
+                float _course, float _speed)
+    : id(_id), timestamp(_ts)
     , easting(_x), northing(_y)
     , heading(_heading), course(_course), speed(_speed)
+    , name(_name)
+    , fields( NAME | LOCAL | HEADING | COURSE | SPEED )
 {}
 
 Report& Report::operator=( const Report& other ){
@@ -28,54 +21,38 @@ Report& Report::operator=( const Report& other ){
 
     id = other.id;
     timestamp = other.timestamp;
+    source = other.source;
 
     // a report assignment should just be a naive copy-everything
     // only if we condense into a track should we filter data....
-
-    if( 15 != other.status ){
-        status = other.status;
-    }
-
-    if( ! other.name.empty() ){
-        name = other.name;
-    }
-    if( ! std::isnan(other.latitude) ){
-        latitude = other.latitude;
-        longitude = other.longitude;
-    }
-    if( ! std::isnan(other.easting) ){
-        easting = other.easting;
-        northing = other.northing;
-    }
-    
-    if( ! std::isnan(other.heading) ){
-        heading = other.heading;
-    }
-    if( ! std::isnan(other.course) ){
-        course = other.course;
-    }
-    if( ! std::isnan(speed) ){
-        speed = other.speed;
-    }
+    //
+    // Each field is a select, rather than a branch: these compile down to
+    // conditional-moves, and never mispredict.
+    const uint16_t mask = other.fields;
+
+    name      = (mask & NAME)    ? other.name      : name;
+    station   = (mask & STATION) ? other.station   : station;
+    status    = (mask & STATUS)  ? other.status    : status;
+    latitude  = (mask & GLOBAL)  ? other.latitude  : latitude;
+    longitude = (mask & GLOBAL)  ? other.longitude : longitude;
+    easting   = (mask & LOCAL)   ? other.easting   : easting;
+    northing  = (mask & LOCAL)   ? other.northing  : northing;
+    heading   = (mask & HEADING) ? other.heading   : heading;
+    course    = (mask & COURSE)  ? other.course    : course;
+    speed     = (mask & SPEED)   ? other.speed     : speed;
+
+    fields |= mask;
 
     return *this;
 }
 
 void Report::reset(){
-
+    // values are left in place: they are meaningless once their bit is cleared.
     id = 0;
-    name = "";
-
     timestamp = 0;
+    fields = 0;
     source = UNKNOWN;
     status = 15;
-
-    latitude = NAN;
-    longitude = NAN;
-    easting = NAN;
-    northing = NAN;
-    
-    heading = NAN;
-    course = NAN;
-    speed = NAN;
+    name = 0;
+    station = 0;
 }
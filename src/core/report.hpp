@@ -1,49 +1,99 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 
+/// \brief a single observation of a single target
+///
+/// Compact layout: exactly one 64-byte cache line.  Each optional field has a bit
+/// in `fields`; a field's value is only meaningful if its bit is set.  Names and
+/// stations are handles into the `NameTable`.
 class Report {
+public:
+    /// \brief bits of `Report::fields`
+    enum FIELD : uint16_t {
+        NAME    = 1 << 0,
+        STATION = 1 << 1,
+        STATUS  = 1 << 2,
+        GLOBAL  = 1 << 3,   ///< latitude + longitude
+        LOCAL   = 1 << 4,   ///< easting + northing
+        HEADING = 1 << 5,
+        COURSE  = 1 << 6,
+        SPEED   = 1 << 7,
+    };
+
+    enum SOURCE_SENSOR : uint8_t {
+        AIS, FUSION, INFRARED, MANUAL, RADAR, RADIO, UNKNOWN, VISUAL, 
+    };
+
 public:
     Report() = default;
-    Report(std::string _name, uint64_t _id, double _ts,
-                double _x, double _y, double _heading,
-                double _course, double _speed);
+    Report(uint32_t _name, uint64_t _id, uint64_t _ts,
+                float _x, float _y, float _heading,
+                float _course, float _speed);
+    Report( const Report& other ) = default;
     ~Report() = default;
 
+    /// \brief merge another report into this one
+    ///
+    /// Copies only the fields present in `other`; all other fields keep their current values.
     Report& operator=( const Report& other );
 
+    /// \return true iff every field in `mask` is present
+    inline bool has( uint16_t mask ) const { return mask == (fields & mask); }
+
     void reset();
 
+    inline void set_name( uint32_t _name ){ name = _name; fields |= NAME; }
+    inline void set_station( uint32_t _station ){ station = _station; fields |= STATION; }
+    inline void set_status( uint8_t _status ){ status = _status; fields |= STATUS; }
+    inline void set_global( double _latitude, double _longitude ){
+        latitude = _latitude; longitude = _longitude; fields |= GLOBAL; }
+    inline void set_local( float _easting, float _northing ){
+        easting = _easting; northing = _northing; fields |= LOCAL; }
+    inline void set_heading( float _heading ){ heading = _heading; fields |= HEADING; }
+    inline void set_course( float _course ){ course = _course; fields |= COURSE; }
+    inline void set_speed( float _speed ){ speed = _speed; fields |= SPEED; }
+
 // metadata
 public:
-    std::string name;
     uint64_t id = 0; // 0 => error value
     uint64_t timestamp = 0; // time in usec
-    enum SOURCE_SENSOR {
-        AIS, FUSION, INFRARED, MANUAL, RADAR, RADIO, UNKNOWN, VISUAL, 
-    };
-    SOURCE_SENSOR source = UNKNOWN;
 
-    // see: https://github.com/schwehr/libais/blob/master/ais/lut.py#L5
-    // 15 === 'undefined' navigation status, according to AIS spec
-    int status = 15;
-
-// position / orientation
+// position
 public:
     double latitude = NAN;
     double longitude = NAN;
-    double easting = NAN;  // meters to the right of the origin 
-    double northing = NAN;  // meters upwards from the origin
-
+    float easting = NAN;  // meters to the right of the origin 
+    float northing = NAN;  // meters upwards from the origin
 
-// velocity
+// velocity / orientation
 public:
     /// \brief degrees CW from true north
-    double heading = NAN;
+    float heading = NAN;
     /// \brief degrees CW from true north
-    double course = NAN;
+    float course = NAN;
     /// \brief meters-per-second along course
-    double speed = NAN;
+    float speed = NAN;
+
+// metadata, cont.
+public:
+    /// \brief NameTable handle; 0 => no name
+    uint32_t name = 0;
+
+    /// \brief NameTable handle of the receiving station (e.g. from an NMEA tag block); 0 => unknown
+    uint32_t station = 0;
+
+    /// \brief bitmask of `FIELD` values present in this report
+    uint16_t fields = 0;
+
+    SOURCE_SENSOR source = UNKNOWN;
+
+    // see: https://github.com/schwehr/libais/blob/master/ais/lut.py#L5
+    // 15 === 'undefined' navigation status, according to AIS spec
+    uint8_t status = 15;
 
 };
+
+static_assert( 64 == sizeof(Report), "Report should fill exactly one cache line" );
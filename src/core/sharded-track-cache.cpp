@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "sharded-track-cache.hpp"
+
+thread_local std::vector<uint32_t> ShardedTrackCache::batch_shards_;
+thread_local std::vector<uint32_t> ShardedTrackCache::batch_order_;
+thread_local std::vector<uint32_t> ShardedTrackCache::batch_ends_;
+
+// the shared clock sweeps every shard once per this much report time (usec); as the timing wheel's tick
+constexpr static uint64_t sweep_interval = 1'000'000;
+
+ShardedTrackCache::ShardedTrackCache( size_t shard_count )
+    : clock_(0)
+    , swept_(0)
+{
+    if( 0 == shard_count ){
+        shard_count = std::max( 1u, std::thread::hardware_concurrency() );
+    }
+
+    shards_.reserve( shard_count );
+    for( size_t i = 0; i < shard_count; ++i ){
+        shards_.emplace_back( std::make_unique<Shard>() );
+    }
+}
+
+void ShardedTrackCache::set_origin( double latitude, double longitude ){
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        shard->cache.set_origin( latitude, longitude );
+    }
+}
+
+void ShardedTrackCache::set_projection( TrackCache::PROJECTION_MODE mode, double max_error ){
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        shard->cache.set_projection( mode, max_error );
+    }
+}
+
+void ShardedTrackCache::set_history( uint32_t depth, uint64_t window ){
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        shard->cache.set_history( depth, window );
+    }
+}
+
+void ShardedTrackCache::set_expiry( Report::SOURCE_SENSOR source, uint64_t stale_after, uint64_t expire_after ){
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        shard->cache.set_expiry( source, stale_after, expire_after );
+    }
+}
+
+void ShardedTrackCache::set_budget( size_t max_tracks ){
+    // round up; so that a non-zero budget never becomes zero (i.e. unlimited)
+    const size_t per_shard = (max_tracks + shards_.size() - 1) / shards_.size();
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        shard->cache.set_budget( per_shard );
+    }
+}
+
+void ShardedTrackCache::subscribe( TrackCache::removal_callback callback ){
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        shard->cache.subscribe( callback );
+    }
+}
+
+size_t ShardedTrackCache::expire( uint64_t now ){
+    now = advance( now );
+    swept_.store( now / sweep_interval, std::memory_order_relaxed );
+
+    size_t removed = 0;
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        removed += shard->cache.expire( now );
+    }
+    return removed;
+}
+
+size_t ShardedTrackCache::shard_count() const {
+    return shards_.size();
+}
+
+size_t ShardedTrackCache::shard( uint64_t id ) const {
+    return shard_of( id );
+}
+
+uint64_t ShardedTrackCache::advance( uint64_t now ){
+    uint64_t current = clock_.load( std::memory_order_relaxed );
+    while( (current < now) && (! clock_.compare_exchange_weak(current, now, std::memory_order_relaxed)) ){}
+    return std::max( current, now );
+}
+
+size_t ShardedTrackCache::sweep( uint64_t now ){
+    // one thread sweeps per second of report time; the others carry on
+    const uint64_t second = now / sweep_interval;
+    uint64_t last = swept_.load( std::memory_order_relaxed );
+    if( (second <= last) || (! swept_.compare_exchange_strong(last, second, std::memory_order_relaxed)) ){
+        return 0;
+    }
+
+    size_t removed = 0;
+    for( auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        removed += shard->cache.expire( now );
+    }
+    return removed;
+}
+
+size_t ShardedTrackCache::size() const {
+    size_t total = 0;
+    for( const auto& shard : shards_ ){
+        std::lock_guard lock(shard->guard);
+        total += shard->cache.size();
+    }
+    return total;
+}
+
+bool ShardedTrackCache::update( Report& report ){
+    const uint64_t now = advance( report.timestamp );
+    bool changed = false;
+    {
+        Shard& shard = *shards_[shard_of(report.id)];
+        std::lock_guard lock(shard.guard);
+        shard.cache.expire( now );
+        changed = shard.cache.update( report );
+    }
+    sweep( now );
+    return changed;
+}
+
+size_t ShardedTrackCache::update( std::span<Report> reports ){
+    // .1. partition: a counting sort of the batch's indices by shard, in one pass over the batch
+    const size_t count = shards_.size();
+    batch_shards_.resize( reports.size() );
+    batch_order_.resize( reports.size() );
+    batch_ends_.assign( count, 0 );
+    uint64_t latest = 0;
+    for( size_t i = 0; i < reports.size(); ++i ){
+        batch_shards_[i] = static_cast<uint32_t>( shard_of(reports[i].id) );
+        ++batch_ends_[batch_shards_[i]];
+        latest = std::max( latest, reports[i].timestamp );
+    }
+    // counts => starts; filling then moves each start on to its shard's end
+    uint32_t start = 0;
+    for( uint32_t& each : batch_ends_ ){
+        const uint32_t shard_size = each;
+        each = start;
+        start += shard_size;
+    }
+    for( size_t i = 0; i < reports.size(); ++i ){
+        batch_order_[batch_ends_[batch_shards_[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    // .2. one pass per shard touched, holding that shard's lock for its own reports only
+    const uint64_t now = advance( latest );
+    size_t changed = 0;
+    uint32_t begin = 0;
+    for( size_t shard_index = 0; shard_index < count; ++shard_index ){
+        const uint32_t end = batch_ends_[shard_index];
+        if( begin == end ){
+            continue;
+        }
+
+        Shard& shard = *shards_[shard_index];
+        std::lock_guard lock(shard.guard);
+        shard.cache.expire( now );
+        for( uint32_t position = begin; position < end; ++position ){
+            changed += shard.cache.update( reports[batch_order_[position]] );
+        }
+        begin = end;
+    }
+
+    // .3. and the shards this batch did not touch
+    sweep( now );
+
+    return changed;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "flat-index.hpp"
+#include "report.hpp"
+#include "track.hpp"
+#include "track-cache.hpp"
+
+/// \brief a TrackCache split into N independent shards, by id-hash; for multi-threaded ingest
+///
+/// - each shard has its own lock, index, track storage, and projection service
+/// - ingest threads only contend when they update the same shard at the same time
+/// - aggregate reads lock every shard, in order, and so see one consistent view
+/// - expiry runs on one clock, shared by every shard: the newest report time seen by any of them.
+///   Whenever it crosses a second, every shard is swept; so a shard which receives no reports
+///   still flags and expires its tracks.
+///
+/// Not used by `trackmon` or `ingest` (yet): both apply every source's reports on one pipeline
+/// thread, which owns a plain TrackCache.  (see: IngestPipeline)  This is for callers that update
+/// from several threads at once; `BM_ShardedTrackCache_update` measures how it scales.
+class ShardedTrackCache
+{
+public:
+    /// \param shard_count number of shards; 0 => one per hardware thread
+    ShardedTrackCache( size_t shard_count = 0 );
+
+    ~ShardedTrackCache() = default;
+
+    /// \brief set the local origin on every shard
+    void set_origin( double latitude, double longitude );
+
+    /// \brief select the projection mode of every shard.  (see: TrackCache::set_projection)
+    void set_projection( TrackCache::PROJECTION_MODE mode, double max_error = 0.1 );
+
+    /// \brief configure history on every shard.  (see: TrackCache::set_history)
+    void set_history( uint32_t depth, uint64_t window = 0 );
+
+    /// \brief set expiry ages on every shard.  (see: TrackCache::set_expiry)
+    void set_expiry( Report::SOURCE_SENSOR source, uint64_t stale_after, uint64_t expire_after );
+
+    /// \brief split a track budget evenly across the shards.  (see: TrackCache::set_budget)
+    void set_budget( size_t max_tracks );
+
+    /// \brief subscribe to removals on every shard.  Called under that shard's lock.
+    void subscribe( TrackCache::removal_callback callback );
+
+    /// \brief advance the shared clock, and sweep every shard with it.  (see: TrackCache::expire)
+    ///
+    /// Thread-safe.  Updates advance the clock too; call this while the feed is quiet.
+    /// \return number of tracks removed
+    size_t expire( uint64_t now );
+
+    size_t shard_count() const;
+
+    /// \return the index of the shard which holds the given id
+    size_t shard( uint64_t id ) const;
+
+    size_t size() const;
+
+    /// \brief thread-safe; locks one shard
+    /// \return true if the report created or changed its track.  (see: TrackCache::update)
+    bool update( Report& report );
+
+    /// \brief thread-safe; locks each shard at most once per batch, and only the shards the batch touches
+    /// \return number of reports which created or changed their tracks
+    size_t update( std::span<Report> reports );
+
+    /// \brief visit one track under its shard's lock
+    /// \return false if the track is missing
+    template<typename visitor_t>
+    bool visit( uint64_t id, visitor_t&& visitor ) const {
+        const Shard& shard = *shards_[shard_of(id)];
+        std::lock_guard lock(shard.guard);
+        const Track* track = shard.cache.get(id);
+        if( nullptr == track ){
+            return false;
+        }
+        visitor( *track );
+        return true;
+    }
+
+    /// \brief visit every track, as one consistent view
+    ///
+    /// Every shard stays locked for the whole visit; so keep the visitor short.
+    template<typename visitor_t>
+    void visit( visitor_t&& visitor ) const {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve( shards_.size() );
+        for( const auto& shard : shards_ ){
+            locks.emplace_back( shard->guard );
+        }
+
+        for( const auto& shard : shards_ ){
+            for( auto iter = shard->cache.cbegin(); iter != shard->cache.cend(); ++iter ){
+                visitor( *iter );
+            }
+        }
+    }
+
+private:
+    /// \brief move the shared clock forward to `now`, if it is behind
+    /// \return the shared clock
+    uint64_t advance( uint64_t now );
+
+    /// \brief expire every shard at `now`; if `now` is in a later second than the last sweep
+    /// \return number of tracks removed
+    size_t sweep( uint64_t now );
+
+    inline size_t shard_of( uint64_t id ) const {
+        // use the high bits; each shard's own index consumes the low bits of the same hash
+        return (FlatIndex::mix(id) >> 32) % shards_.size();
+    }
+
+private:
+    // pad each shard to its own cache line(s), so neighboring locks do not false-share
+    struct alignas(64) Shard {
+        mutable std::mutex guard;
+        TrackCache cache;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    /// newest report time seen by any shard (usec)
+    std::atomic<uint64_t> clock_;
+
+    /// second (of `clock_`) of the last sweep over every shard
+    std::atomic<uint64_t> swept_;
+
+    // per-thread scratch for batch updates: each report's shard; then the batch's indices, grouped by shard
+    static thread_local std::vector<uint32_t> batch_shards_;
+    static thread_local std::vector<uint32_t> batch_order_;
+    static thread_local std::vector<uint32_t> batch_ends_;
+
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "allocation-stats.hpp"
+
+/// \brief fixed-size object pool: objects live in slabs of `slab_size`, addressed by 32-bit slot
+///
+/// - addresses are stable: slabs never move, and are never freed before the pool
+/// - released slots go onto a freelist, and are reused (LIFO) before any new slab is allocated
+/// - iteration visits live objects in slot order, skipping released slots
+template<typename T, uint32_t slab_size = 1024>
+class SlabPool {
+public:
+    constexpr static uint32_t npos = UINT32_MAX;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+        const_iterator( const SlabPool* pool, uint32_t slot ) : pool_(pool), slot_(slot) { skip(); }
+
+        inline reference operator*() const { return (*pool_)[slot_]; }
+        inline pointer operator->() const { return &(*pool_)[slot_]; }
+        inline const_iterator& operator++(){ ++slot_; skip(); return *this; }
+        inline const_iterator operator++(int){ const_iterator before = *this; ++(*this); return before; }
+        inline bool operator==( const const_iterator& other ) const { return slot_ == other.slot_; }
+        inline bool operator!=( const const_iterator& other ) const { return slot_ != other.slot_; }
+
+        /// \return slot of the current object
+        inline uint32_t slot() const { return slot_; }
+
+    private:
+        inline void skip(){
+            while( (slot_ < pool_->live_.size()) && (0 == pool_->live_[slot_]) ){
+                ++slot_;
+            }
+        }
+
+    private:
+        const SlabPool* pool_ = nullptr;
+        uint32_t slot_ = 0;
+    };
+
+public:
+    SlabPool() = default;
+    SlabPool( const SlabPool& ) = delete;
+    SlabPool& operator=( const SlabPool& ) = delete;
+
+    ~SlabPool(){
+        clear();
+    }
+
+    /// \brief construct an object in the next free slot
+    /// \return its slot
+    template<typename... Args>
+    uint32_t allocate( Args&&... args ){
+        const uint32_t slot = next();
+        if( slot == live_.size() ){
+            if( 0 == (slot % slab_size) ){
+                slabs_.emplace_back( new Storage[slab_size] );
+            }
+            live_.push_back( 0 );
+        }else{
+            free_.pop_back();
+        }
+
+        new (address(slot)) T( std::forward<Args>(args)... );
+        live_[slot] = 1;
+        ++count_;
+        ++allocations_;
+        return slot;
+    }
+
+    /// \brief destroy the object in the given slot, and recycle the slot
+    void release( uint32_t slot ){
+        assert( live(slot) );
+        address(slot)->~T();
+        live_[slot] = 0;
+        free_.push_back( slot );
+        --count_;
+        ++releases_;
+    }
+
+    /// \brief destroy every object, and free every slab
+    void clear(){
+        for( uint32_t slot = 0; slot < live_.size(); ++slot ){
+            if( live_[slot] ){
+                address(slot)->~T();
+            }
+        }
+        slabs_.clear();
+        live_.clear();
+        free_.clear();
+        count_ = 0;
+    }
+
+    /// \return the slot that the next call to `allocate` will use
+    inline uint32_t next() const {
+        return free_.empty() ? static_cast<uint32_t>(live_.size()) : free_.back();
+    }
+
+    inline bool live( uint32_t slot ) const {
+        return (slot < live_.size()) && (0 != live_[slot]);
+    }
+
+    inline T& operator[]( uint32_t slot ){
+        return *address(slot);
+    }
+
+    inline const T& operator[]( uint32_t slot ) const {
+        return *address(slot);
+    }
+
+    const_iterator cbegin() const { return const_iterator( this, 0 ); }
+    const_iterator cend() const { return const_iterator( this, static_cast<uint32_t>(live_.size()) ); }
+
+    /// \return number of live objects
+    inline size_t size() const { return count_; }
+
+    AllocationStats stats() const {
+        AllocationStats stats;
+        stats.blocks = slabs_.size();
+        stats.reserved = slabs_.size() * slab_size * sizeof(T)
+                       + live_.capacity() * sizeof(uint8_t)
+                       + free_.capacity() * sizeof(uint32_t);
+        stats.used = count_ * sizeof(T);
+        stats.live = count_;
+        stats.allocations = allocations_;
+        stats.releases = releases_;
+        return stats;
+    }
+
+private:
+    struct Storage {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    inline T* address( uint32_t slot ){
+        return std::launder( reinterpret_cast<T*>( slabs_[slot / slab_size][slot % slab_size].bytes ) );
+    }
+
+    inline const T* address( uint32_t slot ) const {
+        return std::launder( reinterpret_cast<const T*>( slabs_[slot / slab_size][slot % slab_size].bytes ) );
+    }
+
+private:
+    std::vector<std::unique_ptr<Storage[]>> slabs_;
+
+    /// 1 => slot holds a live object
+    std::vector<uint8_t> live_;
+
+    /// released slots, reused LIFO; (most-recently freed => most likely still in cache)
+    std::vector<uint32_t> free_;
+
+    size_t count_ = 0;
+    size_t allocations_ = 0;
+    size_t releases_ = 0;
+
+};
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <utility>
+
+#include "spatial-grid.hpp"
+
+SpatialGrid::SpatialGrid( float _cell_size ){
+    reset( _cell_size );
+}
+
+// beyond this, a position is garbage rather than local; and its cell coordinates would overflow
+constexpr static float max_extent = 1e9f;
+
+void SpatialGrid::move( uint32_t key, float easting, float northing ){
+    // NaN fails both comparisons
+    if( !(std::fabs(easting) < max_extent) || !(std::fabs(northing) < max_extent) ){
+        erase( key );
+        return;
+    }
+
+    if( entries.size() <= key ){
+        entries.resize( key + 1 );
+    }
+
+    const int32_t column = column_of( easting );
+    const int32_t row = row_of( northing );
+    Entry& entry = entries[key];
+
+    // common case: still in the same cell
+    if( npos != entry.cell ){
+        Cell& current = cells[entry.cell];
+        if( (column == current.column) && (row == current.row) ){
+            current.eastings[entry.index] = easting;
+            current.northings[entry.index] = northing;
+            return;
+        }
+        erase( key );
+    }
+
+    const auto [cell, inserted] = cell_index.insert( cell_key(column, row), static_cast<uint32_t>(cells.size()) );
+    if( inserted ){
+        cells.push_back( {column, row, {}, {}, {}} );
+        min_column = std::min( min_column, column );
+        max_column = std::max( max_column, column );
+        min_row = std::min( min_row, row );
+        max_row = std::max( max_row, row );
+    }
+
+    Cell& target = cells[cell];
+    entry.cell = cell;
+    entry.index = static_cast<uint32_t>(target.keys.size());
+    target.keys.push_back( key );
+    target.eastings.push_back( easting );
+    target.northings.push_back( northing );
+    ++count;
+}
+
+void SpatialGrid::erase( uint32_t key ){
+    if( (entries.size() <= key) || (npos == entries[key].cell) ){
+        return;
+    }
+
+    Entry& entry = entries[key];
+    Cell& cell = cells[entry.cell];
+
+    // swap-remove; then fix the index of whichever key moved into the hole
+    const uint32_t last = static_cast<uint32_t>(cell.keys.size() - 1);
+    if( entry.index != last ){
+        cell.keys[entry.index] = cell.keys[last];
+        cell.eastings[entry.index] = cell.eastings[last];
+        cell.northings[entry.index] = cell.northings[last];
+        entries[cell.keys[entry.index]].index = entry.index;
+    }
+    cell.keys.pop_back();
+    cell.eastings.pop_back();
+    cell.northings.pop_back();
+
+    entry.cell = npos;
+    --count;
+}
+
+void SpatialGrid::reset( float _cell_size ){
+    cell_size_ = _cell_size;
+    inverse_cell_size = 1.f / _cell_size;
+    cell_index.clear();
+    cells.clear();
+    entries.clear();
+    count = 0;
+    min_column = min_row = std::numeric_limits<int32_t>::max();
+    max_column = max_row = std::numeric_limits<int32_t>::min();
+}
+
+size_t SpatialGrid::box( float min_easting, float min_northing, float max_easting, float max_northing, std::vector<uint32_t>& out ) const {
+    out.clear();
+    visit_cells( column_of(min_easting), row_of(min_northing), column_of(max_easting), row_of(max_northing),
+        [&]( const Cell& cell ){
+            for( size_t i = 0; i < cell.keys.size(); ++i ){
+                const float easting = cell.eastings[i];
+                const float northing = cell.northings[i];
+                if( (min_easting <= easting) && (easting <= max_easting) && (min_northing <= northing) && (northing <= max_northing) ){
+                    out.push_back( cell.keys[i] );
+                }
+            }
+        });
+    return out.size();
+}
+
+size_t SpatialGrid::radius( float easting, float northing, float radius, std::vector<uint32_t>& out ) const {
+    out.clear();
+    const float radius_squared = radius * radius;
+    visit_cells( column_of(easting - radius), row_of(northing - radius), column_of(easting + radius), row_of(northing + radius),
+        [&]( const Cell& cell ){
+            for( size_t i = 0; i < cell.keys.size(); ++i ){
+                const float de = cell.eastings[i] - easting;
+                const float dn = cell.northings[i] - northing;
+                if( (de*de + dn*dn) <= radius_squared ){
+                    out.push_back( cell.keys[i] );
+                }
+            }
+        });
+    return out.size();
+}
+
+size_t SpatialGrid::nearest( float easting, float northing, size_t want, std::vector<uint32_t>& out, float max_radius ) const {
+    out.clear();
+    if( (0 == want) || (0 == count) ){
+        return 0;
+    }
+
+    // max-heap of the best candidates so far: {distance-squared, key}
+    std::priority_queue<std::pair<float, uint32_t>> best;
+    const float max_radius_squared = max_radius * max_radius;
+
+    auto scan = [&]( const Cell& cell ){
+        for( size_t i = 0; i < cell.keys.size(); ++i ){
+            const float de = cell.eastings[i] - easting;
+            const float dn = cell.northings[i] - northing;
+            const float distance_squared = de*de + dn*dn;
+            if( max_radius_squared < distance_squared ){
+                continue;
+            }
+            if( best.size() < want ){
+                best.emplace( distance_squared, cell.keys[i] );
+            }else if( distance_squared < best.top().first ){
+                best.pop();
+                best.emplace( distance_squared, cell.keys[i] );
+            }
+        }
+    };
+
+    // search outward, one square ring of cells at a time
+    const int32_t center_column = column_of( easting );
+    const int32_t center_row = row_of( northing );
+    const int32_t max_ring = std::max( { center_column - min_column, max_column - center_column,
+                                         center_row - min_row, max_row - center_row } );
+    for( int32_t ring = 0; ring <= max_ring; ++ring ){
+        if( 0 == ring ){
+            const uint32_t found = find_cell( center_column, center_row );
+            if( npos != found ){
+                scan( cells[found] );
+            }
+        }else{
+            // top & bottom rows of the ring, then the left & right columns, less the corners
+            const int32_t left = center_column - ring;
+            const int32_t right = center_column + ring;
+            const int32_t bottom = center_row - ring;
+            const int32_t top = center_row + ring;
+            visit_cells( left, top, right, top, scan );
+            visit_cells( left, bottom, right, bottom, scan );
+            visit_cells( left, bottom + 1, left, top - 1, scan );
+            visit_cells( right, bottom + 1, right, top - 1, scan );
+        }
+
+        // every point beyond this ring is at least `ring` cells away
+        const float reach = ring * cell_size_;
+        if( (max_radius < reach) || ((best.size() == want) && (best.top().first <= reach * reach)) ){
+            break;
+        }
+    }
+
+    out.resize( best.size() );
+    for( size_t i = best.size(); 0 < i; --i ){
+        out[i - 1] = best.top().second;
+        best.pop();
+    }
+    return out.size();
+}
+
+float SpatialGrid::cell_size() const {
+    return cell_size_;
+}
+
+size_t SpatialGrid::size() const {
+    return count;
+}
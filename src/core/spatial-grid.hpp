@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "flat-index.hpp"
+
+/// \brief uniform-grid spatial index over local (easting, northing) positions, keyed by track slot
+///
+/// Space is divided into square cells; only occupied cells are allocated, and are found
+/// by hashing their coordinates.  Each cell holds its members' slots and positions in
+/// parallel arrays, so queries scan contiguous floats.
+///
+/// - moving a key within its cell: O(1)
+/// - moving a key between cells, inserting, or erasing: O(1) amortized (swap-remove + append)
+/// - queries: O(cells overlapped + members of those cells)
+///
+/// Choose the cell size near the typical query radius: much smaller, and queries visit many
+/// empty cells; much larger, and queries test many distant members.
+class SpatialGrid {
+public:
+    constexpr static uint32_t npos = UINT32_MAX;
+
+public:
+    /// \param cell_size edge length of each cell (meters)
+    explicit SpatialGrid( float cell_size = 1000.f );
+
+    /// \brief insert the key at the given position; or move it there, if already present
+    ///
+    /// A non-finite (or absurdly distant) position erases the key instead.
+    void move( uint32_t key, float easting, float northing );
+
+    /// \brief remove the key, if present
+    void erase( uint32_t key );
+
+    /// \brief remove every key; and set a new cell size
+    void reset( float cell_size );
+
+    /// \brief every key inside the box (inclusive)
+    /// \param out reusable buffer; cleared, then filled in no particular order
+    /// \return number of keys found
+    size_t box( float min_easting, float min_northing, float max_easting, float max_northing, std::vector<uint32_t>& out ) const;
+
+    /// \brief every key within `radius` of the center (inclusive)
+    /// \param out reusable buffer; cleared, then filled in no particular order
+    /// \return number of keys found
+    size_t radius( float easting, float northing, float radius, std::vector<uint32_t>& out ) const;
+
+    /// \brief the `count` keys nearest the center
+    /// \param out reusable buffer; cleared, then filled nearest-first
+    /// \param max_radius ignore keys further than this
+    /// \return number of keys found; fewer than `count` if the grid holds fewer in range
+    size_t nearest( float easting, float northing, size_t count, std::vector<uint32_t>& out,
+                    float max_radius = std::numeric_limits<float>::infinity() ) const;
+
+    float cell_size() const;
+
+    /// \return number of keys indexed
+    size_t size() const;
+
+private:
+    struct Cell {
+        int32_t column;
+        int32_t row;
+        std::vector<uint32_t> keys;
+        std::vector<float> eastings;
+        std::vector<float> northings;
+    };
+
+    struct Entry {
+        uint32_t cell = npos;
+        uint32_t index = 0;
+    };
+
+    inline int32_t column_of( float easting ) const { return static_cast<int32_t>( std::floor(easting * inverse_cell_size) ); }
+    inline int32_t row_of( float northing ) const { return static_cast<int32_t>( std::floor(northing * inverse_cell_size) ); }
+
+    /// \return nonzero hash key for a cell.  (FlatIndex reserves 0)
+    static inline uint64_t cell_key( int32_t column, int32_t row ){
+        return ((static_cast<uint64_t>(static_cast<uint32_t>(column)) << 32) | static_cast<uint32_t>(row)) ^ 0x8000'0000'8000'0000ULL;
+    }
+
+    /// \return the cell at the given coordinates; npos if unoccupied
+    inline uint32_t find_cell( int32_t column, int32_t row ) const {
+        return cell_index.find( cell_key(column, row) );
+    }
+
+    /// \brief visit every occupied cell overlapping the given range of cells
+    template<typename visitor_t>
+    void visit_cells( int32_t min_column, int32_t min_row, int32_t max_column, int32_t max_row, visitor_t&& visitor ) const {
+        const uint64_t span = static_cast<uint64_t>(max_column - min_column + 1) * static_cast<uint64_t>(max_row - min_row + 1);
+        if( cells.size() < span ){
+            // sparse: cheaper to test every occupied cell than to probe every cell in range
+            for( const Cell& cell : cells ){
+                if( (min_column <= cell.column) && (cell.column <= max_column) && (min_row <= cell.row) && (cell.row <= max_row) ){
+                    visitor( cell );
+                }
+            }
+            return;
+        }
+
+        for( int32_t column = min_column; column <= max_column; ++column ){
+            for( int32_t row = min_row; row <= max_row; ++row ){
+                const uint32_t found = find_cell( column, row );
+                if( npos != found ){
+                    visitor( cells[found] );
+                }
+            }
+        }
+    }
+
+private:
+    float cell_size_;
+    float inverse_cell_size;
+
+    /// maps cell_key => index in `cells`
+    FlatIndex cell_index;
+
+    /// occupied (or once-occupied) cells; never freed, so their arrays keep their capacity
+    std::vector<Cell> cells;
+
+    /// indexed by key
+    std::vector<Entry> entries;
+
+    size_t count;
+
+    /// bounds of every cell ever occupied; limits the nearest-neighbor search
+    int32_t min_column, min_row, max_column, max_row;
+
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/// \brief bounded, lock-free, single-producer / single-consumer ring
+///
+/// Each side owns one cursor, on its own cache line, next to a private copy of the other side's
+/// cursor: so a push or pop only reads the shared line once its copy says the ring is full (or
+/// empty).  Items are moved in and out; so a ring of vectors hands buffers between threads without
+/// copying their contents.
+///
+/// `push` from exactly one thread, and `pop` from exactly one (other) thread.
+template<typename T>
+class SpscRing {
+public:
+    /// \param capacity rounded up to a power of two
+    explicit SpscRing( size_t capacity )
+        : mask_( std::bit_ceil(std::max<size_t>(capacity, 2)) - 1 )
+        , slots_( new T[mask_ + 1] )
+        , tail_(0)
+        , head_cache_(0)
+        , head_(0)
+        , tail_cache_(0)
+    {}
+
+    SpscRing( const SpscRing& ) = delete;
+    SpscRing& operator=( const SpscRing& ) = delete;
+
+    /// \brief producer only
+    /// \return false if full; and the item is left as it was
+    bool push( T&& item ){
+        const size_t tail = tail_.load( std::memory_order_relaxed );
+        if( mask_ < (tail - head_cache_) ){
+            head_cache_ = head_.load( std::memory_order_acquire );
+            if( mask_ < (tail - head_cache_) ){
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(item);
+        tail_.store( tail + 1, std::memory_order_release );
+        return true;
+    }
+
+    /// \brief consumer only
+    /// \return false if empty
+    bool pop( T& item ){
+        const size_t head = head_.load( std::memory_order_relaxed );
+        if( head == tail_cache_ ){
+            tail_cache_ = tail_.load( std::memory_order_acquire );
+            if( head == tail_cache_ ){
+                return false;
+            }
+        }
+        item = std::move( slots_[head & mask_] );
+        head_.store( head + 1, std::memory_order_release );
+        return true;
+    }
+
+    /// \return number of items queued; approximate, while either side is active
+    size_t size() const {
+        const size_t head = head_.load( std::memory_order_relaxed );
+        const size_t tail = tail_.load( std::memory_order_relaxed );
+        return (head < tail) ? (tail - head) : 0;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // producer's line: its cursor, and its copy of the consumer's
+    alignas(64) std::atomic<size_t> tail_;
+    size_t head_cache_;
+
+    // consumer's line; the class's alignment pads it out, so nothing after the ring shares it either
+    alignas(64) std::atomic<size_t> head_;
+    size_t tail_cache_;
+
+};
@@ -0,0 +1,138 @@
+#include <algorithm>
+
+#include "timing-wheel.hpp"
+
+TimingWheel::TimingWheel( uint64_t _resolution )
+    : resolution(_resolution)
+    , tick(0)
+    , count(0)
+{
+    heads.fill( npos );
+}
+
+void TimingWheel::schedule( uint32_t key, uint64_t deadline ){
+    if( entries.size() <= key ){
+        entries.resize( key + 1 );
+    }
+
+    if( npos != entries[key].bucket ){
+        unlink( key );
+    }
+
+    entries[key].deadline = deadline;
+    // the current tick's bucket has already been collected
+    link( key, tick + 1 );
+}
+
+void TimingWheel::cancel( uint32_t key ){
+    if( scheduled(key) ){
+        unlink( key );
+    }
+}
+
+bool TimingWheel::scheduled( uint32_t key ) const {
+    return (key < entries.size()) && (npos != entries[key].bucket);
+}
+
+size_t TimingWheel::advance( uint64_t now, std::vector<uint32_t>& due ){
+    due.clear();
+
+    const uint64_t target = now / resolution;
+    if( target <= tick ){
+        return 0;
+    }
+
+    // nothing scheduled: just jump
+    if( 0 == count ){
+        tick = target;
+        return 0;
+    }
+
+    while( tick < target ){
+        ++tick;
+
+        // entering a new rotation of a level: re-file that level's current bucket, from the top down
+        for( int level = level_count - 1; 0 < level; --level ){
+            const uint64_t lower_mask = (uint64_t(1) << (level * level_bits)) - 1;
+            if( 0 != (tick & lower_mask) ){
+                continue;
+            }
+
+            const uint32_t bucket = level * bucket_count + ((tick >> (level * level_bits)) & (bucket_count - 1));
+            cascade.clear();
+            for( uint32_t key = heads[bucket]; npos != key; key = entries[key].next ){
+                cascade.push_back( key );
+            }
+            for( const uint32_t key : cascade ){
+                unlink( key );
+                // the current tick's bucket is collected below
+                link( key, tick );
+            }
+        }
+
+        // collect level 0's current bucket
+        const uint32_t bucket = tick & (bucket_count - 1);
+        while( npos != heads[bucket] ){
+            const uint32_t key = heads[bucket];
+            unlink( key );
+            due.push_back( key );
+        }
+
+        if( 0 == count ){
+            tick = target;
+        }
+    }
+
+    return due.size();
+}
+
+size_t TimingWheel::size() const {
+    return count;
+}
+
+void TimingWheel::link( uint32_t key, uint64_t earliest ){
+    Entry& entry = entries[key];
+
+    const uint64_t when = std::max( entry.deadline / resolution, earliest );
+    const uint64_t delta = when - tick;
+
+    uint32_t bucket = npos;
+    for( int level = 0; level < level_count; ++level ){
+        if( delta < (uint64_t(1) << ((level + 1) * level_bits)) ){
+            bucket = level * bucket_count + ((when >> (level * level_bits)) & (bucket_count - 1));
+            break;
+        }
+    }
+    if( npos == bucket ){
+        // beyond the wheel's range: park in the top level's furthest bucket; re-filed when it comes around
+        constexpr int top = level_count - 1;
+        bucket = top * bucket_count + (((tick >> (top * level_bits)) - 1) & (bucket_count - 1));
+    }
+
+    entry.bucket = bucket;
+    entry.prev = npos;
+    entry.next = heads[bucket];
+    if( npos != entry.next ){
+        entries[entry.next].prev = key;
+    }
+    heads[bucket] = key;
+    ++count;
+}
+
+void TimingWheel::unlink( uint32_t key ){
+    Entry& entry = entries[key];
+
+    if( npos != entry.prev ){
+        entries[entry.prev].next = entry.next;
+    }else{
+        heads[entry.bucket] = entry.next;
+    }
+    if( npos != entry.next ){
+        entries[entry.next].prev = entry.prev;
+    }
+
+    entry.bucket = npos;
+    entry.next = npos;
+    entry.prev = npos;
+    --count;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// \brief hierarchical timing wheel, scheduling 32-bit keys (i.e. track slots) by deadline
+///
+/// Four levels of 64 buckets each.  With the default 1-second tick, level 0 spans a
+/// minute, level 1 an hour, level 2 three days, and level 3 six months; later deadlines
+/// are parked in the last bucket and re-filed as time passes.
+///
+/// Scheduling and cancelling cost O(1).  `advance` costs O(1) per tick crossed, plus
+/// O(1) per entry that falls due or cascades down a level.  Each key may have at most
+/// one pending deadline.
+class TimingWheel {
+public:
+    constexpr static uint32_t npos = UINT32_MAX;
+
+    constexpr static int level_count = 4;
+    constexpr static int level_bits = 6;
+    constexpr static uint32_t bucket_count = 1 << level_bits;
+
+public:
+    /// \param resolution tick length (usec)
+    explicit TimingWheel( uint64_t resolution = 1'000'000 );
+
+    /// \brief schedule (or re-schedule) a key
+    /// \param deadline absolute time (usec); deadlines already past fall due on the next tick
+    void schedule( uint32_t key, uint64_t deadline );
+
+    /// \brief cancel a key's pending deadline, if any
+    void cancel( uint32_t key );
+
+    /// \return true if the key has a pending deadline
+    bool scheduled( uint32_t key ) const;
+
+    /// \brief advance the wheel's clock
+    /// \param due reusable buffer; cleared, then filled with every key whose deadline has passed
+    /// \return number of keys due
+    ///
+    /// Due keys are no longer scheduled.  Time never moves backwards: an earlier `now` is ignored.
+    size_t advance( uint64_t now, std::vector<uint32_t>& due );
+
+    /// \return number of keys scheduled
+    size_t size() const;
+
+private:
+    struct Entry {
+        uint64_t deadline = 0;
+        uint32_t next = npos;
+        uint32_t prev = npos;
+        /// level * bucket_count + bucket; npos => not scheduled
+        uint32_t bucket = npos;
+    };
+
+    /// \param earliest first tick the key may be filed under
+    void link( uint32_t key, uint64_t earliest );
+    void unlink( uint32_t key );
+
+private:
+    const uint64_t resolution;
+
+    /// current time, in ticks
+    uint64_t tick;
+
+    /// head of each bucket's list
+    std::array<uint32_t, level_count * bucket_count> heads;
+
+    /// indexed by key
+    std::vector<Entry> entries;
+
+    size_t count;
+
+    /// scratch, for cascading a bucket
+    std::vector<uint32_t> cascade;
+
+};
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
@@ -6,28 +8,33 @@
 
 #include <proj.h>
 
+#include "event-bus.hpp"
+#include "journal.hpp"
+#include "name-table.hpp"
 #include "track-cache.hpp"
 
+thread_local TrackCache::ProjectionBatch TrackCache::batch_;
 
 TrackCache::TrackCache()
     : anchor({NAN,NAN,NAN,NAN})
     , offset({NAN,NAN,NAN,NAN})
-    , context(nullptr)
-    , projection(nullptr)
+    , zone(0)
     , should_project(false)
-{
-    context = proj_context_create();
-}
+    , projection_mode(EXACT)
+    , projection_error(0.1)
+    , newest(FlatIndex::npos)
+    , oldest(FlatIndex::npos)
+    , version_(0)
+    , modified_(0)
+    , budget_(0)
+    , clock_(0)
+    , stale_count_(0)
+    , journal_(nullptr)
+    , events_(nullptr)
+{}
 
 TrackCache::~TrackCache(){
-    // libproj cleanup
-    proj_destroy(projection);
-    projection = nullptr;
-    proj_context_destroy(context);
-    context = nullptr;
-
-    assert( nullptr == projection );
-    assert( nullptr == context );
+    // libproj cleanup is handled by `projections`
 
     // for (auto it = index.begin(); it != index.end(); ++it) {
     //     uint64_t key = it->first;
@@ -40,15 +47,410 @@ TrackCache::~TrackCache(){
 }
 
 cache_iterator TrackCache::cbegin() const {
-    return index.cbegin();
+    return tracks.cbegin();
 }
 
 cache_iterator TrackCache::cend() const {
-    return index.cend();
+    return tracks.cend();
+}
+
+void TrackCache::ordered( std::vector<const Track*>& out ) const {
+    sort_by_id();
+
+    out.clear();
+    out.reserve( by_id.size() );
+    for( const IdSlot& each : by_id ){
+        out.push_back( &tracks[each.slot] );
+    }
+}
+
+void TrackCache::reserve( size_t count ){
+    index.reserve( count );
+}
+
+AllocationStats TrackCache::allocations() const {
+    return tracks.stats();
+}
+
+const Track* TrackCache::get( uint64_t id ) const {
+    const uint32_t slot = index.find(id);
+    return (FlatIndex::npos == slot) ? nullptr : &tracks[slot];
+}
+
+const Track* TrackCache::get( std::string_view name ) const {
+    return get_by_name( NameTable::global().find(name) );
+}
+
+const Track* TrackCache::get_by_name( uint32_t name ) const {
+    const uint32_t slot = names.find(name);
+    return (FlatIndex::npos == slot) ? nullptr : &tracks[slot];
+}
+
+size_t TrackCache::get( std::span<const uint64_t> ids, std::span<const Track*> out ) const {
+    assert( ids.size() <= out.size() );
+
+    // how far ahead to prefetch: enough to cover a cache miss, not so far as to evict
+    constexpr size_t lookahead = 8;
+    for( size_t i = 0; (i < lookahead) && (i < ids.size()); ++i ){
+        index.prefetch( ids[i] );
+    }
+
+    size_t found = 0;
+    for( size_t i = 0; i < ids.size(); ++i ){
+        if( (i + lookahead) < ids.size() ){
+            index.prefetch( ids[i + lookahead] );
+        }
+
+        out[i] = get( ids[i] );
+        found += (nullptr != out[i]);
+    }
+
+    return found;
+}
+
+uint64_t TrackCache::updated_since( uint64_t since, std::vector<const Track*>& out ) const {
+    out.clear();
+
+    // the recency list is ordered by version; so stop at the first stale track
+    for( uint32_t slot = newest; FlatIndex::npos != slot; slot = tracks[slot].older ){
+        const Track& track = tracks[slot];
+        if( track.version <= since ){
+            break;
+        }
+        out.push_back( &track );
+    }
+
+    return version_;
 }
 
-Track* const TrackCache::get(uint64_t id) const {
-    return nullptr;
+uint64_t TrackCache::changes_since( uint64_t since, std::vector<const Track*>& out, uint16_t fields ) const {
+    out.clear();
+
+    // groups not tracked by their own version fall back to the track's `modified`
+    constexpr uint16_t grouped = Report::GLOBAL | Report::LOCAL | Report::NAME | Report::STATUS;
+    const bool any = (0 != (fields & ~grouped));
+
+    // every change is also an update; so walk the updates, and filter
+    for( uint32_t slot = newest; FlatIndex::npos != slot; slot = tracks[slot].older ){
+        const Track& track = tracks[slot];
+        if( track.version <= since ){
+            break;
+        }
+        if( (any && (since < track.modified))
+                || ((fields & (Report::GLOBAL | Report::LOCAL)) && (since < track.position_modified))
+                || ((fields & Report::NAME) && (since < track.name_modified))
+                || ((fields & Report::STATUS) && (since < track.status_modified)) ){
+            out.push_back( &track );
+        }
+    }
+
+    return version_;
+}
+
+uint64_t TrackCache::version() const {
+    return version_;
+}
+
+uint64_t TrackCache::modified() const {
+    return modified_;
+}
+
+size_t TrackCache::within_box( float min_easting, float min_northing, float max_easting, float max_northing,
+                               std::vector<const Track*>& out ) const {
+    grid_.box( min_easting, min_northing, max_easting, max_northing, query_slots_ );
+    out.clear();
+    for( const uint32_t slot : query_slots_ ){
+        out.push_back( &tracks[slot] );
+    }
+    return out.size();
+}
+
+size_t TrackCache::within_radius( float easting, float northing, float radius, std::vector<const Track*>& out ) const {
+    grid_.radius( easting, northing, radius, query_slots_ );
+    out.clear();
+    for( const uint32_t slot : query_slots_ ){
+        out.push_back( &tracks[slot] );
+    }
+    return out.size();
+}
+
+size_t TrackCache::nearest( float easting, float northing, size_t count, std::vector<const Track*>& out ) const {
+    grid_.nearest( easting, northing, count, query_slots_ );
+    out.clear();
+    for( const uint32_t slot : query_slots_ ){
+        out.push_back( &tracks[slot] );
+    }
+    return out.size();
+}
+
+void TrackCache::set_grid( float cell_size ){
+    grid_.reset( cell_size );
+    for( auto iter = tracks.cbegin(); iter != tracks.cend(); ++iter ){
+        const Report& last = iter->last_report;
+        if( last.has(Report::LOCAL) ){
+            grid_.move( iter.slot(), last.easting, last.northing );
+        }
+    }
+}
+
+void TrackCache::set_history( uint32_t depth, uint64_t window ){
+    history_.configure( depth, window );
+    for( auto iter = tracks.cbegin(); iter != tracks.cend(); ++iter ){
+        tracks[iter.slot()].history = history_.acquire();
+    }
+}
+
+bool TrackCache::set_history( std::string_view spec ){
+    const char* end = spec.data() + spec.size();
+    uint32_t depth = 0;
+    const auto [next, error] = std::from_chars( spec.data(), end, depth );
+    if( (std::errc() != error) || ((next < end) && (',' != *next)) ){
+        return false;
+    }
+
+    double seconds = 0;
+    if( next < end ){
+        const auto [last, window_error] = std::from_chars( next + 1, end, seconds );
+        if( (std::errc() != window_error) || (last != end) || (seconds < 0) ){
+            return false;
+        }
+    }
+
+    set_history( depth, static_cast<uint64_t>(seconds * 1e6) );
+    return true;
+}
+
+HistoryView TrackCache::history( uint64_t id ) const {
+    const Track* track = get(id);
+    if( (nullptr == track) || (HistoryPool::npos == track->history) ){
+        return {};
+    }
+    return history_.view( track->history );
+}
+
+void TrackCache::set_expiry( Report::SOURCE_SENSOR source, uint64_t stale_after, uint64_t expire_after ){
+    if( expiry_.size() <= source ){
+        return;
+    }
+    expiry_[source] = { stale_after, expire_after };
+
+    // bring the wheel up to date, then re-file every track under the new ages
+    expire( clock_ );
+    for( auto iter = tracks.cbegin(); iter != tracks.cend(); ++iter ){
+        const uint64_t deadline = next_deadline( *iter );
+        if( 0 == deadline ){
+            wheel_.cancel( iter.slot() );
+        }else{
+            wheel_.schedule( iter.slot(), deadline );
+        }
+    }
+}
+
+void TrackCache::set_budget( size_t max_tracks ){
+    budget_ = max_tracks;
+    while( (0 < budget_) && (budget_ < tracks.size()) ){
+        remove( oldest, EVICTED );
+    }
+}
+
+void TrackCache::subscribe( removal_callback callback ){
+    subscribers_.push_back( std::move(callback) );
+}
+
+void TrackCache::set_journal( JournalWriter* journal ){
+    journal_ = journal;
+}
+
+void TrackCache::set_events( EventBus* events ){
+    events_ = events;
+}
+
+void TrackCache::notify( const Track& track, uint8_t type, uint16_t changed ){
+    if( (nullptr == events_) || (! events_->wants(type)) ){
+        return;
+    }
+    TrackEvent event;
+    event.report = track.last_report;
+    event.version = version_;
+    event.changed = changed;
+    event.type = static_cast<TrackEvent::TYPE>(type);
+    events_->publish( event );
+}
+
+size_t TrackCache::expire( uint64_t now ){
+    if( clock_ < now ){
+        clock_ = now;
+    }
+
+    size_t removed = 0;
+    wheel_.advance( clock_, due_ );
+    for( const uint32_t slot : due_ ){
+        if( ! tracks.live(slot) ){
+            continue;
+        }
+
+        // timers are not moved on update; so check whether this one is really due, and re-file it if not
+        Track& track = tracks[slot];
+        const uint64_t last = track.last_report.timestamp;
+        const uint64_t age = (last < clock_) ? (clock_ - last) : 0;
+        const ExpiryAges& ages = expiry_[track.last_report.source];
+
+        if( (0 < ages.expire) && (ages.expire <= age) ){
+            remove( slot, EXPIRED );
+            ++removed;
+            continue;
+        }
+
+        if( (0 < ages.stale) && (ages.stale <= age) && (! track.stale) ){
+            track.stale = true;
+            ++stale_count_;
+            // visible in the next snapshot; but not an update, so the track keeps its place in the recency list
+            modified_ = ++version_;
+            notify( track, TrackEvent::STALE, 0 );
+        }
+
+        const uint64_t deadline = next_deadline( track );
+        if( 0 < deadline ){
+            wheel_.schedule( slot, deadline );
+        }
+    }
+
+    return removed;
+}
+
+size_t TrackCache::stale_count() const {
+    return stale_count_;
+}
+
+void TrackCache::publish(){
+    const auto current = published_.load();
+    if( current && (current->version == version_) ){
+        return;
+    }
+
+    // reuse the retired snapshot's storage if no reader still holds it; else allocate.
+    // `use_count` is a relaxed load: the acquire fence orders our writes after the last reader's
+    // release (its count decrement), so refilling cannot race a read still in flight.  No reader can
+    // take a new reference: `retired_` is no longer published.
+    std::shared_ptr<TrackSnapshot> next;
+    if( retired_ && (1 == retired_.use_count()) ){
+        std::atomic_thread_fence( std::memory_order_acquire );
+        next = std::move(retired_);
+    }else{
+        next = std::make_shared<TrackSnapshot>();
+    }
+
+    fill( *next, false );
+
+    // only this thread ever stores; so the previous value is still `current`
+    published_.store( next );
+    retired_ = std::const_pointer_cast<TrackSnapshot>( current );
+}
+
+std::shared_ptr<const TrackSnapshot> TrackCache::snapshot() const {
+    return published_.load();
+}
+
+std::shared_ptr<const TrackSnapshot> TrackCache::capture( bool with_history ) const {
+    auto next = std::make_shared<TrackSnapshot>();
+    fill( *next, with_history );
+    return next;
+}
+
+void TrackCache::fill( TrackSnapshot& snapshot, bool with_history ) const {
+    sort_by_id();
+
+    snapshot.version = version_;
+    snapshot.modified = modified_;
+    snapshot.reports.clear();
+    snapshot.reports.reserve( by_id.size() );
+    snapshot.stale.clear();
+    snapshot.stale.reserve( by_id.size() );
+    snapshot.history.clear();
+    snapshot.history_end.clear();
+    for( const IdSlot& each : by_id ){
+        const Track& track = tracks[each.slot];
+        snapshot.reports.push_back( track.last_report );
+        snapshot.stale.push_back( track.stale );
+    }
+    snapshot.stale_count = stale_count_;
+
+    snapshot.origin_latitude = NAN;
+    snapshot.origin_longitude = NAN;
+    origin( snapshot.origin_latitude, snapshot.origin_longitude );
+
+    if( ! with_history ){
+        return;
+    }
+
+    snapshot.history_end.reserve( by_id.size() );
+    for( const IdSlot& each : by_id ){
+        const Track& track = tracks[each.slot];
+        if( HistoryPool::npos != track.history ){
+            const HistoryView view = history_.view( track.history );
+            for( size_t i = view.size(); 0 < i; --i ){
+                const HistorySample& sample = view[i - 1];
+                snapshot.history.push_back( {view.timestamp(i - 1), sample.easting, sample.northing, sample.speed, sample.course} );
+            }
+        }
+        snapshot.history_end.push_back( static_cast<uint32_t>(snapshot.history.size()) );
+    }
+}
+
+bool TrackCache::restore( const Report& report, bool stale, std::span<const TrackSnapshot::Sample> history ){
+    if( (0 == report.id) || (0 == report.timestamp) ){
+        return false;
+    }
+
+    Report latest = report;
+    if( should_project && latest.has(Report::GLOBAL) ){
+        project_to_local( latest );
+    }
+
+    expire( latest.timestamp );
+
+    // replay the history through the normal path; so the track's ring is filled in order
+    Report sample;
+    sample.id = latest.id;
+    sample.source = latest.source;
+    for( const TrackSnapshot::Sample& each : history ){
+        if( latest.timestamp <= each.timestamp ){
+            break;
+        }
+        sample.timestamp = each.timestamp;
+        sample.fields = 0;
+        sample.set_local( each.easting, each.northing );
+        if( ! std::isnan(each.speed) ){
+            sample.set_speed( each.speed );
+        }
+        if( ! std::isnan(each.course) ){
+            sample.set_course( each.course );
+        }
+        apply( sample );
+    }
+
+    const bool changed = apply( latest );
+
+    const uint32_t slot = index.find( latest.id );
+    if( stale && (FlatIndex::npos != slot) ){
+        // the track's timer still fires at its stale deadline; and finds the flag already set
+        Track& track = tracks[slot];
+        if( ! track.stale ){
+            track.stale = true;
+            ++stale_count_;
+            modified_ = ++version_;
+        }
+    }
+
+    return changed;
+}
+bool TrackCache::origin( double& latitude, double& longitude ) const {
+    if( ! should_project ){
+        return false;
+    }
+    latitude = anchor.lp.lam;
+    longitude = anchor.lp.phi;
+    return true;
 }
 
 void TrackCache::set_origin(double latitude, double longitude) {
@@ -56,23 +458,31 @@ void TrackCache::set_origin(double latitude, double longitude) {
     if(std::isnan(latitude) || std::isnan(longitude)){
         return;
     }
-    anchor = proj_coord( latitude, longitude, 0, 0 );
 
-    // https://mangomap.com/robertyoung/maps/69585/what-utm-zone-am-i-in-#
-    const int zone = (static_cast<int>((longitude + 180.)/6.) + 1) % 60;
+    // repeated calls (e.g. once per config line) must be cheap
+    if( should_project && (latitude == anchor.lp.lam) && (longitude == anchor.lp.phi) ){
+        return;
+    }
+
+    const int next_zone = ProjectionManager::zone_of( longitude );
     // fprintf(stdout, "    ::LL > UTM Origin (deg): %g, %g  ==>  zone: %d\n",
-    //                    anchor.latitude, anchor.longitude, zone);
+    //                    anchor.latitude, anchor.longitude, next_zone);
 
-    char projection_definition[36];
-    snprintf(projection_definition, 36, "+proj=utm +zone=%d +datum=WGS84", zone );
-    //fprintf(stdout, "    ::proj-def-wkt: %s\n", projection_definition ):
-    projection = proj_create_crs_to_crs( context, "EPSG:4326", projection_definition, nullptr );
+    PJ* const projection = projections.get( next_zone );
+    if( nullptr == projection ){
+        return;
+    }
+
+    zone = next_zone;
+    anchor = proj_coord( latitude, longitude, 0, 0 );
 
     // Transform Latitude/Longitude to UTM Easting/Northing
     offset = proj_trans( projection, PJ_FWD, anchor );
 
     // successfully generated projection information:
     should_project = true;
+
+    set_projection( projection_mode, projection_error );
     return;
 
     // {
@@ -106,34 +516,333 @@ void TrackCache::set_origin(double latitude, double longitude) {
     // }
 }
 
+void TrackCache::set_projection( PROJECTION_MODE mode, double max_error ){
+    projection_mode = mode;
+    projection_error = max_error;
+
+    local_projection = LocalProjection();
+    if( should_project && (FAST == projection_mode) ){
+        if( ! local_projection.calibrate( projections.get(zone), anchor.lp.lam, anchor.lp.phi, projection_error ) ){
+            fprintf( stderr, "!! could not calibrate fast projection; falling back to exact.\n" );
+        }
+    }
+}
+
+double TrackCache::fast_projection_radius() const {
+    return local_projection.radius();
+}
+
 size_t TrackCache::size() const {
-    return index.size();
+    return tracks.size();
 }
 
 bool TrackCache::update( Report& report){
+    if( 0 == report.id ){
+        return false;
+    }
+
+    // advance the clock first, so that new timers are filed relative to the current time
+    expire( report.timestamp );
+
+    // low-rate path: project just this one report
+    if( should_project && report.has(Report::GLOBAL) ){
+        project_to_local( report );
+    }
+
+    if( nullptr != journal_ ){
+        journal_->append( report );
+    }
+    return apply( report );
+}
+
+size_t TrackCache::update( std::span<Report> reports ){
+    // high-rate path: project the whole batch in one PROJ call, then apply each report
+    project( reports );
+    return apply( std::span<const Report>(reports) );
+}
+
+size_t TrackCache::apply( std::span<const Report> reports ){
+    uint64_t latest = 0;
+    for( const Report& report : reports ){
+        latest = std::max( latest, report.timestamp );
+    }
+    expire( latest );
+
+    size_t accepted = 0;
+    for( const Report& report : reports ){
+        if( 0 != report.id ){
+            if( nullptr != journal_ ){
+                journal_->append( report );
+            }
+            accepted += apply( report );
+        }
+    }
+    return accepted;
+}
+
+size_t TrackCache::project( std::span<Report> reports ){
+    if( ! should_project ){
+        return 0;
+    }
+
+    // .1. gather: only reports with a global position need projecting
+    ProjectionBatch& batch = batch_;
+    batch.slots.clear();
+    batch.x.clear();
+    batch.y.clear();
+    for( size_t i = 0; i < reports.size(); ++i ){
+        if( reports[i].has(Report::GLOBAL) ){
+            batch.slots.push_back( static_cast<uint32_t>(i) );
+            batch.x.push_back( reports[i].latitude );
+            batch.y.push_back( reports[i].longitude );
+        }
+    }
+
+    const size_t count = batch.slots.size();
+    if( 0 == count ){
+        return 0;
+    }
+
+    if( local_projection.valid() ){
+        // .2. transform, in-place; directly into the local frame
+        batch.outside.resize( count );
+        const size_t outside = local_projection.forward( batch.x.data(), batch.y.data(), batch.outside.data(), count );
+
+        // .3. scatter; fall back to PROJ for any report beyond the valid radius
+        for( size_t i = 0; i < count; ++i ){
+            Report& report = reports[batch.slots[i]];
+            if( (0 < outside) && batch.outside[i] ){
+                project_to_local( report );
+            }else{
+                report.set_local( batch.x[i], batch.y[i] );
+            }
+        }
+
+        return count;
+    }
+
+    // .2. transform, in-place
+    proj_trans_generic( projections.get(zone), PJ_FWD,
+                        batch.x.data(), sizeof(double), count,
+                        batch.y.data(), sizeof(double), count,
+                        nullptr, 0, 0,
+                        nullptr, 0, 0 );
+
+    // .3. scatter: UTM => local
+    for( size_t i = 0; i < count; ++i ){
+        reports[batch.slots[i]].set_local( batch.x[i] - offset.enu.e, batch.y[i] - offset.enu.n );
+    }
+
+    return count;
+}
+
+bool TrackCache::apply( const Report& report ){
+    // at the budget, a new track first evicts the least-recently-updated one
+    if( (0 < budget_) && (budget_ <= tracks.size()) && (FlatIndex::npos == index.find(report.id)) ){
+        remove( oldest, EVICTED );
+    }
 
     // create new Track, if missing
-    const auto [track_entry, _found] = index.try_emplace(report.id, report.id);
+    const auto [slot, inserted] = index.insert( report.id, tracks.next() );
+    if( inserted ){
+        tracks.allocate( report.id );
+        tracks[slot].history = history_.acquire();
 
-    if( should_project ){
-        report = project_to_local( report );
+        // sorted lazily, on read; so a flood of new ids costs O(1) each, here
+        by_id_pending.push_back( {report.id, slot} );
     }
 
-    // faster than, but equivalent to: `index[report->id].update(...)`
-    track_entry->second.update( report );
+    Track& track = tracks[slot];
+    const uint8_t previous_source = track.last_report.source;
+
+    // keep the name index current
+    if( report.has(Report::NAME) && (report.name != track.name) ){
+        if( (0 != track.name) && (slot == names.find(track.name)) ){
+            names.erase( track.name );
+        }
+        if( 0 != report.name ){
+            // a name belongs to whichever track claimed it most recently
+            names.erase( report.name );
+            names.insert( report.name, slot );
+        }
+    }
 
-    return true;
+    const uint16_t changed = track.update( report );
+
+    if( changed & Report::LOCAL ){
+        grid_.move( slot, track.last_report.easting, track.last_report.northing );
+    }
+    // history is a time series; so record every sample, even a repeated position
+    if( (HistoryPool::npos != track.history) && report.has(Report::LOCAL) ){
+        history_.append( track.history, report.timestamp, report );
+    }
+
+    const bool was_stale = track.stale;
+    if( track.stale ){
+        track.stale = false;
+        --stale_count_;
+    }
+
+    // timers are filed once, and re-checked when they fire; so only (re)file on creation, a change in ages,
+    // or a refresh of a stale track -- whose timer was dropped, or moved on to its expiry
+    if( inserted || was_stale || (previous_source != track.last_report.source) ){
+        const uint64_t deadline = next_deadline( track );
+        if( 0 < deadline ){
+            wheel_.schedule( slot, deadline );
+        }else{
+            wheel_.cancel( slot );
+        }
+    }
+
+    track.version = ++version_;
+    track.changed = changed;
+    if( inserted || (0 != changed) ){
+        track.modified = version_;
+        track.position_modified = (changed & (Report::GLOBAL | Report::LOCAL)) ? version_ : track.position_modified;
+        track.name_modified = (changed & Report::NAME) ? version_ : track.name_modified;
+        track.status_modified = (changed & Report::STATUS) ? version_ : track.status_modified;
+    }
+    if( inserted || (0 != changed) || was_stale ){
+        modified_ = version_;
+    }
+    touch( slot );
+
+    if( inserted || (0 != changed) || was_stale ){
+        notify( track, inserted ? TrackEvent::CREATED : TrackEvent::UPDATED, changed );
+    }
+
+    return inserted || (0 != changed);
+}
+
+uint64_t TrackCache::next_deadline( const Track& track ) const {
+    const uint64_t last = track.last_report.timestamp;
+    const ExpiryAges& ages = expiry_[track.last_report.source];
+    if( (0 < ages.stale) && (! track.stale) ){
+        return last + ages.stale;
+    }else if( 0 < ages.expire ){
+        return last + ages.expire;
+    }
+    return 0;
+}
+
+void TrackCache::remove( uint32_t slot, REMOVAL reason ){
+    Track& track = tracks[slot];
+
+    for( const removal_callback& callback : subscribers_ ){
+        callback( track, reason );
+    }
+    notify( track, (EVICTED == reason) ? TrackEvent::EVICTED : TrackEvent::EXPIRED, 0 );
+
+    index.erase( track.id );
+    if( (0 != track.name) && (slot == names.find(track.name)) ){
+        names.erase( track.name );
+    }
+
+    // `by_id` is sorted: mark the entry, and compact on the next read.  New tracks are still in `by_id_pending`.
+    const auto position = std::lower_bound( by_id.begin(), by_id.end(), track.id,
+                                [](const IdSlot& each, uint64_t id){ return each.id < id; });
+    if( (by_id.end() != position) && (track.id == position->id) && (slot == position->slot) ){
+        position->slot = FlatIndex::npos;
+        by_id_removed = true;
+    }else{
+        std::erase_if( by_id_pending, [slot](const IdSlot& each){ return slot == each.slot; } );
+    }
+
+    unlink( slot );
+
+    if( track.stale ){
+        --stale_count_;
+    }
+
+    wheel_.cancel( slot );
+    grid_.erase( slot );
+    history_.release( track.history );
+    tracks.release( slot );
+
+    // membership changed; so the next publish must not be skipped
+    modified_ = ++version_;
+}
+
+void TrackCache::sort_by_id() const {
+    if( by_id_removed ){
+        std::erase_if( by_id, [](const IdSlot& each){ return FlatIndex::npos == each.slot; } );
+        by_id_removed = false;
+    }
+
+    if( ! by_id_pending.empty() ){
+        const auto by_id_less = [](const IdSlot& a, const IdSlot& b){ return a.id < b.id; };
+        std::sort( by_id_pending.begin(), by_id_pending.end(), by_id_less );
+        const size_t middle = by_id.size();
+        by_id.insert( by_id.end(), by_id_pending.cbegin(), by_id_pending.cend() );
+        std::inplace_merge( by_id.begin(), by_id.begin() + middle, by_id.end(), by_id_less );
+        by_id_pending.clear();
+    }
+}
+
+void TrackCache::unlink( uint32_t slot ){
+    Track& track = tracks[slot];
+
+    if( FlatIndex::npos != track.newer ){
+        tracks[track.newer].older = track.older;
+    }
+    if( FlatIndex::npos != track.older ){
+        tracks[track.older].newer = track.newer;
+    }
+    if( newest == slot ){
+        newest = track.older;
+    }
+    if( oldest == slot ){
+        oldest = track.newer;
+    }
+
+    track.newer = FlatIndex::npos;
+    track.older = FlatIndex::npos;
+}
+
+void TrackCache::touch( uint32_t slot ){
+    if( newest == slot ){
+        return;
+    }
+
+    unlink( slot );
+
+    // link at front
+    Track& track = tracks[slot];
+    track.older = newest;
+    if( FlatIndex::npos != newest ){
+        tracks[newest].newer = slot;
+    }
+    newest = slot;
+    if( FlatIndex::npos == oldest ){
+        oldest = slot;
+    }
 }
 
 bool TrackCache::project_to_global( double easting, double northing, double& latitude, double& longitude ){
-    PJ_COORD source = proj_coord( easting, northing, 0, 0 );
-    PJ_COORD result =  proj_trans( projection, PJ_INV, source );
+    if( ! should_project ){
+        return false;
+    }
+
+    if( local_projection.valid() && local_projection.inverse( easting, northing, latitude, longitude ) ){
+        return true;
+    }
+
+    PJ_COORD source = proj_coord( easting + offset.enu.e, northing + offset.enu.n, 0, 0 );
+    PJ_COORD result =  proj_trans( projections.get(zone), PJ_INV, source );
     latitude = result.lp.lam;
     longitude = result.lp.phi;
     return true;
 }
 
 bool TrackCache::project_to_local( double latitude, double longitude, double& easting, double& northing ){
+    if( ! should_project ){
+        return false;
+    }
+
+    if( local_projection.valid() && local_projection.forward( latitude, longitude, easting, northing ) ){
+        return true;
+    }
+
     PJ_COORD source = proj_coord( latitude, longitude, 0, 0 );
     PJ_COORD result = project_to_local( source );
     easting = result.enu.e;
@@ -142,15 +851,20 @@ bool TrackCache::project_to_local( double latitude, double longitude, double& ea
 }
 
 Report& TrackCache::project_to_local( Report& report ){
+    double easting, northing;
+    if( local_projection.valid() && local_projection.forward( report.latitude, report.longitude, easting, northing ) ){
+        report.set_local( easting, northing );
+        return report;
+    }
+
     PJ_COORD source = proj_coord( report.latitude, report.longitude, 0, 0 );
     PJ_COORD result = project_to_local( source );
-    report.easting = result.enu.e;
-    report.northing = result.enu.n;
+    report.set_local( result.enu.e, result.enu.n );
     return report;
 }
 
 PJ_COORD TrackCache::project_to_local( const PJ_COORD& input_coordinates ){
-    PJ_COORD output_coordinates = proj_trans( projection, PJ_FWD, input_coordinates );
+    PJ_COORD output_coordinates = proj_trans( projections.get(zone), PJ_FWD, input_coordinates );
     output_coordinates.enu.e -= offset.enu.e;
     output_coordinates.enu.n -= offset.enu.n;
     return output_coordinates;
@@ -158,7 +872,7 @@ PJ_COORD TrackCache::project_to_local( const PJ_COORD& input_coordinates ){
 
 bool TrackCache::project_to_UTM( double latitude, double longitude, double& easting, double& northing ){
     PJ_COORD source = proj_coord( latitude, longitude, 0, 0 );
-    PJ_COORD result = proj_trans( projection, PJ_FWD, source );
+    PJ_COORD result = proj_trans( projections.get(zone), PJ_FWD, source );
     easting = result.enu.e;
     northing = result.enu.n;
     return true;
@@ -168,9 +882,12 @@ std::string TrackCache::to_string() const {
     std::ostringstream buf;
 
     // print with X -> left; Y -> Up
-    buf << "======== ======= ======= Cache has " << index.size() << " entries ======= ======= =======\n";
-    for( const auto& [_id, each_track] : index ){
-        buf << "         " << each_track.str() << '\n';
+    std::vector<const Track*> rows;
+    ordered( rows );
+
+    buf << "======== ======= ======= Cache has " << tracks.size() << " entries ======= ======= =======\n";
+    for( const Track* each_track : rows ){
+        buf << "         " << each_track->str() << '\n';
     }
     buf << std::endl;
 
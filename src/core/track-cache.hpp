@@ -1,47 +1,317 @@
 #pragma once
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
 
 #include <proj.h>
 
+#include "allocation-stats.hpp"
+#include "flat-index.hpp"
+#include "local-projection.hpp"
+#include "projection-service.hpp"
 #include "report.hpp"
+#include "slab-pool.hpp"
+#include "spatial-grid.hpp"
+#include "timing-wheel.hpp"
 #include "track.hpp"
+#include "track-history.hpp"
+#include "track-snapshot.hpp"
 
 
-typedef std::map<uint64_t, Track>::const_iterator cache_iterator;
+typedef SlabPool<Track>::const_iterator cache_iterator;
+
+class EventBus;
+class JournalWriter;
 
 class TrackCache
 {
+public:
+    /// \brief how global (lat/lon) positions are converted into the local frame
+    enum PROJECTION_MODE : uint8_t {
+        /// full PROJ transform for every report
+        EXACT = 0,
+        /// second-order fit around the origin; PROJ beyond its valid radius.  (see: LocalProjection)
+        FAST = 1
+    };
+
+    /// \brief why a track was removed
+    enum REMOVAL : uint8_t {
+        /// no update within the expire age of its source
+        EXPIRED = 0,
+        /// least-recently-updated track, removed to stay within the budget
+        EVICTED = 1
+    };
+
+    typedef std::function<void(const Track&, REMOVAL)> removal_callback;
+
 public:
     TrackCache();
+    TrackCache( const TrackCache& ) = delete;
+    TrackCache& operator=( const TrackCache& ) = delete;
     
     ~TrackCache();
     
+    /// \brief iterate over every track, in storage order
     cache_iterator cbegin() const;
     
     cache_iterator cend() const;
 
-    Track * const get(uint64_t id) const;
+    /// \brief list every track, sorted by id
+    /// \param out reusable buffer; cleared, then filled
+    void ordered( std::vector<const Track*>& out ) const;
+
+    /// \brief pre-size storage for `count` tracks
+    void reserve( size_t count );
+
+    /// \return allocation counters for track storage.  (see also: NameTable::allocations)
+    AllocationStats allocations() const;
+
+    // ====== Queries ======
+    // All queries return views into the cache: valid until the next call to `update`
+
+    /// \return the track with the given id; nullptr if missing
+    const Track* get( uint64_t id ) const;
+
+    /// \return the track with the given name; nullptr if missing
+    const Track* get( std::string_view name ) const;
+
+    /// \return the track with the given NameTable handle; nullptr if missing
+    const Track* get_by_name( uint32_t name ) const;
+
+    /// \brief batch lookup: `out[i]` <= `get(ids[i])`
+    /// \return number of tracks found
+    size_t get( std::span<const uint64_t> ids, std::span<const Track*> out ) const;
+
+    /// \brief list tracks updated after version `since`, most-recent-first
+    /// \param out reusable buffer; cleared, then filled
+    /// \return current version -- pass this back in, as `since`, on the next call
+    ///
+    /// Costs O(tracks-updated), not O(tracks-cached).
+    uint64_t updated_since( uint64_t since, std::vector<const Track*>& out ) const;
+
+    /// \brief list tracks changed after version `since` -- i.e. skipping redundant updates -- most-recent-first
+    /// \param out reusable buffer; cleared, then filled
+    /// \param fields only tracks where one of these Report::FIELD groups changed.  (position, name, status; or any)
+    /// \return current version -- pass this back in, as `since`, on the next call
+    ///
+    /// Costs O(tracks-updated), not O(tracks-cached).  Stale flags and removals are not changes
+    /// to a track; they show up in the next snapshot.  (see: `modified`)
+    uint64_t changes_since( uint64_t since, std::vector<const Track*>& out, uint16_t fields = UINT16_MAX ) const;
+
+    /// \brief global version; incremented by every accepted update
+    uint64_t version() const;
+
+    /// \brief version of the latest visible change: a changed track, a stale flag, or a removal
+    ///
+    /// Consumers that only care about content -- e.g. a renderer -- can skip work while this holds still.
+    uint64_t modified() const;
+
+    // ====== Spatial Queries ======
+    // Over local (easting, northing) positions; tracks without a local position are not indexed.
+    // Results are views, as above.
+
+    /// \brief every track inside the box; in no particular order
+    /// \param out reusable buffer; cleared, then filled
+    size_t within_box( float min_easting, float min_northing, float max_easting, float max_northing,
+                       std::vector<const Track*>& out ) const;
+
+    /// \brief every track within `radius` meters; in no particular order
+    /// \param out reusable buffer; cleared, then filled
+    size_t within_radius( float easting, float northing, float radius, std::vector<const Track*>& out ) const;
+
+    /// \brief the `count` tracks nearest the given position; nearest first
+    /// \param out reusable buffer; cleared, then filled
+    size_t nearest( float easting, float northing, size_t count, std::vector<const Track*>& out ) const;
+
+    /// \brief rebuild the spatial index with the given cell size (meters; default: 1000)
+    ///
+    /// Pick a size near the typical query radius.
+    void set_grid( float cell_size );
+
+    // ====== History ======
 
+    /// \brief keep a bounded history of local positions for every track
+    /// \param depth samples per track.  0 (default) => disabled
+    /// \param window maximum span of each history (usec).  0 => limited only by depth
+    ///
+    /// Costs a fixed (depth * 20) + 16 bytes per track.  Clears any existing history.
+    void set_history( uint32_t depth, uint64_t window = 0 );
+
+    /// \brief as above; from a command-line spec: 'DEPTH[,WINDOW]', with WINDOW in seconds.  e.g. '64,600'
+    /// \return false if the spec could not be parsed; and history is left unchanged
+    bool set_history( std::string_view spec );
+
+    /// \return the track's history, newest first; empty if missing or disabled
+    HistoryView history( uint64_t id ) const;
+
+    // ====== Expiry ======
+
+    /// \brief age limits for tracks whose latest report came from the given source
+    /// \param stale_after flag the track as stale after this long without an update (usec); 0 => never
+    /// \param expire_after remove the track after this long without an update (usec); 0 => never
+    ///
+    /// Ages are measured against report timestamps, not the wall clock; so replayed logs
+    /// expire the same as live traffic.
+    void set_expiry( Report::SOURCE_SENSOR source, uint64_t stale_after, uint64_t expire_after );
+
+    /// \brief hard limit on the number of tracks held
+    /// \param max_tracks 0 => unlimited
+    ///
+    /// At the limit, each new track evicts the least-recently-updated track.
+    /// Memory per track is fixed (see: `allocations`, `set_history`), so this also bounds memory.
+    void set_budget( size_t max_tracks );
+
+    /// \brief call `callback` for every track just before it is removed
+    void subscribe( removal_callback callback );
+
+    /// \brief publish every create, change, stale flag, and removal to the bus.  (see: TrackEvent)
+    /// \param events not owned; must outlive the cache, or be unset first.  nullptr (default) => none
+    ///
+    /// Events are built only for the types someone has subscribed to; so an idle bus costs one branch per update.
+    void set_events( EventBus* events );
+
+    /// \brief advance the cache's clock: flag stale tracks, and remove expired ones
+    /// \return number of tracks removed
+    ///
+    /// `update` calls this with the latest report time; call it directly to keep expiring
+    /// tracks while no reports arrive.  Costs O(1) per track flagged or removed.
+    size_t expire( uint64_t now );
+
+    /// \return number of tracks currently flagged stale
+    size_t stale_count() const;
+
+    // ====== Journal ======
+
+    /// \brief append every report passed to `update` to the journal, as applied: i.e. after projection
+    /// \param journal not owned; must outlive the cache, or be unset first.  nullptr (default) => none
+    ///
+    /// Reports re-created by `restore` are not journaled.
+    void set_journal( JournalWriter* journal );
+
+    // ====== Snapshots ======
+
+    /// \brief publish an immutable snapshot of the current cache contents
+    ///
+    /// Call from the ingest (updating) thread. A no-op if nothing changed since the last publish.
+    void publish();
+
+    /// \brief latest published snapshot
+    ///
+    /// Safe to call from any thread. Readers never block ingest: a reader that holds
+    /// a snapshot only delays when that snapshot's memory is reused.
+    std::shared_ptr<const TrackSnapshot> snapshot() const;
+
+    /// \brief a new, unpublished snapshot; optionally with every track's history -- e.g. for a checkpoint
+    ///
+    /// Call from the ingest (updating) thread.  Costs one copy of every report (and sample).
+    std::shared_ptr<const TrackSnapshot> capture( bool with_history ) const;
+
+    /// \brief warm start: re-create one track -- e.g. from a checkpoint
+    /// \param history past samples, oldest first; any at or after `report` are ignored
+    /// \return true if the track was created or changed
+    ///
+    /// Reports are re-projected, if an origin is set.  Samples are taken as-is: so only restore
+    /// history recorded against the same origin.  (see: `origin`)
+    bool restore( const Report& report, bool stale, std::span<const TrackSnapshot::Sample> history );
+
+    /// \brief set the origin of the local frame
+    ///
+    /// Repeating the current origin is a no-op.  Moving the origin reuses any projection
+    /// already built for the new origin's UTM zone.
+    ///
+    /// Every report is projected through the origin's zone -- even tracks across a zone
+    /// boundary -- so that the whole cache shares one consistent local frame.
     void set_origin( double latitude, double longitude );
 
+    /// \brief origin of the local frame
+    /// \return false if no origin is set
+    bool origin( double& latitude, double& longitude ) const;
+
+    /// \brief select the projection mode
+    /// \param max_error (FAST only) error bound, in meters, vs. the exact transform
+    ///
+    /// May be called before or after `set_origin`.
+    void set_projection( PROJECTION_MODE mode, double max_error = 0.1 );
+
+    /// \return radius around the origin in which FAST projection is used (meters); 0 if inactive
+    double fast_projection_radius() const;
+
+    /// \brief Transform local Easting/Northing to Latitude/Longitude
+    bool project_to_global( double easting_in, double northing_in, double& latitude_out, double& longitude_out );
+
+    /// \brief Transform Latitude/Longitude to local Easting/Northing
+    bool project_to_local( double latitude_in, double longitude_in, double& easting_out, double& northing_out );
+
     size_t size() const;
 
     std::string to_string() const;
 
+    /// \brief project (if configured), then merge one report into its track
+    /// \return true if the report created or changed its track; false if rejected or redundant
     bool update( Report& report );
 
+    /// \brief project a whole batch in one pass, then merge each report into its track
+    /// \return number of reports which created or changed their tracks
+    size_t update( std::span<Report> reports );
+
+    /// \brief batch projection stage: global => local coordinates, with one `proj_trans_generic` call
+    ///
+    /// Thread-safe w.r.t. other calls to `project`: each thread uses its own PROJ context, and
+    /// scratch buffers.  Not safe concurrently with `set_origin` or `set_projection`.
+    /// \return number of reports projected
+    size_t project( std::span<Report> reports );
+
+    /// \brief batch apply stage: merge each (already projected) report into its track
+    ///
+    /// `update` is `project`, then `apply`; split, so each stage can be timed.  (see: `ingest --bench`)
+    /// \return number of reports which created or changed their tracks
+    size_t apply( std::span<const Report> reports );
+
 
 private:
-    // Transform UTM Easting/Northing to Latitude/Longitude
-    bool project_to_global( double easting_in, double northing_in, double& latitude_out, double& longitude_out);
+    struct ExpiryAges {
+        uint64_t stale = 0;
+        uint64_t expire = 0;
+    };
+
+    struct IdSlot {
+        uint64_t id;
+        uint32_t slot;
+    };
+
+private:
+    /// \brief merge an already-projected report into its track
+    bool apply( const Report& report );
+
+    /// \return time of the track's next expiry event; 0 => none
+    uint64_t next_deadline( const Track& track ) const;
+
+    /// \brief notify subscribers, then remove the track from every index, and free its storage
+    void remove( uint32_t slot, REMOVAL reason );
+
+    /// \brief publish one event about the track, if anyone wants it
+    void notify( const Track& track, uint8_t type, uint16_t changed );
+
+    /// \brief bring `by_id` up to date with insertions and removals
+    void sort_by_id() const;
+
+    /// \brief copy every track into the snapshot, sorted by id
+    void fill( TrackSnapshot& snapshot, bool with_history ) const;
+
+    /// \brief remove a track from the recency list
+    void unlink( uint32_t slot );
 
-    // Transform Latitude/Longitude to UTM Easting/Northing
-    bool project_to_local( double latitude_in, double longitude_in, double& easting_out, double& northing_out );
     Report& project_to_local( Report& rpt );
     PJ_COORD project_to_local( const PJ_COORD& in_coords );
 
+    /// \brief move a track to the front of the recency list
+    void touch( uint32_t slot );
+
     // Transform Latitude/Longitude to UTM Easting/Northing
     bool project_to_UTM( double latitude_in, double longitude_in, double& easting_out, double& northing_out );
 
@@ -54,11 +324,92 @@ private:
     /// (units: easting, northing
     PJ_COORD offset;
     
-    PJ_CONTEXT* context;
-    PJ* projection;
+    /// per-thread PROJ contexts, and every projection built by this cache
+    ProjectionService projections;
+
+    /// UTM zone of the origin
+    int zone;
 
     bool should_project;
+
+    PROJECTION_MODE projection_mode;
+    double projection_error;
+    LocalProjection local_projection;
+
+    /// reusable scratch buffers for batch projection
+    struct ProjectionBatch {
+        std::vector<uint32_t> slots;
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<uint8_t> outside;
+    };
+
+    /// per-thread; so that `project` may run on several threads at once
+    static thread_local ProjectionBatch batch_;
     
-    std::map<uint64_t, Track> index;
+    /// maps track-id => slot in `tracks`
+    FlatIndex index;
+
+    /// maps NameTable-handle => slot in `tracks`
+    FlatIndex names;
+
+    /// pooled track storage; stable addresses, and released slots are reused
+    SlabPool<Track> tracks;
+
+    /// every track, sorted by id.  Maintained lazily, on read: see `sort_by_id`
+    mutable std::vector<IdSlot> by_id;
+
+    /// tracks created since `by_id` was last sorted
+    mutable std::vector<IdSlot> by_id_pending;
+
+    /// `by_id` has removed entries.  (slot == npos)
+    mutable bool by_id_removed = false;
+
+    /// recency list -- doubly-linked through `Track::newer` / `Track::older`
+    uint32_t newest;
+    uint32_t oldest;
+
+    uint64_t version_;
+
+    /// version of the latest visible change.  (see: `modified()`)
+    uint64_t modified_;
+
+    /// position-history rings, for every track
+    HistoryPool history_;
+
+    /// spatial index over local positions, keyed by slot
+    SpatialGrid grid_;
+
+    /// scratch for spatial queries
+    mutable std::vector<uint32_t> query_slots_;
+
+    /// indexed by Report::SOURCE_SENSOR
+    std::array<ExpiryAges, Report::VISUAL + 1> expiry_;
+
+    /// maximum number of tracks; 0 => unlimited
+    size_t budget_;
+
+    /// each track's next expiry event, keyed by slot
+    TimingWheel wheel_;
+    std::vector<uint32_t> due_;
+
+    /// latest report time seen (usec)
+    uint64_t clock_;
+
+    size_t stale_count_;
+
+    std::vector<removal_callback> subscribers_;
+
+    /// not owned; nullptr => none
+    JournalWriter* journal_;
+
+    /// not owned; nullptr => none
+    EventBus* events_;
+
+    /// RCU-style publication: readers take a reference; ingest swaps in a new snapshot
+    std::atomic<std::shared_ptr<const TrackSnapshot>> published_;
+
+    /// the previously-published snapshot; recycled once every reader has released it
+    std::shared_ptr<TrackSnapshot> retired_;
 
 };
@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "name-table.hpp"
+#include "track-exporter.hpp"
+
+constexpr static char export_magic[8] = {'T','R','A','C','K','E','X','P'};
+
+/// \brief write the buffer out once it holds this much
+constexpr static size_t flush_bytes = 64 * 1024;
+
+/// \brief indexed by Report::SOURCE_SENSOR
+constexpr static std::string_view source_names[] = {
+    "ais", "fusion", "infrared", "manual", "radar", "radio", "unknown", "visual"
+};
+
+constexpr static std::string_view csv_header =
+    "id,timestamp,source,stale,name,station,status,latitude,longitude,easting,northing,heading,course,speed\n";
+
+static inline std::string_view source_name( uint8_t source ){
+    return (source < std::size(source_names)) ? source_names[source] : source_names[Report::UNKNOWN];
+}
+
+// ====== Formatting ======
+
+/// \brief a quoted JSON string; escaping quotes, backslashes, and control characters
+static void append_json_string( fmt::memory_buffer& out, std::string_view text ){
+    out.push_back( '"' );
+    for( const char c : text ){
+        if( ('"' == c) || ('\\' == c) ){
+            out.push_back( '\\' );
+            out.push_back( c );
+        }else if( static_cast<unsigned char>(c) < 0x20 ){
+            fmt::format_to( std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c) );
+        }else{
+            out.push_back( c );
+        }
+    }
+    out.push_back( '"' );
+}
+
+/// \brief a JSON number; or null, since JSON has no NaN or infinity
+///
+/// Shortest round-trip form, for the value's own type: so a float is not widened to 17 digits.
+template<typename number_t>
+static inline void append_json_number( fmt::memory_buffer& out, number_t value ){
+    if( std::isfinite(value) ){
+        fmt::format_to( std::back_inserter(out), "{}", value );
+    }else{
+        out.append( std::string_view("null") );
+    }
+}
+
+/// \brief a CSV cell; quoted only if it must be
+static void append_csv_string( fmt::memory_buffer& out, std::string_view text ){
+    if( std::string_view::npos == text.find_first_of(",\"\r\n") ){
+        out.append( text );
+        return;
+    }
+    out.push_back( '"' );
+    for( const char c : text ){
+        if( '"' == c ){
+            out.push_back( '"' );
+        }
+        out.push_back( c );
+    }
+    out.push_back( '"' );
+}
+
+/// \brief a CSV cell; empty if not finite.  (as above)
+template<typename number_t>
+static inline void append_csv_number( fmt::memory_buffer& out, number_t value ){
+    if( std::isfinite(value) ){
+        fmt::format_to( std::back_inserter(out), "{}", value );
+    }
+}
+
+// ====== TrackExporter ======
+
+TrackExporter::TrackExporter( int descriptor, FORMAT format )
+    : descriptor_(descriptor)
+    , owned_(false)
+    , format_(format)
+    , good_(0 <= descriptor)
+    , started_(false)
+    , count_(0)
+{}
+
+TrackExporter::TrackExporter( const std::string& path, FORMAT format )
+    : descriptor_(-1)
+    , owned_(false)
+    , format_(format)
+    , good_(false)
+    , started_(false)
+    , count_(0)
+{
+    if( "-" == path ){
+        descriptor_ = STDOUT_FILENO;
+    }else{
+        descriptor_ = open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        owned_ = true;
+    }
+    good_ = (0 <= descriptor_);
+    if( ! good_ ){
+        fprintf( stderr, "!! could not open export file: %s\n", path.c_str() );
+    }
+}
+
+TrackExporter::~TrackExporter(){
+    flush();
+    if( owned_ && (0 <= descriptor_) ){
+        close( descriptor_ );
+    }
+}
+
+bool TrackExporter::parse_format( std::string_view name, FORMAT& format ){
+    if( "jsonl" == name ){
+        format = JSONL;
+    }else if( "csv" == name ){
+        format = CSV;
+    }else if( "binary" == name ){
+        format = BINARY;
+    }else{
+        return false;
+    }
+    return true;
+}
+
+bool TrackExporter::good() const {
+    return good_;
+}
+
+size_t TrackExporter::count() const {
+    return count_;
+}
+
+size_t TrackExporter::write( const TrackCache& cache ){
+    cache.ordered( rows_ );
+    for( const Track* track : rows_ ){
+        append( track->last_report, track->stale );
+    }
+    return rows_.size();
+}
+
+uint64_t TrackExporter::write_changes( const TrackCache& cache, uint64_t since ){
+    const uint64_t version = cache.changes_since( since, rows_ );
+    for( const Track* track : rows_ ){
+        append( track->last_report, track->stale );
+    }
+    return version;
+}
+
+size_t TrackExporter::write( const TrackSnapshot& snapshot ){
+    for( size_t i = 0; i < snapshot.reports.size(); ++i ){
+        append( snapshot.reports[i], 0 != snapshot.stale[i] );
+    }
+    return snapshot.reports.size();
+}
+
+void TrackExporter::write( const Track& track ){
+    append( track.last_report, track.stale );
+}
+
+bool TrackExporter::flush(){
+    const char* cursor = buffer_.data();
+    size_t remaining = buffer_.size();
+    while( good_ && (0 < remaining) ){
+        const ssize_t sent = ::write( descriptor_, cursor, remaining );
+        if( sent <= 0 ){
+            fprintf( stderr, "!! could not write export: %s\n", strerror(errno) );
+            good_ = false;
+            break;
+        }
+        cursor += sent;
+        remaining -= sent;
+    }
+    buffer_.clear();
+    return good_;
+}
+
+void TrackExporter::append( const Report& report, bool stale ){
+    if( ! started_ ){
+        started_ = true;
+        if( CSV == format_ ){
+            buffer_.append( csv_header );
+        }else if( BINARY == format_ ){
+            ExportHeader header;
+            std::memcpy( header.magic, export_magic, sizeof(header.magic) );
+            header.format = format_version;
+            header.record_size = sizeof(ExportRecord);
+            buffer_.append( reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header + 1) );
+        }
+    }
+
+    switch( format_ ){
+        case JSONL:  append_json( report, stale );  break;
+        case CSV:    append_csv( report, stale );  break;
+        case BINARY: append_binary( report, stale );  break;
+    }
+    ++count_;
+
+    if( flush_bytes <= buffer_.size() ){
+        flush();
+    }
+}
+
+void TrackExporter::append_json( const Report& report, bool stale ){
+    auto out = std::back_inserter( buffer_ );
+    fmt::format_to( out, "{{\"id\":{},\"timestamp\":{},\"source\":\"{}\",\"stale\":{}",
+                    report.id, report.timestamp, source_name(report.source), stale );
+    if( report.has(Report::NAME) ){
+        buffer_.append( std::string_view(",\"name\":") );
+        append_json_string( buffer_, NameTable::global().lookup(report.name) );
+    }
+    if( report.has(Report::STATION) ){
+        buffer_.append( std::string_view(",\"station\":") );
+        append_json_string( buffer_, NameTable::global().lookup(report.station) );
+    }
+    if( report.has(Report::STATUS) ){
+        fmt::format_to( out, ",\"status\":{}", report.status );
+    }
+    if( report.has(Report::GLOBAL) ){
+        buffer_.append( std::string_view(",\"latitude\":") );
+        append_json_number( buffer_, report.latitude );
+        buffer_.append( std::string_view(",\"longitude\":") );
+        append_json_number( buffer_, report.longitude );
+    }
+    if( report.has(Report::LOCAL) ){
+        buffer_.append( std::string_view(",\"easting\":") );
+        append_json_number( buffer_, report.easting );
+        buffer_.append( std::string_view(",\"northing\":") );
+        append_json_number( buffer_, report.northing );
+    }
+    if( report.has(Report::HEADING) ){
+        buffer_.append( std::string_view(",\"heading\":") );
+        append_json_number( buffer_, report.heading );
+    }
+    if( report.has(Report::COURSE) ){
+        buffer_.append( std::string_view(",\"course\":") );
+        append_json_number( buffer_, report.course );
+    }
+    if( report.has(Report::SPEED) ){
+        buffer_.append( std::string_view(",\"speed\":") );
+        append_json_number( buffer_, report.speed );
+    }
+    buffer_.append( std::string_view("}\n") );
+}
+
+void TrackExporter::append_csv( const Report& report, bool stale ){
+    fmt::format_to( std::back_inserter(buffer_), "{},{},{},{},", report.id, report.timestamp, source_name(report.source), stale ? 1 : 0 );
+    if( report.has(Report::NAME) ){
+        append_csv_string( buffer_, NameTable::global().lookup(report.name) );
+    }
+    buffer_.push_back( ',' );
+    if( report.has(Report::STATION) ){
+        append_csv_string( buffer_, NameTable::global().lookup(report.station) );
+    }
+    buffer_.push_back( ',' );
+    if( report.has(Report::STATUS) ){
+        fmt::format_to( std::back_inserter(buffer_), "{}", report.status );
+    }
+    buffer_.push_back( ',' );
+    const bool global = report.has(Report::GLOBAL);
+    const bool local = report.has(Report::LOCAL);
+    append_csv_number( buffer_, global ? report.latitude : NAN );
+    buffer_.push_back( ',' );
+    append_csv_number( buffer_, global ? report.longitude : NAN );
+    buffer_.push_back( ',' );
+    append_csv_number( buffer_, local ? report.easting : NAN );
+    buffer_.push_back( ',' );
+    append_csv_number( buffer_, local ? report.northing : NAN );
+    buffer_.push_back( ',' );
+    append_csv_number( buffer_, report.has(Report::HEADING) ? report.heading : NAN );
+    buffer_.push_back( ',' );
+    append_csv_number( buffer_, report.has(Report::COURSE) ? report.course : NAN );
+    buffer_.push_back( ',' );
+    append_csv_number( buffer_, report.has(Report::SPEED) ? report.speed : NAN );
+    buffer_.push_back( '\n' );
+}
+
+void TrackExporter::append_binary( const Report& report, bool stale ){
+    const std::string_view name = report.has(Report::NAME) ? NameTable::global().lookup(report.name) : std::string_view();
+    const std::string_view station = report.has(Report::STATION) ? NameTable::global().lookup(report.station) : std::string_view();
+
+    ExportRecord record{};
+    record.id = report.id;
+    record.timestamp = report.timestamp;
+    record.latitude = report.latitude;
+    record.longitude = report.longitude;
+    record.easting = report.easting;
+    record.northing = report.northing;
+    record.heading = report.heading;
+    record.course = report.course;
+    record.speed = report.speed;
+    record.fields = report.fields;
+    record.source = report.source;
+    record.status = report.status;
+    record.stale = stale ? 1 : 0;
+    record.name_length = static_cast<uint16_t>( std::min<size_t>(name.size(), UINT16_MAX) );
+    record.station_length = static_cast<uint16_t>( std::min<size_t>(station.size(), UINT16_MAX) );
+
+    buffer_.append( reinterpret_cast<const char*>(&record), reinterpret_cast<const char*>(&record + 1) );
+    buffer_.append( name.data(), name.data() + record.name_length );
+    buffer_.append( station.data(), station.data() + record.station_length );
+}
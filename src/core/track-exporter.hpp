@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "report.hpp"
+#include "track.hpp"
+#include "track-cache.hpp"
+#include "track-snapshot.hpp"
+
+// ====== Binary Layout ======
+//
+// Native byte order; one stream per exporter:
+//
+//     ExportHeader
+//     { ExportRecord; char name[name_length]; char station[station_length]; } ...
+//
+// Unlike a checkpoint or journal, names are written inline: so a stream is self-contained,
+// and can be read by a process without access to this one's NameTable.
+
+/// \brief first bytes of a binary export
+struct ExportHeader {
+    char magic[8];
+    /// \brief layout version; see: `TrackExporter::format_version`
+    uint32_t format;
+    uint32_t record_size;
+};
+static_assert( 16 == sizeof(ExportHeader) );
+static_assert( std::is_trivially_copyable_v<ExportHeader> );
+
+/// \brief one track's merged report; followed by its name and station text
+struct ExportRecord {
+    uint64_t id;
+    uint64_t timestamp;
+    double latitude;
+    double longitude;
+    float easting;
+    float northing;
+    float heading;
+    float course;
+    float speed;
+    uint16_t fields;
+    uint8_t source;
+    uint8_t status;
+    uint8_t stale;
+    uint8_t reserved;
+    uint16_t name_length;
+    uint16_t station_length;
+    uint16_t padding;
+};
+static_assert( 64 == sizeof(ExportRecord) );
+static_assert( std::is_trivially_copyable_v<ExportRecord> );
+
+
+/// \brief streams tracks to a file descriptor: as JSON Lines, CSV, or compact binary
+///
+/// Each track is formatted straight into a reusable buffer, which is written out whenever it
+/// fills; so memory use is constant, however many tracks are exported.  Only the fields present
+/// in a track's report are written: JSON omits the rest, CSV leaves their cells empty.
+///
+/// Not thread-safe.  Export a cache from the thread that updates it; or a snapshot from any thread.
+class TrackExporter {
+public:
+    enum FORMAT : uint8_t {
+        /// one JSON object per line
+        JSONL = 0,
+        /// with a header row
+        CSV = 1,
+        /// see: ExportHeader, ExportRecord
+        BINARY = 2
+    };
+
+    constexpr static uint32_t format_version = 1;
+
+public:
+    /// \param descriptor not owned; e.g. STDOUT_FILENO
+    TrackExporter( int descriptor, FORMAT format );
+
+    /// \brief create, or truncate, the file at `path`; "-" => stdout
+    TrackExporter( const std::string& path, FORMAT format );
+
+    TrackExporter( const TrackExporter& ) = delete;
+    TrackExporter& operator=( const TrackExporter& ) = delete;
+
+    /// \brief flushes; then closes the file, if opened by this exporter
+    ~TrackExporter();
+
+    /// \brief parse a format name: "jsonl", "csv", or "binary"
+    /// \return false if unrecognized
+    static bool parse_format( std::string_view name, FORMAT& format );
+
+    /// \return false if the file could not be opened, or a write failed
+    bool good() const;
+
+    /// \brief every track, sorted by id
+    /// \return number of tracks written
+    size_t write( const TrackCache& cache );
+
+    /// \brief only the tracks changed after version `since`; most-recent-first
+    /// \return current version -- pass this back in, as `since`, on the next call.  (see: `TrackCache::changes_since`)
+    uint64_t write_changes( const TrackCache& cache, uint64_t since );
+
+    /// \brief every track in the snapshot, sorted by id
+    /// \return number of tracks written
+    size_t write( const TrackSnapshot& snapshot );
+
+    void write( const Track& track );
+
+    /// \brief write out everything buffered so far
+    bool flush();
+
+    /// \return number of tracks written
+    size_t count() const;
+
+private:
+    /// \brief format one track into the buffer; flushing first, if it is full
+    void append( const Report& report, bool stale );
+
+    void append_json( const Report& report, bool stale );
+
+    void append_csv( const Report& report, bool stale );
+
+    void append_binary( const Report& report, bool stale );
+
+private:
+    int descriptor_;
+    bool owned_;
+    FORMAT format_;
+    bool good_;
+
+    /// the CSV header row, or binary header, has been written
+    bool started_;
+
+    size_t count_;
+
+    fmt::memory_buffer buffer_;
+
+    /// scratch; reused by every call
+    std::vector<const Track*> rows_;
+
+};
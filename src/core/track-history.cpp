@@ -0,0 +1,148 @@
+#include <cmath>
+
+#include "track-history.hpp"
+
+// ====== HistoryView ======
+
+HistoryView::HistoryView( const HistorySample* samples, uint32_t depth, uint32_t head, uint32_t count, uint64_t base )
+    : samples_(samples)
+    , depth_(depth)
+    , head_(head)
+    , count_(count)
+    , base_(base)
+{}
+
+bool HistoryView::position_at( uint64_t at, float& easting, float& northing ) const {
+    if( empty() || (at < timestamp(count_ - 1)) || (timestamp(0) < at) ){
+        return false;
+    }
+
+    // walk back from the newest sample, to the first at-or-before the requested time
+    for( size_t i = 0; i < count_; ++i ){
+        const uint64_t before = timestamp(i);
+        if( before <= at ){
+            const HistorySample& earlier = (*this)[i];
+            if( (0 == i) || (before == at) ){
+                easting = earlier.easting;
+                northing = earlier.northing;
+                return true;
+            }
+
+            const HistorySample& later = (*this)[i - 1];
+            const float fraction = static_cast<float>(at - before) / static_cast<float>(timestamp(i - 1) - before);
+            easting = earlier.easting + fraction * (later.easting - earlier.easting);
+            northing = earlier.northing + fraction * (later.northing - earlier.northing);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ====== HistoryPool ======
+
+void HistoryPool::configure( uint32_t depth, uint64_t window ){
+    depth_ = depth;
+    window_ = window;
+
+    slabs.clear();
+    rings.clear();
+    free_rings.clear();
+}
+
+uint32_t HistoryPool::acquire(){
+    if( 0 == depth_ ){
+        return npos;
+    }
+
+    uint32_t ring;
+    if( ! free_rings.empty() ){
+        ring = free_rings.back();
+        free_rings.pop_back();
+    }else{
+        ring = static_cast<uint32_t>(rings.size());
+        if( 0 == (ring % rings_per_slab) ){
+            slabs.emplace_back( std::make_unique<HistorySample[]>(static_cast<size_t>(rings_per_slab) * depth_) );
+        }
+        rings.emplace_back();
+    }
+
+    rings[ring] = {0, 0, 0};
+    return ring;
+}
+
+void HistoryPool::release( uint32_t ring ){
+    if( ring < rings.size() ){
+        free_rings.push_back( ring );
+    }
+}
+
+void HistoryPool::append( uint32_t ring, uint64_t timestamp, const Report& report ){
+    if( rings.size() <= ring ){
+        return;
+    }
+
+    Ring& header = rings[ring];
+    HistorySample* samples = samples_of( ring );
+
+    if( 0 == header.count ){
+        header.base = timestamp;
+    }
+
+    // keep each ring in time order; and restart any ring whose span no longer fits in 32-bits of msec
+    const uint32_t newest = (0 == header.count) ? 0 : samples[(header.head + depth_ - 1) % depth_].dt;
+    if( timestamp < header.base ){
+        return;
+    }
+    const uint64_t dt = (timestamp - header.base) / 1'000;
+    if( dt < newest ){
+        return;
+    }else if( UINT32_MAX < dt ){
+        header = {timestamp, 0, 0};
+        return append( ring, timestamp, report );
+    }
+
+    samples[header.head] = { static_cast<uint32_t>(dt),
+                             report.easting,
+                             report.northing,
+                             report.has(Report::SPEED) ? report.speed : NAN,
+                             report.has(Report::COURSE) ? report.course : NAN };
+    header.head = (header.head + 1) % depth_;
+    if( header.count < depth_ ){
+        ++header.count;
+    }
+
+    // trim samples that have aged out of the window
+    if( 0 < window_ ){
+        const uint64_t window_ms = window_ / 1'000;
+        while( 1 < header.count ){
+            const uint32_t oldest = samples[(header.head + depth_ - header.count) % depth_].dt;
+            if( (dt - oldest) <= window_ms ){
+                break;
+            }
+            --header.count;
+        }
+    }
+}
+
+HistoryView HistoryPool::view( uint32_t ring ) const {
+    if( rings.size() <= ring ){
+        return {};
+    }
+    const Ring& header = rings[ring];
+    return { samples_of(ring), depth_, header.head, header.count, header.base };
+}
+
+size_t HistoryPool::bytes() const {
+    return slabs.size() * rings_per_slab * depth_ * sizeof(HistorySample)
+         + rings.capacity() * sizeof(Ring)
+         + free_rings.capacity() * sizeof(uint32_t);
+}
+
+uint32_t HistoryPool::depth() const {
+    return depth_;
+}
+
+uint64_t HistoryPool::window() const {
+    return window_;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "report.hpp"
+
+
+/// \brief one past position of a track.  20 bytes.
+struct HistorySample {
+    /// \brief msec after the ring's base timestamp
+    uint32_t dt;
+
+    float easting;
+    float northing;
+
+    /// \brief meters-per-second; NaN if not reported
+    float speed;
+
+    /// \brief degrees CW from true north; NaN if not reported
+    float course;
+};
+static_assert( 20 == sizeof(HistorySample) );
+
+
+/// \brief read-only view of one track's history; newest sample first
+///
+/// Valid until the next update to the owning cache.
+class HistoryView {
+public:
+    HistoryView() = default;
+    HistoryView( const HistorySample* samples, uint32_t depth, uint32_t head, uint32_t count, uint64_t base );
+
+    inline bool empty() const { return 0 == count_; }
+    inline size_t size() const { return count_; }
+
+    /// \param index 0 => newest
+    inline const HistorySample& operator[]( size_t index ) const {
+        return samples_[ (head_ + depth_ - 1 - index) % depth_ ];
+    }
+
+    /// \return absolute time of the given sample (usec)
+    inline uint64_t timestamp( size_t index ) const {
+        return base_ + static_cast<uint64_t>((*this)[index].dt) * 1'000;
+    }
+
+    /// \brief position at the given time, linearly interpolated between samples
+    /// \return false if the time is outside the span of this history
+    bool position_at( uint64_t timestamp, float& easting, float& northing ) const;
+
+private:
+    const HistorySample* samples_ = nullptr;
+    uint32_t depth_ = 1;
+    uint32_t head_ = 0;
+    uint32_t count_ = 0;
+    uint64_t base_ = 0;
+};
+
+
+/// \brief fixed-capacity history rings, for every track, drawn from one pooled arena
+///
+/// Each ring holds up to `depth` samples, and optionally drops samples older than `window`.
+/// Rings are carved from slabs of `rings_per_slab`, so memory per track is fixed:
+/// (depth * 20) bytes of samples, plus a 16-byte header.  Released rings are recycled.
+///
+/// Appends never allocate; only acquiring a ring may, once per slab.
+class HistoryPool {
+public:
+    constexpr static uint32_t npos = UINT32_MAX;
+
+    /// number of rings allocated at a time
+    constexpr static uint32_t rings_per_slab = 256;
+
+public:
+    HistoryPool() = default;
+    HistoryPool( const HistoryPool& ) = delete;
+    HistoryPool& operator=( const HistoryPool& ) = delete;
+
+    /// \brief set the shape of every ring;  releases all existing rings and memory
+    /// \param depth samples per ring.  0 => history disabled
+    /// \param window maximum age of the oldest sample, relative to the newest (usec).  0 => unlimited
+    void configure( uint32_t depth, uint64_t window );
+
+    /// \return a new, empty ring; npos if history is disabled
+    uint32_t acquire();
+
+    /// \brief return a ring to the pool
+    void release( uint32_t ring );
+
+    /// \brief record one position in the given ring
+    ///
+    /// Samples older than the ring's newest sample are dropped.
+    void append( uint32_t ring, uint64_t timestamp, const Report& report );
+
+    HistoryView view( uint32_t ring ) const;
+
+    /// \return total bytes reserved by the pool
+    size_t bytes() const;
+
+    uint32_t depth() const;
+
+    uint64_t window() const;
+
+private:
+    struct Ring {
+        /// absolute time of `dt == 0` (usec)
+        uint64_t base;
+        /// index of the next write
+        uint32_t head;
+        uint32_t count;
+    };
+
+    inline HistorySample* samples_of( uint32_t ring ){
+        return slabs[ring / rings_per_slab].get() + static_cast<size_t>(ring % rings_per_slab) * depth_;
+    }
+    inline const HistorySample* samples_of( uint32_t ring ) const {
+        return slabs[ring / rings_per_slab].get() + static_cast<size_t>(ring % rings_per_slab) * depth_;
+    }
+
+private:
+    uint32_t depth_ = 0;
+    uint64_t window_ = 0;
+
+    std::vector<std::unique_ptr<HistorySample[]>> slabs;
+
+    /// indexed by ring
+    std::vector<Ring> rings;
+
+    /// released rings, ready for reuse
+    std::vector<uint32_t> free_rings;
+
+};
@@ -0,0 +1,16 @@
+#include <algorithm>
+
+#include "track-snapshot.hpp"
+
+const Report* TrackSnapshot::get( uint64_t id ) const {
+    const auto found = std::lower_bound( reports.cbegin(), reports.cend(), id,
+                            [](const Report& each, uint64_t key){ return each.id < key; });
+    if( (reports.cend() != found) && (id == found->id) ){
+        return &(*found);
+    }
+    return nullptr;
+}
+
+size_t TrackSnapshot::size() const {
+    return reports.size();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "report.hpp"
+
+/// \brief immutable, point-in-time copy of every track in a cache
+///
+/// Published by the ingest thread (see: `TrackCache::publish`), and read by
+/// any number of other threads -- i.e. the UI, and exporters -- without locks.
+class TrackSnapshot {
+public:
+    /// \brief one past position of a track; as HistorySample, but with an absolute time
+    struct Sample {
+        /// \brief usec
+        uint64_t timestamp;
+        float easting;
+        float northing;
+        float speed;
+        float course;
+    };
+
+public:
+    TrackSnapshot() = default;
+
+    /// \return the latest report of the given track; nullptr if missing
+    const Report* get( uint64_t id ) const;
+
+    size_t size() const;
+
+public:
+    /// \brief cache version this snapshot was taken at
+    uint64_t version = 0;
+
+    /// \brief cache version of the latest visible change; equal across snapshots => same content, bar timestamps
+    uint64_t modified = 0;
+
+    /// \brief one merged report per track, sorted by id
+    std::vector<Report> reports;
+
+    /// \brief parallel to `reports`: 1 => track is stale
+    std::vector<uint8_t> stale;
+
+    /// \brief number of stale tracks
+    size_t stale_count = 0;
+
+    /// \brief origin of the local frame of `reports`; NaN if none.  (see: `TrackCache::origin`)
+    double origin_latitude = NAN;
+    double origin_longitude = NAN;
+
+    /// \brief (optional; see: `TrackCache::capture`) every track's history, oldest first, concatenated in `reports` order
+    std::vector<Sample> history;
+
+    /// \brief parallel to `reports`: end of each track's samples within `history`.  Empty if history was not captured.
+    std::vector<uint32_t> history_end;
+
+};
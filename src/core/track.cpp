@@ -1,7 +1,9 @@
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
 
+#include "name-table.hpp"
 #include "report.hpp"
 #include "track.hpp"
 
@@ -16,17 +18,37 @@ Track::Track(const Track& other)
     : id(other.id)
 {}
 
-void Track::update( const Report& _report ){
+// NaN => unknown; so two NaNs are the same value
+static inline bool differs( double before, double after ){
+    return (before != after) && !(std::isnan(before) && std::isnan(after));
+}
+
+uint16_t Track::update( const Report& _report ){
+    const Report before = last_report;
     last_report = _report;
 
-    if( ! _report.name.empty() ){
+    if( _report.has(Report::NAME) ){
         name = _report.name;
     }
+
+    // a field changed if it is new, or its value differs
+    const Report& after = last_report;
+    uint16_t changed = after.fields & ~before.fields;
+    const uint16_t present = _report.fields & before.fields;
+    changed |= ((present & Report::NAME) && (before.name != after.name)) ? Report::NAME : 0;
+    changed |= ((present & Report::STATION) && (before.station != after.station)) ? Report::STATION : 0;
+    changed |= ((present & Report::STATUS) && (before.status != after.status)) ? Report::STATUS : 0;
+    changed |= ((present & Report::GLOBAL) && (differs(before.latitude, after.latitude) || differs(before.longitude, after.longitude))) ? Report::GLOBAL : 0;
+    changed |= ((present & Report::LOCAL) && (differs(before.easting, after.easting) || differs(before.northing, after.northing))) ? Report::LOCAL : 0;
+    changed |= ((present & Report::HEADING) && differs(before.heading, after.heading)) ? Report::HEADING : 0;
+    changed |= ((present & Report::COURSE) && differs(before.course, after.course)) ? Report::COURSE : 0;
+    changed |= ((present & Report::SPEED) && differs(before.speed, after.speed)) ? Report::SPEED : 0;
+    return changed;
 }
 
 std::string Track::str() const { 
    std::ostringstream buf;
-    buf << "[" << id << "][" << name << "]  =>  ";
+    buf << "[" << id << "][" << NameTable::global().lookup(name) << "]  =>  ";
     buf << "@ {" << last_report.latitude << " N Lat, " << last_report.longitude << " E Lon }";
     buf << "// {" << last_report.easting << " Eas, " << last_report.northing << " Nor }";
     return buf.str();
@@ -4,12 +4,12 @@
 #include <string>
 #include <cstdint>
 
+#include "report.hpp"
+
 using std::unique_ptr;
 using std::string;
 using std::uint32_t;
 
-class Report;
-
 class Track{
 public:
     Track() = delete;
@@ -19,11 +19,39 @@ public:
 
     std::string str() const;
 
-    void update( const Report& _report );
+    /// \brief merge the report into `last_report`
+    /// \return Report::FIELD bits whose values changed -- or were set for the first time
+    uint16_t update( const Report& _report );
     
     const uint64_t id;
-    std::string name;
+
+    /// \brief NameTable handle; 0 => not yet named
+    uint32_t name = 0;
     
     Report last_report;
+
+    /// \brief cache version at this track's latest update
+    uint64_t version = 0;
+
+    /// \brief cache version at this track's latest change -- i.e. an update which changed any field
+    uint64_t modified = 0;
+
+    /// \brief cache version at the latest change to each group of fields
+    uint64_t position_modified = 0;     ///< Report::GLOBAL | Report::LOCAL
+    uint64_t name_modified = 0;         ///< Report::NAME
+    uint64_t status_modified = 0;       ///< Report::STATUS
+
+    /// \brief Report::FIELD bits changed by the latest update; 0 => that update was redundant
+    uint16_t changed = 0;
+
+    /// \brief neighbors in the cache's recency list, as slots.  (UINT32_MAX => none)
+    uint32_t newer = UINT32_MAX;
+    uint32_t older = UINT32_MAX;
+
+    /// \brief ring in the cache's HistoryPool.  (UINT32_MAX => no history)
+    uint32_t history = UINT32_MAX;
+
+    /// \brief no update within the stale age of this track's source.  (see: TrackCache::set_expiry)
+    bool stale = false;
     
 };
@@ -1,6 +1,13 @@
 // Standard Library Includes
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Dependency Includes
@@ -10,13 +17,15 @@
 #include "spdlog/sinks/stdout_color_sinks.h"
 
 // Project Includes
+#include "bench/ingest-bench.hpp"
+#include "connectors/registry.hpp"
+#include "core/connector.hpp"
+#include "core/event-bus.hpp"
+#include "core/ingest-pipeline.hpp"
+#include "core/journal.hpp"
+#include "core/name-table.hpp"
 #include "core/track-cache.hpp"
-#include "readers/pcap/log-reader.hpp"
-// #include "readers/nmea0183/text-log-reader.hpp"
-#include "parsers/ais/parser.hpp"
-#include "parsers/moos/message-parser.hpp"
-#include "parsers/moos/packet-parser.hpp"
-#include "parsers/nmea0183/packet-parser.hpp"
+#include "core/track-exporter.hpp"
 
 const static std::string binary_name = "trackmon";
 const static std::string binary_version = "0.0.1";
@@ -48,12 +57,209 @@ void print_version_information() {
     std::cout << binary_name << "    Version: " << "0.0.1-beta" << std::endl;
 }
 
+/// \brief write every track to the export target, if any; else (verbose only) log them
+bool export_cache( const TrackCache& cache, const std::string& target ){
+    if( target.empty() ){
+        if( spdlog::should_log(spdlog::level::debug) ){
+            spdlog::debug(cache.to_string());
+        }
+        return true;
+    }
+
+    const size_t separator = target.find(':');
+    TrackExporter::FORMAT format;
+    if( (std::string::npos == separator) || (! TrackExporter::parse_format(target.substr(0, separator), format)) ){
+        spdlog::error("!! could not parse export target: '{}';  expected 'FORMAT:PATH'", target );
+        return false;
+    }
+
+    const std::string path = target.substr( separator + 1 );
+    const auto start = std::chrono::steady_clock::now();
+    TrackExporter exporter( path, format );
+    const size_t count = exporter.write( cache );
+    if( ! (exporter.flush() && exporter.good()) ){
+        spdlog::error("!! could not export tracks to: {}", path );
+        return false;
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start );
+    spdlog::info("    >> Exported {} tracks to: {}  ({:.1f} ms)", count, path, elapsed.count() );
+    return true;
+}
+
+/// \return true if the export target ('FORMAT:PATH') writes to stdout
+bool exports_to_stdout( const std::string& target ){
+    const size_t separator = target.find(':');
+    return (std::string::npos != separator) && ("-" == target.substr(separator + 1));
+}
+
+/// \brief apply the projection options to a cache
+/// \return false if either option cannot be parsed.  (logged)
+bool configure_projection( TrackCache& cache, const std::string& mode, double max_error, const std::string& origin ){
+    if( "fast" == mode ){
+        cache.set_projection( TrackCache::FAST, max_error );
+    }else if( "exact" != mode ){
+        spdlog::error("!! unrecognized projection mode: {}", mode );
+        return false;
+    }
+
+    if( ! origin.empty() ){
+        double latitude = NAN;
+        double longitude = NAN;
+        if( 2 != sscanf( origin.c_str(), "%lf,%lf", &latitude, &longitude ) ){
+            spdlog::error("!! could not parse origin: '{}';  expected 'LAT,LON'", origin );
+            return false;
+        }
+        cache.set_origin( latitude, longitude );
+    }
+    return true;
+}
+
+/// \brief write the benchmark's results to a file; or, for '-', stdout
+bool write_bench( const IngestBench& bench, const std::string& path ){
+    const std::string json = bench.to_json();
+    if( "-" == path ){
+        std::cout << json << std::flush;
+        return true;
+    }
+
+    FILE* file = fopen( path.c_str(), "w" );
+    if( nullptr == file ){
+        spdlog::error("!! could not write benchmark results to: {}", path );
+        return false;
+    }
+    const bool written = (json.size() == fwrite(json.data(), 1, json.size(), file));
+    return (0 == fclose(file)) && written;
+}
+
+/// \brief connectors to use, when none are given
+std::vector<std::string> default_sources(){
+    std::vector<std::string> specs;
+#ifdef ENABLE_AIS
+    // "ais:text:data/ais.nmea0183.2022-05-18.log"
+    specs.push_back( "ais:pcap:data/ais.tcpdump.2022-05-18.pcap;protocol=udp;port=4003" );
+#endif
+#ifdef ENABLE_MOOS
+    specs.push_back( "moos:pcap:data/m2_berta.moos.p9000.pcap;protocol=tcp;port=9000" );
+#endif
+    return specs;
+}
+
+void print_connector_summary( const std::vector<std::unique_ptr<Connector>>& connectors, double elapsed_ms ){
+    for( const auto& connector : connectors ){
+        const ConnectorStats stats = connector->stats();
+        const double rate = (0 < elapsed_ms) ? (stats.reports * 1e3 / elapsed_ms) : 0.0;
+        spdlog::info("    >> Connector {}: {} frames ({} KB) => {} reports ({:.0f}/s);  {} errors, {} rejected.",
+                        connector->name(), stats.frames, stats.bytes / 1024, stats.reports, rate, stats.errors, stats.rejected );
+    }
+}
+
+void print_pipeline_summary( const IngestPipeline& pipeline ){
+    for( size_t index = 0; index < IngestPipeline::stage_count; ++index ){
+        const auto stage = static_cast<IngestPipeline::STAGE>(index);
+        const StageStats stats = pipeline.stats( stage );
+        spdlog::info("    >> Stage {:5}: {:3.0f}% busy;  {} items in {} batches;  busy {:.1f} ms, starved {:.1f} ms, blocked {:.1f} ms",
+                        IngestPipeline::stage_name(stage), 100 * stats.utilization(), stats.items, stats.batches,
+                        stats.busy / 1e6, stats.starved / 1e6, stats.blocked / 1e6 );
+    }
+}
+
+void print_cache_summary( const TrackCache& cache ){
+    const AllocationStats track_allocations = cache.allocations();
+    const AllocationStats name_allocations = NameTable::global().allocations();
+    spdlog::info("    >> Tracks: {} live, in {} slabs ({} KB reserved);  {} allocated, {} released.",
+                    track_allocations.live, track_allocations.blocks, track_allocations.reserved / 1024,
+                    track_allocations.allocations, track_allocations.releases );
+    spdlog::info("    >> Names:  {} live, in {} chunks ({} KB reserved).",
+                    name_allocations.live, name_allocations.blocks, name_allocations.reserved / 1024 );
+
+    size_t samples = 0;
+    size_t tracks_with_history = 0;
+    for( auto iter = cache.cbegin(); iter != cache.cend(); ++iter ){
+        const size_t count = cache.history( iter->id ).size();
+        samples += count;
+        tracks_with_history += (0 < count);
+    }
+    if( 0 < samples ){
+        spdlog::info("    >> History: {} samples, over {} tracks.", samples, tracks_with_history );
+    }
+}
+
+/// \brief `--events`: a subscriber to the cache's event bus, on a thread of its own; counts track events by type
+class EventCounter {
+public:
+    explicit EventCounter( EventBus& bus )
+        : bus_(bus)
+        , subscription_( bus.subscribe(4096, Subscription::COALESCE) )
+        , done_(false)
+        , counts_{}
+    {
+        thread_ = std::thread( &EventCounter::run, this );
+    }
+
+    /// \brief deliver any held-back events, then stop.  On the publishing thread, once it is done publishing.
+    void finish(){
+        while( 0 < subscription_->stats().pending ){
+            bus_.flush();
+            std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+        }
+        done_.store( true, std::memory_order_release );
+        thread_.join();
+    }
+
+    void print_summary() const {
+        const SubscriptionStats stats = subscription_->stats();
+        spdlog::info("    >> Events: {} created, {} updated, {} stale, {} expired, {} evicted;  {} coalesced, {} dropped.",
+                        counts_[0], counts_[1], counts_[2], counts_[3], counts_[4], stats.coalesced, stats.dropped );
+    }
+
+private:
+    void run(){
+        std::vector<TrackEvent> events;
+        while( true ){
+            const bool done = done_.load( std::memory_order_acquire );
+            while( 0 < subscription_->drain(events, 256) ){
+                for( const TrackEvent& event : events ){
+                    ++counts_[ std::countr_zero(static_cast<uint8_t>(event.type)) ];
+                }
+            }
+            if( done ){
+                break;
+            }
+            // subscribers poll; see: Subscription
+            std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+        }
+    }
+
+private:
+    EventBus& bus_;
+    std::shared_ptr<Subscription> subscription_;
+    std::atomic<bool> done_;
+    // one per TrackEvent::TYPE bit; written by the subscriber's thread only
+    uint64_t counts_[5];
+    std::thread thread_;
+};
+
 int main(int argc, char *argv[]){
     // Create a cxxopts::Options instance.
     cxxopts::Options options("trackgest", "ingest some tracks, and debug the result");
     options.add_options()
         ("b,build", "Display Build Information")
-        ("l,limit", "limit processing to this many packets.  0 (default) processes all traffic.", cxxopts::value<int>()->default_value("0"))
+        ("l,limit", "limit processing to this many frames, per connector.  0 (default) processes all traffic.", cxxopts::value<uint64_t>()->default_value("0"))
+        ("o,origin", "local origin, as 'LAT,LON'.  If absent (default), global positions are not projected.", cxxopts::value<std::string>()->default_value(""))
+        ("p,projection", "projection mode: 'exact' (default) or 'fast'", cxxopts::value<std::string>()->default_value("exact"))
+        ("projection-error", "error bound for 'fast' projection, in meters", cxxopts::value<double>()->default_value("0.1"))
+        ("history", "keep each track's recent positions, as 'DEPTH[,WINDOW]': at most DEPTH samples, over at most WINDOW seconds.  0 (default) => none", cxxopts::value<std::string>()->default_value("0"))
+        ("journal", "append every update to a journal in this directory", cxxopts::value<std::string>()->default_value(""))
+        ("replay", "replay the journal in this directory, instead of the capture", cxxopts::value<std::string>()->default_value(""))
+        ("s,source", "read from this connector: 'PARSER:READER:TARGET[;KEY=VALUE]...';  repeatable.  e.g. 'ais:udp:4003'", cxxopts::value<std::vector<std::string>>())
+        ("sources", "read from every connector listed in this file; one per line", cxxopts::value<std::string>()->default_value(""))
+        ("inline", "read, parse, and apply on one thread; instead of the pipeline (default)")
+        ("pin", "pin the pipeline's read, parse, and apply threads to CPUs, as 'R,P,A';  -1 => unpinned", cxxopts::value<std::string>()->default_value(""))
+        ("bench", "benchmark: run the connectors through every ingest step, on one thread, and time each step;  print JSON results")
+        ("bench-loops", "benchmark: replay the connectors this many times", cxxopts::value<uint32_t>()->default_value("10"))
+        ("bench-output", "benchmark: write the JSON results to this file;  '-' => stdout", cxxopts::value<std::string>()->default_value("-"))
+        ("events", "count track events by type, through a subscriber to the cache's event bus;  logged when done")
+        ("export", "write every track, when done, as 'FORMAT:PATH';  FORMAT is one of: jsonl, csv, binary.  PATH '-' => stdout", cxxopts::value<std::string>()->default_value(""))
         ("h,help", "Print usage")
         ("v,verbose", "Verbose output")
         ("V,version", "Print Version");
@@ -87,10 +293,66 @@ int main(int argc, char *argv[]){
     // auto err_logger = spdlog::stderr_color_mt("stderr");
     //
 
+    // the results go to stdout; so the logs must not
+    const bool bench_mode = clargs["bench"].as<bool>();
+    const std::string bench_output = clargs["bench-output"].as<std::string>();
+    const std::string export_target = clargs["export"].as<std::string>();
+    if( (bench_mode && ("-" == bench_output)) || exports_to_stdout(export_target) ){
+        spdlog::set_default_logger( spdlog::stderr_color_mt("stderr") );
+    }
+
     // ===========================================================================================
     spdlog::info(">>> .A. Creating Track Database:");
     TrackCache cache;
 
+    const std::string projection_mode = clargs["projection"].as<std::string>();
+    const double projection_error = clargs["projection-error"].as<double>();
+    const std::string origin = clargs["origin"].as<std::string>();
+    if( ! configure_projection(cache, projection_mode, projection_error, origin) ){
+        exit(1);
+    }
+    double latitude = NAN;
+    double longitude = NAN;
+    if( cache.origin(latitude, longitude) ){
+        spdlog::info("    >> Local origin: {:9.6f}, {:9.6f}", latitude, longitude );
+        if( 0 < cache.fast_projection_radius() ){
+            spdlog::info("    >> Fast projection: valid within {:.0f}m, for error <= {}m",
+                            cache.fast_projection_radius(), clargs["projection-error"].as<double>() );
+        }
+    }
+
+    const std::string history = clargs["history"].as<std::string>();
+    if( ! cache.set_history(history) ){
+        spdlog::error("!! could not parse history: '{}';  expected 'DEPTH[,WINDOW]'", history );
+        exit(1);
+    }
+
+    const std::string replay_directory = clargs["replay"].as<std::string>();
+    if( ! replay_directory.empty() ){
+        spdlog::info(">>> .B. Replaying Journal: {}", replay_directory );
+        const auto start = std::chrono::steady_clock::now();
+        const JournalReader journal( replay_directory );
+        spdlog::info("    >> {} records, in {} segments", journal.size(), journal.segments().size() );
+
+        // records point into the mapped segments; so the only copy is into the batch
+        size_t update_count = 0;
+        std::vector<Report> batch;
+        batch.reserve( 256 );
+        journal.scan( 0, UINT64_MAX, [&]( const JournalRecord& record, const JournalSegment& segment ){
+            batch.push_back( segment.report(record) );
+            if( batch.capacity() == batch.size() ){
+                update_count += cache.update( batch );
+                batch.clear();
+            }
+        });
+        update_count += cache.update( batch );
+
+        const auto elapsed = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start );
+        spdlog::info("<<< .C. Finished Replay; Found {} updates that changed a track, in {:.1f} ms.", update_count, elapsed.count() );
+        print_cache_summary( cache );
+        return export_cache( cache, export_target ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     // DEBUG 
     // cache.set_origin( 29.712372, -91.880144 );  // Origin for AIS Data
 
@@ -99,112 +361,135 @@ int main(int argc, char *argv[]){
 
     // ===========================================================================================
     spdlog::info(">>> .B. Creating Connectors:");
+    std::vector<std::string> specs;
+    if( 0 < clargs.count("source") ){
+        specs = clargs["source"].as<std::vector<std::string>>();
+    }
+    const std::string sources_path = clargs["sources"].as<std::string>();
+    if( (! sources_path.empty()) && (! connectors::Registry::load(sources_path, specs)) ){
+        return EXIT_FAILURE;
+    }
+    if( specs.empty() ){
+        specs = default_sources();
+    }
 
-#ifdef ENABLE_AIS
-    // // const std::string ais_file = "data/ais.nmea0183.2022-05-18.log";
-    // // const std::string ais_file = "data/ais.nmea0183.2022-05-19.log";
-    // const std::string input_pcap_file = "data/ais.tcpdump.2022-05-18.pcap";
-#endif
-
-#ifdef ENABLE_MOOS
-    // const std::string input_pcap_file = "data/m2_berta.moos.pcap";
-    // const std::string input_pcap_file = "data/m2_berta.moos.gt140.pcap";
-    const std::string input_pcap_file = "data/m2_berta.moos.p9000.pcap";
-#endif
-
-    spdlog::info("    >> Creating File Connector to: {}", input_pcap_file);
-    readers::pcap::LogReader reader( input_pcap_file );
-    reader.set_filter_tcp();
-
-    // // all of these exist, but I'm not sure which I care about, yet... TBD
-    reader.set_filter_port(9000);
+    if( bench_mode ){
+        // each loop re-creates the connectors, and the cache
+        const uint32_t loops = clargs["bench-loops"].as<uint32_t>();
+        spdlog::info(">>> .C. Benchmarking: {} connectors, {} loops", specs.size(), loops );
+        IngestBench bench( specs, loops );
+        bench.set_limit( clargs["limit"].as<uint64_t>() );
+        bench.set_configure( [&]( TrackCache& loop_cache ){
+            configure_projection( loop_cache, projection_mode, projection_error, origin );
+            loop_cache.set_history( history );
+        });
+        if( specs.empty() || (! bench.run()) ){
+            spdlog::error( "!!! Could not create all connectors" );
+            return EXIT_FAILURE;
+        }
+        spdlog::info("<<< .D. Finished Benchmark.");
+        return write_bench( bench, bench_output ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    if( ! (reader.good()) ){
+    std::vector<std::unique_ptr<Connector>> connectors;
+    if( specs.empty() || (! connectors::Registry::global().create(specs, connectors)) ){
         spdlog::error( "!!! Could not create all connectors" );
         return EXIT_FAILURE;
     }
+    for( auto& connector : connectors ){
+        spdlog::info("    >> Created Connector: {}", connector->name() );
+        connector->set_limit( clargs["limit"].as<uint64_t>() );
+    }
 
     // ===========================================================================================
-    spdlog::info(">>> .C. Creating Parsers:");
-#ifdef ENABLE_AIS
-    spdlog::info("    >> Creating AIS Parser...");
-    parsers::NMEA0183::NMEA0183PacketParser nmea_parser;
-    parsers::AIS::AISParser ais_parser;
-#endif
+    spdlog::info(">>> .C. Ingest Updates:");
+
+    const std::string journal_directory = clargs["journal"].as<std::string>();
+    std::unique_ptr<JournalWriter> journal;
+    if( ! journal_directory.empty() ){
+        journal = std::make_unique<JournalWriter>( journal_directory );
+        if( ! journal->good() ){
+            spdlog::error("!! could not open journal: {}", journal_directory );
+            return EXIT_FAILURE;
+        }
+        cache.set_journal( journal.get() );
+        spdlog::info("    >> Journaling updates to: {}", journal_directory );
+    }
 
-#ifdef ENABLE_MOOS
-    spdlog::info( "    >> Creating MOOS Parser..." );
-    parsers::moos::PacketParser moos_packet_parser;
-    spdlog::info( "    >> Creating Node-Report Parser..." );
-    parsers::moos::MessageParser moos_report_parser;
-#endif
+    EventBus events;
+    std::unique_ptr<EventCounter> event_counter;
+    if( clargs["events"].as<bool>() ){
+        event_counter = std::make_unique<EventCounter>( events );
+        cache.set_events( &events );
+    }
 
-    // ===========================================================================================
-    spdlog::info(">>> .D. Ingest Updates:");
+    const auto start = std::chrono::steady_clock::now();
 
-    uint32_t iteration_number = 0;
-    const uint32_t iteration_limit = clargs["limit"].as<int>();
     uint32_t update_count = 0;
-    while( (0 == iteration_limit) || ( iteration_number <= iteration_limit ) ){
-        ++iteration_number;
-
-        // spdlog::trace("    @ {:4d}\n", iteration_number );
-
-        // .1. get next data chunk
-        const auto chunk = reader.next();
-        if( 0 == chunk.length ){
-            if( not reader.good() ){
-                spdlog::warn("    <<< @{:4d} -- EOF", iteration_number );
-                break;
-            } 
-            // spdlog::trace( "    <<< @{:4d} -- Skip\n", iteration_number );
-            continue;
+    if( clargs["inline"].as<bool>() ){
+        // one frame from each connector in turn, until all are exhausted
+        std::vector<Connector*> active;
+        for( auto& connector : connectors ){
+            active.push_back( connector.get() );
         }
-        // spdlog::debug( "    >>>> @{:4d}", iteration_number );
-
-        // .2. Load next packet into parser
-        moos_packet_parser.load( &chunk );
-        
-        // .3. Pull MOOS Messages out of packet; until empty
-        while( ! moos_packet_parser.empty() ){
-            const std::string line = moos_packet_parser.next();
-            if( line.empty() ){
-                // spdlog::trace("        <<<");
-                continue;
+        FrameBatch frames;
+        std::vector<Report> batch;
+        while( ! active.empty() ){
+            for( size_t index = 0; index < active.size(); ){
+                // .1. get next data chunk
+                frames.clear();
+                if( ! active[index]->read(frames) ){
+                    spdlog::debug("    <<< {} -- EOF", active[index]->name() );
+                    active.erase( active.begin() + index );
+                    continue;
+                }
+
+                // .2. Pull reports out of the frame;  then project + apply them as one batch
+                if( ! frames.empty() ){
+                    active[index]->parse( frames, batch );
+                    update_count += cache.update( batch );
+                    batch.clear();
+                }
+                ++index;
             }
+        }
+    }else{
+        // each step on its own thread:  read => parse => apply;  with a read and a parse thread per connector
+        IngestPipeline pipeline( [&]( std::vector<Report>& reports ){
+            update_count += cache.update( reports );
+        });
+        for( auto& connector : connectors ){
+            pipeline.add_source( *connector );
+        }
 
-            // .3. Pull reports out of parser until drained
-            Report* report = moos_report_parser.parse( line );
-            if( report ){
-                cache.update( *report );
-                ++update_count;
-            }
+        const std::string cpus = clargs["pin"].as<std::string>();
+        if( (! cpus.empty()) && (! pipeline.pin(cpus)) ){
+            spdlog::error("!! could not parse CPU list: '{}';  expected 'R,P,A'", cpus );
+            return EXIT_FAILURE;
         }
 
-        // // .2. Load next chunk into parser
-        // // TODO: make this more functional
-        // nmea_parser.load( &chunk );
-        //
-        // // .3. Pull NMEA-0183 lines out of chunk, until empty
-        // while( ! nmea_parser.empty() ){
-        //     const std::string line = nmea_parser.next();
-        //     if( line.empty() ){
-        //         continue;
-        //     }
-        //     // std::cerr << "        <<< line:    (" << line.size() << "): " << line << std::endl;
-        //
-        //     // .3. Pull reports out of parser until drained
-        //     Report* report = ais_parser.parse( line );
-        //     if( report ){
-        //         report -> timestamp = chunk.timestamp
-        //         cache.update( *report );
-        //         ++update_count;
-        //     }
-        // }
-    }
-    spdlog::info("<<< .E. Finished Ingesting; Found {} updates.", update_count );
-
-    spdlog::info(cache.to_string());
-
-    return EXIT_SUCCESS;
+        pipeline.start();
+        pipeline.join();
+        print_pipeline_summary( pipeline );
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start );
+    spdlog::info("<<< .D. Finished Ingesting; Found {} updates that changed a track, in {:.1f} ms.", update_count, elapsed.count() );
+    print_connector_summary( connectors, elapsed.count() );
+
+    if( event_counter ){
+        // the apply thread has finished; so this thread is the publisher now
+        event_counter->finish();
+        cache.set_events( nullptr );
+        event_counter->print_summary();
+    }
+
+    if( journal ){
+        cache.set_journal( nullptr );
+        // commits anything still pending
+        journal.reset();
+    }
+
+    print_cache_summary( cache );
+
+    return export_cache( cache, export_target ) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
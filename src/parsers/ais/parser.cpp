@@ -2,11 +2,14 @@
 #include <array>
 #include <filesystem>
 #include <iostream>
+#include <string_view>
 
 // 3rd party includes
 #include <ais.h>
 
 // 1st party includes
+#include "core/name-table.hpp"
+#include "parsers/nmea0183/tag-block.hpp"
 #include "parser.hpp"
 
 
@@ -27,14 +30,33 @@ void print_bytes( const char* prefix, const uint8_t* data ) {
 }
 
 Report* Parser::parse( uint64_t timestamp, const std::string& line ) {
-    if( '!' != line[0] ){
+    // .3.A. split off any tag block; the tag block's time + station take precedence
+    nmea0183::TagBlock tags;
+    if( ! nmea0183::parse_tag_block( line, tags ) ){
+        std::cerr << "!?!? malformed NMEA tag block -- parse error!\n"
+                  << "     << " << line << std::endl;
         return nullptr;
     }
 
-    export_.timestamp = timestamp;
+    if( tags.sentence.empty() || ('!' != tags.sentence[0]) ){
+        return nullptr;
+    }
+
+    export_.reset();
+    export_.source = Report::AIS;
+    export_.timestamp = (0 < tags.timestamp) ? tags.timestamp : timestamp;
+    if( ! tags.source.empty() ){
+        export_.set_station( NameTable::global().intern(tags.source) );
+    }
 
-    // // .3.B. Pass sentence to nmea parser
-    return parse_nmea_sentence( line );
+    // .3.B. Pass sentence to nmea parser
+    if( tags.sentence.size() == line.size() ){
+        return parse_nmea_sentence( line );
+    }
+
+    // libais only accepts whole std::strings; reuse a buffer rather than allocate per-line
+    sentence_.assign( tags.sentence );
+    return parse_nmea_sentence( sentence_ );
 }
 
 Report* Parser::parse_nmea_sentence( const std::string& sentence ){
@@ -76,9 +98,6 @@ Report* Parser::parse_nmea_sentence( const std::string& sentence ){
         return nullptr;
     }
     
-    export_.name.clear();
-    export_.source = Report::AIS;
-
     // get track from db
     // auto report => db.get_track(msg->mmsi);
     switch(msg->message_id){
@@ -97,12 +116,11 @@ Report* Parser::parse_nmea_sentence( const std::string& sentence ){
             export_.id = msg->mmsi;
             const auto* msg18 = reinterpret_cast<libais::Ais18*>(msg.get());
             // fprintf(stdout, "    >> processing: [%hu](# %u)\n", msg->message_id, msg->mmsi );
-            export_.speed = msg18->sog;
-            export_.status = 15;  // 'undefined' status, according to AIS: 
-            export_.longitude = msg18->position.lng_deg;
-            export_.latitude = msg18->position.lat_deg;
-            export_.course = msg18->cog;
-            export_.heading = msg18->true_heading;
+            export_.set_speed( msg18->sog );
+            // class B reports carry no status; i.e. 'undefined' status, according to AIS
+            export_.set_global( msg18->position.lat_deg, msg18->position.lng_deg );
+            export_.set_course( msg18->cog );
+            export_.set_heading( msg18->true_heading );
             break;}
         case 24:{  // 24 - 'H' - Class B Static Data report
             // Ignoring this message; we're not interested in this information.
@@ -113,12 +131,11 @@ Report* Parser::parse_nmea_sentence( const std::string& sentence ){
         case 27:{  // 27 - 'K' - Long-range position report - e.g. for satellite receivers
             export_.id = msg->mmsi;
             const auto* msg27 = reinterpret_cast<libais::Ais27*>(msg.get());
-            export_.status = msg27->nav_status;
-            export_.speed = msg27->sog;
-            export_.longitude = msg27->position.lng_deg;
-            export_.latitude = msg27->position.lat_deg;
-            export_.course = msg27->cog;
-            export_.heading = NAN;
+            export_.set_status( msg27->nav_status );
+            export_.set_speed( msg27->sog );
+            export_.set_global( msg27->position.lat_deg, msg27->position.lng_deg );
+            export_.set_course( msg27->cog );
+            // no heading in this message
 
             // // unhandled fields:
             // int position_accuracy;
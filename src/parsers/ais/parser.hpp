@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include <string>
 #include <tuple>
 
 #include "core/report.hpp"
@@ -15,6 +16,11 @@ class Parser {
 public:
     Parser() = default;
 
+    /// \brief parses one NMEA line -- with or without an NMEA 4.x tag block
+    /// 
+    /// \param timestamp receive time (usec), used when the line has no `c:` tag
+    /// \param line raw text line; e.g. `\c:1653004800,s:r003669945*71\!AIVDM,...`
+    /// \return pointer to the parsed report, or nullptr on failure / unsupported message
     Report* parse( uint64_t timestamp, const std::string& line );
 
 private:
@@ -36,6 +42,9 @@ private:
 private:
     Report export_;
 
+    // per-class cache -- !NOT THREAD SAFE!
+    std::string sentence_;
+
 };
 
 }  // namespace ais
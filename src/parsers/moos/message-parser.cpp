@@ -8,6 +8,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include "core/name-table.hpp"
 #include "message-parser.hpp"
 
 namespace parsers {
@@ -66,6 +67,12 @@ Report* MessageParser::parse( const std::string& text ){
 
     export_.reset();
 
+    // positions are only valid as pairs; so collect both halves before committing either
+    double latitude = NAN;
+    double longitude = NAN;
+    double easting = NAN;
+    double northing = NAN;
+    std::string_view name;
     size_t parse_at_index = 0;
 
     while( parse_at_index < text.length() ) {
@@ -77,23 +84,23 @@ Report* MessageParser::parse( const std::string& text ){
         if( key.empty()){
             break;
         }else if("HDG"==key){
-            export_.heading = std::atof(value.data());
+            export_.set_heading( std::atof(value.data()) );
         }else if("LAT"==key){
-            export_.latitude = std::atof(value.data());
+            latitude = std::atof(value.data());
         }else if("LON"==key){
-            export_.longitude = std::atof(value.data());
+            longitude = std::atof(value.data());
         }else if("NAME"==key){
-            export_.name = value;
+            name = value;
         }else if("SPD"==key){
-            export_.speed = std::atof(value.data());
+            export_.set_speed( std::atof(value.data()) );
         }else if("TIME"==key){
             double int_part;
             double frac_part = std::modf(std::atof(value.data()), &int_part);
             export_.timestamp = static_cast<uint64_t>(int_part)*1'000'000 + static_cast<uint64_t>(frac_part*1'000'000);
         }else if("X"==key){
-            export_.easting = std::atof(value.data());
+            easting = std::atof(value.data());
         }else if("Y"==key){
-            export_.northing = std::atof(value.data());
+            northing = std::atof(value.data());
         }else{
             continue;
         //}else if("DEP"==key){
@@ -105,16 +112,28 @@ Report* MessageParser::parse( const std::string& text ){
         }
     }
 
-    if( std::isnan(export_.course) && !std::isnan(export_.heading)){
-        export_.course = export_.heading;
-    }else if( std::isnan(export_.heading) && !std::isnan(export_.course)){
-        export_.heading = export_.course;
+    if( (!std::isnan(latitude)) && (!std::isnan(longitude)) ){
+        export_.set_global( latitude, longitude );
+    }
+    if( (!std::isnan(easting)) && (!std::isnan(northing)) ){
+        export_.set_local( easting, northing );
+    }
+
+    if( (! export_.has(Report::COURSE)) && export_.has(Report::HEADING) ){
+        export_.set_course( export_.heading );
+    }else if( (! export_.has(Report::HEADING)) && export_.has(Report::COURSE) ){
+        export_.set_heading( export_.course );
+    }
+
+    // a report without a NAME must not clear the track's name
+    if( ! name.empty() ){
+        export_.set_name( NameTable::global().intern(name) );
     }
 
     if(0 == export_.id){
         // generate an guid from a text name
         // for more information, see: https://en.cppreference.com/w/cpp/utility/hash
-        export_.id = std::hash<std::string>{}(export_.name);
+        export_.id = std::hash<std::string_view>{}(name);
     }
 
     return &export_;
@@ -46,11 +46,11 @@ bool PacketParser::empty() const {
     );
 }
 
-std::string PacketParser::extract_string(){
+std::string_view PacketParser::extract_string(){
     const uint32_t snKey = *reinterpret_cast<const int32_t*>(cursor);
     const char* data = reinterpret_cast<char*>(cursor + 4);
     cursor += 4 + snKey;
-    return std::string( data, snKey );
+    return std::string_view( data, snKey );
 }
 
 bool PacketParser::load( const readers::pcap::FrameBuffer* source ){
@@ -157,10 +157,11 @@ std::string PacketParser::next(){
         }
 
         cursor = message_start + 10;
-        const std::string sSrc = extract_string();
-        const std::string sSrcAux = extract_string();
-        const std::string sOriginatingCommunity = extract_string();
-        const std::string sKey = extract_string();
+        // views into the packet; so skipped messages cost no allocation
+        [[maybe_unused]] const std::string_view sSrc = extract_string();
+        [[maybe_unused]] const std::string_view sSrcAux = extract_string();
+        [[maybe_unused]] const std::string_view sOriginatingCommunity = extract_string();
+        const std::string_view sKey = extract_string();
 
         // fprintf( stderr, "            ::sSrc:                   (%2lu): %s \n", sSrc.length(), sSrc.c_str() );
         // if( sKey == "MOOSDB_shoreside" ){
@@ -190,7 +191,7 @@ std::string PacketParser::next(){
         }
 
         cursor += 3*sizeof(double);  // skip ahead to the string-value field
-        const std::string value = extract_string();
+        const std::string value( extract_string() );
         // fprintf( stderr, "                ::string-value:    (%2lu): %s \n", value.length(), value.c_str() );
         cursor = message_start + nLength;
         return value;
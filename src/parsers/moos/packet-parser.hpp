@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <string_view>
 
 
 #include "readers/pcap/frame-buffer.hpp"
@@ -28,7 +30,8 @@ public:
     size_t length = 0;
 
 private:
-    std::string extract_string();
+    /// \brief view of the length-prefixed string at the cursor; valid while the loaded frame is
+    std::string_view extract_string();
 
 private:
     uint8_t* buffer = nullptr;
@@ -26,6 +26,17 @@ const uint8_t* PacketParser::find_byte( const uint8_t* find_start, uint8_t value
     return nullptr;
 }
 
+const uint8_t* PacketParser::find_line_start( const uint8_t* find_start ){
+    const uint8_t* find_end = cache->buffer + cache->length;
+    for( const uint8_t* cur = find_start; cur < find_end; ++cur ){
+        if( ('!' == *cur) || ('\\' == *cur) ){
+            return cur;
+        }
+    }
+
+    return nullptr;
+}
+
 uint32_t PacketParser::length() const {
     if( cache ){
         return cache->length;
@@ -48,7 +59,8 @@ std::string PacketParser::next() {
         // std::string debug_buffer( reinterpret_cast<const char*>(cache->buffer), cache->length );
         // std::cerr << "        :buffer:buffer:    " << debug_buffer << "\n";
 
-        const uint8_t* line_start = find_byte(cursor,  '!');
+        // a line starts at either its tag block, or its sentence
+        const uint8_t* line_start = find_line_start(cursor);
         if( nullptr == line_start){
             cursor = nullptr;
             return "";
@@ -63,7 +75,7 @@ std::string PacketParser::next() {
         const size_t line_length = (line_end - line_start);
 
         if( line_start && line_end && (12 < line_length) ){
-            cursor += line_length + 2;
+            cursor = const_cast<uint8_t*>(line_end) + 1;
             return std::string( reinterpret_cast<const char*>(line_start), line_length );
         }
     }
@@ -21,7 +21,7 @@ public:
 
     bool load( const readers::pcap::FrameBuffer* source );
 
-    /// \brief returns the next network frame
+    /// \brief returns the next NMEA line -- including any leading tag block
     /// \return on success -- get a byte-pointer to a valid NMEA Line
     ///         on failure -- empty string.  Signifies that no valid lines are available
     std::string next();
@@ -31,6 +31,9 @@ public:
 private:
     const uint8_t* find_byte( const uint8_t* start, uint8_t value );
 
+    /// \brief find the next '!' (sentence start) or '\' (tag block start)
+    const uint8_t* find_line_start( const uint8_t* start );
+
 private:
     const readers::pcap::FrameBuffer* cache = nullptr;
     uint8_t* cursor = nullptr;
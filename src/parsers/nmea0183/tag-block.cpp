@@ -0,0 +1,128 @@
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+#include "tag-block.hpp"
+
+namespace parsers {
+namespace nmea0183 {
+
+// any `c:` value above this is in milliseconds, rather than seconds. (i.e. after year 5138)
+constexpr static uint64_t max_timestamp_seconds = 100'000'000'000;
+
+static inline uint8_t parse_hex_digit( char c ){
+    if( ('0' <= c) && (c <= '9') ){
+        return c - '0';
+    }else if( ('A' <= c) && (c <= 'F') ){
+        return c - 'A' + 10;
+    }else if( ('a' <= c) && (c <= 'f') ){
+        return c - 'a' + 10;
+    }
+    return 0xFF;
+}
+
+// parse a unix time in either (integer / fractional) seconds, or integer milliseconds
+static bool parse_timestamp( std::string_view text, uint64_t& timestamp ){
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+
+    uint64_t whole = 0;
+    const auto [whole_end, error] = std::from_chars( first, last, whole );
+    if( (std::errc() != error) ){
+        return false;
+    }
+
+    if( max_timestamp_seconds < whole ){
+        timestamp = whole * 1'000;
+        return true;
+    }
+
+    uint64_t fraction = 0;
+    uint64_t scale = 1'000'000;
+    if( (whole_end < last) && ('.' == *whole_end) ){
+        for( const char* cur = whole_end + 1; (cur < last) && ('0' <= *cur) && (*cur <= '9'); ++cur ){
+            if( 1 < scale ){
+                scale /= 10;
+                fraction += (*cur - '0') * scale;
+            }
+        }
+    }
+
+    timestamp = whole * 1'000'000 + fraction;
+    return true;
+}
+
+bool parse_tag_block( std::string_view line, TagBlock& block ){
+    block.timestamp = 0;
+    block.source = {};
+    block.sentence = line;
+
+    if( line.empty() || ('\\' != line[0]) ){
+        // no tag block: the whole line is the sentence
+        return true;
+    }
+
+    const size_t block_end = line.find( '\\', 1 );
+    if( std::string_view::npos == block_end ){
+        return false;
+    }
+
+    std::string_view fields = line.substr( 1, block_end - 1 );
+    block.sentence = line.substr( block_end + 1 );
+
+    // the checksum is optional; but when present, it must match
+    const size_t checksum_index = fields.rfind( '*' );
+    if( std::string_view::npos != checksum_index ){
+        if( (checksum_index + 3) != fields.size() ){
+            return false;
+        }
+
+        const uint8_t high = parse_hex_digit( fields[checksum_index + 1] );
+        const uint8_t low = parse_hex_digit( fields[checksum_index + 2] );
+        if( (0xF < high) || (0xF < low) ){
+            return false;
+        }
+
+        uint8_t checksum = 0;
+        for( size_t i = 0; i < checksum_index; ++i ){
+            checksum ^= static_cast<uint8_t>(fields[i]);
+        }
+        if( checksum != ((high << 4) | low) ){
+            return false;
+        }
+
+        fields.remove_suffix( fields.size() - checksum_index );
+    }
+
+    // fields are comma-separated "<code>:<value>" pairs
+    while( ! fields.empty() ){
+        const size_t comma_index = fields.find( ',' );
+        const std::string_view field = fields.substr( 0, comma_index );
+        fields.remove_prefix( (std::string_view::npos == comma_index) ? fields.size() : comma_index + 1 );
+
+        if( (field.size() < 2) || (':' != field[1]) ){
+            return false;
+        }
+
+        const std::string_view value = field.substr( 2 );
+        switch( field[0] ){
+            case 'c':
+                if( ! parse_timestamp( value, block.timestamp ) ){
+                    return false;
+                }
+                break;
+            case 's':
+                block.source = value;
+                break;
+            default:
+                // d: destination, g: group, n: line-count, r: relative time, t: text, i: info
+                // valid, but ignored.
+                break;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace nmea0183
+}  // namespace parsers
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace parsers {
+namespace nmea0183 {
+
+/// \brief fields extracted from an NMEA 4.x tag block
+///
+/// A tag block prefixes the sentence proper, and is delimited by backslashes:
+///     \c:1653004800,s:r003669945*71\!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24
+///
+/// Handles Fields:
+///     c (receive time; unix seconds or milliseconds), s (source station)
+/// Ignores Fields:
+///     d, g, n, r, t, i
+///
+/// All views point into the line passed to `parse_tag_block`; nothing is copied.
+struct TagBlock {
+    /// \brief receive time in usec.  0 => absent
+    uint64_t timestamp = 0;
+
+    /// \brief source station, e.g. "r003669945".  empty => absent
+    std::string_view source;
+
+    /// \brief remainder of the line, after the tag block
+    std::string_view sentence;
+};
+
+/// \brief split an optional tag block off of the front of an NMEA line
+/// \return true on success -- including lines without any tag block;
+///         false if the tag block is malformed or fails its checksum.
+///
+/// Further Reference:
+///   - https://gpsd.gitlab.io/gpsd/AIVDM.html#_nmea_tag_blocks
+bool parse_tag_block( std::string_view line, TagBlock& block );
+
+}  // namespace nmea0183
+}  // namespace parsers
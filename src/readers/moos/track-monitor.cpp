@@ -15,6 +15,7 @@
 // Boston, MA 02111-1307, USA.
 //*****************************************************************************
 
+#include <cmath>
 #include <iterator>
 
 #include <ncurses.h>
@@ -69,7 +70,7 @@ bool TrackMonitor::OnNewMail(MOOSMSG_LIST &NewMail)
     }
 
     // if(changed)
-    //     handler.update(changed);
+    //     handler.render();
     
     return true;
 }
@@ -90,7 +91,7 @@ bool TrackMonitor::OnConnectToServer()
     handler.configure();//app_freq);
 
     // force an initial draw
-    handler.update(true);
+    handler.render();
 
     return true;
 }
@@ -100,7 +101,7 @@ bool TrackMonitor::Iterate()
 {
     handler.handle_input();
 
-    handler.update(true);
+    handler.render();
 
     // unsigned int i, amt = (m_tally_recd - m_tally_sent);
     // for(i=0; i<amt; i++) {
@@ -144,7 +145,8 @@ bool TrackMonitor::OnStartUp()
 {
     STRING_LIST sParams;
     STRING_LIST::iterator p;
-    double origin_latitude, origin_longitude;
+    double origin_latitude = NAN;
+    double origin_longitude = NAN;
 
     fprintf(logfile, "==== Loading :%s: Config ====\n", GetAppName().c_str() );
     m_MissionReader.GetConfiguration(GetAppName(), sParams);
@@ -166,8 +168,10 @@ bool TrackMonitor::OnStartUp()
         //     std::cerr << "CommsTick == " << value << std::endl;
 
         }
-        cache.set_origin(origin_latitude, origin_longitude);
     }
 
+    // once, after every parameter is read.  (ignored unless both are present)
+    cache.set_origin(origin_latitude, origin_longitude);
+
     return(true);
 }
@@ -27,9 +27,14 @@ bool TextLogReader::open( const std::string& filename ){
 }
 
 const std::string* TextLogReader::next() {
-    _source >> _each_line;
-
-    if( _source.good() ){   
+    // read whole lines: tag blocks and sentences may both contain spaces
+    std::getline( _source, _each_line );
+
+    // a last line without a newline still counts: getline then sets eof, but only fails if it read nothing
+    if( ! _source.fail() ){
+        if( (! _each_line.empty()) && ('\r' == _each_line.back()) ){
+            _each_line.pop_back();
+        }
         return &_each_line;
     }
 
@@ -0,0 +1,103 @@
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "socket-reader.hpp"
+
+namespace readers {
+namespace udp {
+
+/// \brief largest possible UDP payload
+constexpr static size_t datagram_capacity = 65536;
+
+SocketReader::SocketReader( const std::string& host, uint16_t port )
+    : socket_(-1)
+    , error_(0)
+    , buffer_(datagram_capacity)
+    , cache{0, 0, nullptr}
+{
+    open( host, port );
+}
+
+SocketReader::~SocketReader(){
+    if( 0 <= socket_ ){
+        close( socket_ );
+    }
+}
+
+bool SocketReader::good() const {
+    return (0 <= socket_);
+}
+
+bool SocketReader::open( const std::string& host, uint16_t port ){
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if( host.empty() ){
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+    }else if( 1 != inet_pton(AF_INET, host.c_str(), &address.sin_addr) ){
+        spdlog::error("!! could not parse UDP address: {}", host );
+        return false;
+    }
+
+    socket_ = socket( AF_INET, SOCK_DGRAM, 0 );
+    if( socket_ < 0 ){
+        spdlog::error("!! could not create UDP socket: {}", strerror(errno) );
+        return false;
+    }
+
+    // so a restarted monitor can re-bind at once; and several may share a broadcast feed
+    const int enable = 1;
+    setsockopt( socket_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable) );
+
+    if( 0 != bind(socket_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ){
+        spdlog::error("!! could not bind UDP socket to {}:{}: {}", host, port, strerror(errno) );
+        close( socket_ );
+        socket_ = -1;
+        return false;
+    }
+    return true;
+}
+
+const readers::pcap::FrameBuffer& SocketReader::next( std::chrono::milliseconds timeout ){
+    cache.length = 0;
+    error_ = 0;
+
+    // wait with a timeout; so the caller can notice a stop request
+    pollfd request{ socket_, POLLIN, 0 };
+    const int ready = poll( &request, 1, static_cast<int>(timeout.count()) );
+    if( ready <= 0 ){
+        if( (ready < 0) && (EINTR != errno) ){
+            error_ = errno;
+        }
+        return cache;
+    }
+
+    const ssize_t received = recv( socket_, buffer_.data(), buffer_.size(), 0 );
+    if( received < 0 ){
+        if( (EAGAIN != errno) && (EINTR != errno) ){
+            error_ = errno;
+        }
+        return cache;
+    }
+
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    cache.timestamp = static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>(now).count() );
+    cache.length = static_cast<size_t>(received);
+    cache.buffer = buffer_.data();
+    return cache;
+}
+
+int SocketReader::error() const {
+    return error_;
+}
+
+}  // namespace udp
+}  // namespace readers
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "readers/pcap/frame-buffer.hpp"
+
+namespace readers {
+namespace udp {
+
+/// \brief live connector that receives one UDP datagram at a time; e.g. an AIS receiver's NMEA feed
+class SocketReader {
+public:
+
+    /// \param host local address to bind to; "" => every interface
+    SocketReader( const std::string& host, uint16_t port );
+
+    ~SocketReader();
+
+    SocketReader( const SocketReader& ) = delete;
+    SocketReader& operator=( const SocketReader& ) = delete;
+
+    bool good() const;
+
+    /// \return true on success; false on failure
+    bool open( const std::string& host, uint16_t port );
+
+    /// \brief wait, up to `timeout`, for the next datagram
+    /// \return the datagram, stamped with its receive time (usec); length 0 on timeout or error.
+    ///         valid until the next call.
+    const readers::pcap::FrameBuffer& next( std::chrono::milliseconds timeout = std::chrono::milliseconds(100) );
+
+    /// \return errno of the last failed receive; 0 if the last call succeeded, or timed out
+    int error() const;
+
+private:
+    int socket_;
+    int error_;
+
+    std::vector<uint8_t> buffer_;
+
+    readers::pcap::FrameBuffer cache;
+
+};
+
+}  // namespace udp
+}  // namespace readers
@@ -0,0 +1,18 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "core/name-table.hpp"
+#include "parsers/ais/parser.hpp"
+
+TEST( AisParser, TagBlockTakesPrecedence ){
+    // as documented in parser.hpp
+    const std::string line = "\\c:1653004800,s:r003669945*71\\!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24";
+
+    parsers::ais::Parser parser;
+    const Report* report = parser.parse( 42, line );
+    ASSERT_NE( nullptr, report );
+    EXPECT_EQ( 1653004800000000u, report->timestamp );
+    ASSERT_TRUE( report->has(Report::STATION) );
+    EXPECT_EQ( "r003669945", NameTable::global().lookup(report->station) );
+}
@@ -0,0 +1,42 @@
+# ============================================================================
+# `ingest --export jsonl:-`: stdout must hold the export records, and nothing else
+#
+#   cmake -DINGEST=<path to ingest> -P export-stdout.cmake
+#
+# Run from the repository root; so the default connectors find `data/`.
+# ============================================================================
+
+if( NOT INGEST )
+    message( FATAL_ERROR "INGEST not set; expected the path to the ingest binary" )
+endif()
+
+execute_process( COMMAND ${INGEST} --limit 2000 --export jsonl:-
+                 RESULT_VARIABLE result
+                 OUTPUT_VARIABLE output
+                 ERROR_VARIABLE errors )
+if( NOT result EQUAL 0 )
+    message( FATAL_ERROR "ingest failed (${result}):\n${errors}" )
+endif()
+
+# ';' would split records into list items; no record needs it to be checked
+string( REPLACE ";" "," output "${output}" )
+string( REPLACE "\n" ";" lines "${output}" )
+
+set( records 0 )
+foreach( line IN LISTS lines )
+    if( line STREQUAL "" )
+        continue()
+    endif()
+    if( NOT line MATCHES "^{\"id\":[0-9]+,.*}$" )
+        message( FATAL_ERROR "stdout holds a line which is not an export record:\n${line}" )
+    endif()
+    math( EXPR records "${records} + 1" )
+endforeach()
+
+if( records EQUAL 0 )
+    message( FATAL_ERROR "stdout holds no export records; logs:\n${errors}" )
+endif()
+if( NOT errors MATCHES "Exported ${records} tracks to: -" )
+    message( FATAL_ERROR "expected the export's summary on stderr, for ${records} records; logs:\n${errors}" )
+endif()
+message( STATUS "${records} export records on stdout; logs on stderr" )
@@ -0,0 +1,38 @@
+# ============================================================================
+# `ingest --history DEPTH,WINDOW`: the option must reach the cache, and fill each track's history
+#
+#   cmake -DINGEST=<path to ingest> -P history-option.cmake
+#
+# Run from the repository root; so the default connectors find `data/`.
+# ============================================================================
+
+if( NOT INGEST )
+    message( FATAL_ERROR "INGEST not set; expected the path to the ingest binary" )
+endif()
+
+# the MOOS capture carries local positions; so it needs no origin
+execute_process( COMMAND ${INGEST} --history 32,600
+                 RESULT_VARIABLE result
+                 OUTPUT_VARIABLE output
+                 ERROR_VARIABLE errors )
+if( NOT result EQUAL 0 )
+    message( FATAL_ERROR "ingest failed (${result}):\n${output}${errors}" )
+endif()
+if( NOT "${output}${errors}" MATCHES "History: ([0-9]+) samples, over ([0-9]+) tracks" )
+    message( FATAL_ERROR "expected a history summary; logs:\n${output}${errors}" )
+endif()
+set( samples ${CMAKE_MATCH_1} )
+set( tracks ${CMAKE_MATCH_2} )
+math( EXPR most "${tracks} * 32" )
+if( samples GREATER most )
+    message( FATAL_ERROR "${samples} samples over ${tracks} tracks; more than the depth allows" )
+endif()
+
+# a malformed spec is refused
+execute_process( COMMAND ${INGEST} --history 32,
+                 RESULT_VARIABLE result
+                 OUTPUT_QUIET ERROR_QUIET )
+if( result EQUAL 0 )
+    message( FATAL_ERROR "ingest accepted a malformed --history" )
+endif()
+message( STATUS "${samples} history samples, over ${tracks} tracks" )
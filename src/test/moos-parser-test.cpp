@@ -0,0 +1,46 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "core/name-table.hpp"
+#include "core/track-cache.hpp"
+#include "parsers/moos/message-parser.hpp"
+
+using parsers::moos::MessageParser;
+
+TEST( MoosMessageParser, ParsesNodeReport ){
+    MessageParser parser;
+    const Report* report = parser.parse( "NAME=alpha,TYPE=UUV,TIME=1252348077.5,X=51.71,Y=-35.50,SPD=2.00,HDG=118.85" );
+    ASSERT_NE( nullptr, report );
+    ASSERT_TRUE( report->has(Report::NAME) );
+    EXPECT_EQ( "alpha", NameTable::global().lookup(report->name) );
+    EXPECT_TRUE( report->has(Report::LOCAL) );
+    EXPECT_FLOAT_EQ( 51.71f, report->easting );
+    EXPECT_FLOAT_EQ( -35.50f, report->northing );
+    EXPECT_EQ( 1252348077500000u, report->timestamp );
+}
+
+TEST( MoosMessageParser, NamelessReportHasNoName ){
+    MessageParser parser;
+    const Report* report = parser.parse( "TIME=1252348077.59,X=51.71,Y=-35.50" );
+    ASSERT_NE( nullptr, report );
+    EXPECT_FALSE( report->has(Report::NAME) );
+}
+
+TEST( MoosMessageParser, NamelessReportKeepsTrackName ){
+    MessageParser parser;
+    TrackCache cache;
+
+    Report named = *parser.parse( "NAME=alpha,TIME=1252348077.59,X=51.71,Y=-35.50" );
+    ASSERT_TRUE( cache.update(named) );
+
+    // the same vessel, without its NAME field
+    Report nameless = *parser.parse( "TIME=1252348078.59,X=52.71,Y=-36.50" );
+    nameless.id = named.id;
+    cache.update( nameless );
+
+    const Track* track = cache.get( named.id );
+    ASSERT_NE( nullptr, track );
+    EXPECT_EQ( "alpha", NameTable::global().lookup(track->name) );
+    EXPECT_FLOAT_EQ( 52.71f, track->last_report.easting );
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "core/projection-service.hpp"
+#include "core/track-cache.hpp"
+#include "parsers/ais/parser.hpp"
+#include "readers/nmea0183/text-log-reader.hpp"
+
+/// \brief every AIS log in data/; run from the repository root
+static const char* const capture_paths[] = {
+    "data/ais.nmea0183.2022-05-18.log",
+    "data/ais.nmea0183.2022-05-19.log",
+    "data/sample.aivdm.txt",
+};
+
+/// \brief every report with a global position, from every capture
+static std::vector<Report> load_global_reports(){
+    std::vector<Report> reports;
+    parsers::ais::Parser parser;
+    for( const char* path : capture_paths ){
+        readers::nmea0183::TextLogReader reader( path );
+        EXPECT_TRUE( reader.good() ) << "missing capture: " << path;
+        for( const std::string* line = reader.next(); nullptr != line; line = reader.next() ){
+            if( line->empty() || ('#' == line->front()) ){
+                continue;
+            }
+            const Report* report = parser.parse( 1, *line );
+            if( (nullptr != report) && report->has(Report::GLOBAL) && std::isfinite(report->latitude) && std::isfinite(report->longitude) ){
+                reports.push_back( *report );
+            }
+        }
+    }
+    return reports;
+}
+
+/// \brief FAST projection stays within its error bound of EXACT, for every position in the captures
+TEST( LocalProjection, CapturesWithinErrorBound ){
+    const std::vector<Report> reports = load_global_reports();
+    ASSERT_FALSE( reports.empty() );
+
+    // as `ingest --bench`: project around the first position seen
+    const double latitude = reports.front().latitude;
+    const double longitude = reports.front().longitude;
+
+    for( const double max_error : {0.01, 0.1, 1.0} ){
+        TrackCache exact;
+        exact.set_origin( latitude, longitude );
+
+        TrackCache fast;
+        fast.set_projection( TrackCache::FAST, max_error );
+        fast.set_origin( latitude, longitude );
+        ASSERT_LT( 0, fast.fast_projection_radius() );
+
+        std::vector<Report> exact_reports = reports;
+        std::vector<Report> fast_reports = reports;
+        ASSERT_EQ( reports.size(), exact.project(exact_reports) );
+        ASSERT_EQ( reports.size(), fast.project(fast_reports) );
+
+        double worst = 0;
+        size_t within_radius = 0;
+        for( size_t index = 0; index < reports.size(); ++index ){
+            const Report& expected = exact_reports[index];
+            const Report& actual = fast_reports[index];
+            ASSERT_TRUE( expected.has(Report::LOCAL) && actual.has(Report::LOCAL) );
+            const double error = std::hypot( actual.easting - expected.easting, actual.northing - expected.northing );
+            worst = std::max( worst, error );
+            if( std::hypot(expected.easting, expected.northing) < fast.fast_projection_radius() ){
+                ++within_radius;
+            }
+        }
+
+        // positions are stored as floats; allow for their rounding, on top of the bound
+        EXPECT_LE( worst, max_error + 0.01 ) << "over " << reports.size() << " positions; " << within_radius << " within the fast radius";
+        // else the fast path was never exercised
+        EXPECT_LT( 0u, within_radius );
+    }
+}
+
+/// \brief a grid of global positions, `span` degrees either side of the given point
+static std::vector<Report> global_grid( double latitude, double longitude, double span, int steps ){
+    std::vector<Report> reports;
+    uint64_t id = 1;
+    for( int row = -steps; row <= steps; ++row ){
+        for( int column = -steps; column <= steps; ++column ){
+            Report report;
+            report.id = id++;
+            report.timestamp = id;
+            report.set_global( latitude + span * row / steps, longitude + span * column / steps );
+            reports.push_back( report );
+        }
+    }
+    return reports;
+}
+
+/// \brief moving the origin, many times and across a zone, projects as a cache built at the final origin
+TEST( ProjectionManager, RepeatedSetOriginMatchesFreshCache ){
+    for( const auto mode : {TrackCache::EXACT, TrackCache::FAST} ){
+        TrackCache moved;
+        moved.set_projection( mode, 0.1 );
+        for( int step = 0; step < 100; ++step ){
+            moved.set_origin( 29.7 + step * 1e-4, -91.88 );
+        }
+        // zone 15 => zone 16
+        moved.set_origin( 29.7, -86.0 );
+
+        TrackCache fresh;
+        fresh.set_projection( mode, 0.1 );
+        fresh.set_origin( 29.7, -86.0 );
+
+        std::vector<Report> expected = global_grid( 29.7, -86.0, 0.2, 5 );
+        std::vector<Report> actual = expected;
+        ASSERT_EQ( expected.size(), fresh.project(expected) );
+        ASSERT_EQ( actual.size(), moved.project(actual) );
+        for( size_t index = 0; index < expected.size(); ++index ){
+            EXPECT_EQ( expected[index].easting, actual[index].easting );
+            EXPECT_EQ( expected[index].northing, actual[index].northing );
+        }
+    }
+}
+
+/// \brief each thread projects through its own clone of the zone's transform
+TEST( ProjectionService, ClonesPerThread ){
+    ProjectionService service;
+    PJ* const mine = service.get( 15 );
+    ASSERT_NE( nullptr, mine );
+    const PJ_COORD expected = proj_trans( mine, PJ_FWD, proj_coord(29.7, -91.88, 0, 0) );
+
+    constexpr size_t thread_count = 16;
+    std::vector<PJ*> theirs( thread_count, nullptr );
+    std::vector<PJ_COORD> results( thread_count );
+    std::vector<std::thread> threads;
+    for( size_t index = 0; index < thread_count; ++index ){
+        threads.emplace_back( [&, index](){
+            theirs[index] = service.get( 15 );
+            results[index] = proj_trans( theirs[index], PJ_FWD, proj_coord(29.7, -91.88, 0, 0) );
+        });
+    }
+    for( auto& thread : threads ){
+        thread.join();
+    }
+
+    EXPECT_EQ( thread_count + 1, service.thread_count() );
+    for( size_t index = 0; index < thread_count; ++index ){
+        ASSERT_NE( nullptr, theirs[index] );
+        EXPECT_NE( mine, theirs[index] );
+        EXPECT_EQ( expected.enu.e, results[index].enu.e );
+        EXPECT_EQ( expected.enu.n, results[index].enu.n );
+    }
+}
+
+/// \brief many threads projecting through one cache agree with one thread; across a zone boundary, in both modes
+TEST( ProjectionService, ConcurrentProjectionMatchesSingleThread ){
+    for( const auto mode : {TrackCache::EXACT, TrackCache::FAST} ){
+        TrackCache cache;
+        cache.set_projection( mode, 0.1 );
+        cache.set_origin( 29.7, -91.88 );
+
+        // -90 is the boundary between zones 15 and 16
+        const std::vector<Report> input = global_grid( 29.7, -90.5, 1.0, 20 );
+        std::vector<Report> expected = input;
+        cache.project( expected );
+
+        constexpr size_t thread_count = 16;
+        std::vector<std::vector<Report>> results( thread_count, input );
+        std::vector<std::thread> threads;
+        for( size_t index = 0; index < thread_count; ++index ){
+            threads.emplace_back( [&, index](){
+                for( int loop = 0; loop < 10; ++loop ){
+                    results[index] = input;
+                    cache.project( results[index] );
+                }
+            });
+        }
+        for( auto& thread : threads ){
+            thread.join();
+        }
+
+        for( const std::vector<Report>& result : results ){
+            for( size_t index = 0; index < input.size(); ++index ){
+                ASSERT_EQ( expected[index].easting, result[index].easting );
+                ASSERT_EQ( expected[index].northing, result[index].northing );
+            }
+        }
+    }
+}
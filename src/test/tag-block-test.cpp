@@ -0,0 +1,33 @@
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "parsers/nmea0183/tag-block.hpp"
+
+using parsers::nmea0183::parse_tag_block;
+using parsers::nmea0183::TagBlock;
+
+// as documented in tag-block.hpp
+constexpr static std::string_view tagged_line = "\\c:1653004800,s:r003669945*71\\!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24";
+
+TEST( TagBlock, ParsesDocumentedExample ){
+    TagBlock block;
+    ASSERT_TRUE( parse_tag_block(tagged_line, block) );
+    EXPECT_EQ( 1653004800000000u, block.timestamp );
+    EXPECT_EQ( "r003669945", block.source );
+    EXPECT_EQ( "!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24", block.sentence );
+}
+
+TEST( TagBlock, RejectsBadChecksum ){
+    TagBlock block;
+    EXPECT_FALSE( parse_tag_block("\\c:1653004800,s:r003669945*5C\\!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24", block) );
+}
+
+TEST( TagBlock, PassesUntaggedLineThrough ){
+    constexpr std::string_view line = "!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24";
+    TagBlock block;
+    ASSERT_TRUE( parse_tag_block(line, block) );
+    EXPECT_EQ( 0u, block.timestamp );
+    EXPECT_TRUE( block.source.empty() );
+    EXPECT_EQ( line, block.sentence );
+}
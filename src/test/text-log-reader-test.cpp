@@ -0,0 +1,42 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "readers/nmea0183/text-log-reader.hpp"
+
+using readers::nmea0183::TextLogReader;
+
+/// \brief a temporary log file, with exactly the given contents
+static std::string write_log( const char* name, const std::string& contents ){
+    const std::string path = testing::TempDir() + name;
+    std::ofstream( path, std::ios::binary ) << contents;
+    return path;
+}
+
+TEST( TextLogReader, ReadsEveryLine ){
+    const std::string path = write_log( "every-line.log", "first\r\nsecond\n" );
+    TextLogReader reader( path );
+
+    const std::string* line = reader.next();
+    ASSERT_NE( nullptr, line );
+    EXPECT_EQ( "first", *line );
+    line = reader.next();
+    ASSERT_NE( nullptr, line );
+    EXPECT_EQ( "second", *line );
+    EXPECT_EQ( nullptr, reader.next() );
+    std::remove( path.c_str() );
+}
+
+TEST( TextLogReader, ReadsLastLineWithoutNewline ){
+    const std::string path = write_log( "unterminated.log", "first\nsecond" );
+    TextLogReader reader( path );
+
+    ASSERT_NE( nullptr, reader.next() );
+    const std::string* line = reader.next();
+    ASSERT_NE( nullptr, line );
+    EXPECT_EQ( "second", *line );
+    EXPECT_EQ( nullptr, reader.next() );
+    std::remove( path.c_str() );
+}
@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "core/sharded-track-cache.hpp"
+#include "core/track-cache.hpp"
+
+constexpr static uint64_t second = 1'000'000;
+
+/// \brief a local-position report from one AIS track, at `seconds`
+static Report at( uint64_t id, uint64_t seconds, float easting ){
+    Report report;
+    report.id = id;
+    report.timestamp = seconds * second;
+    report.source = Report::AIS;
+    report.set_local( easting, 0 );
+    return report;
+}
+
+TEST( TrackCacheExpiry, StaleAgainAfterRefresh ){
+    TrackCache cache;
+    cache.set_expiry( Report::AIS, 180 * second, 0 );
+
+    Report first = at( 7, 1000, 1 );
+    cache.update( first );
+    cache.expire( 1200 * second );
+    ASSERT_TRUE( cache.get(7)->stale );
+
+    // a refresh clears the flag ...
+    Report refresh = at( 7, 1300, 2 );
+    cache.update( refresh );
+    ASSERT_FALSE( cache.get(7)->stale );
+    EXPECT_EQ( 0u, cache.stale_count() );
+
+    // ... and the track goes stale again, once it falls quiet for another stale age
+    cache.expire( 1300 * second + 3600 * second );
+    EXPECT_TRUE( cache.get(7)->stale );
+    EXPECT_EQ( 1u, cache.stale_count() );
+}
+
+TEST( TrackCacheExpiry, StaleOnTimeAfterRefreshWithExpiry ){
+    TrackCache cache;
+    cache.set_expiry( Report::AIS, 180 * second, 900 * second );
+
+    Report first = at( 7, 1000, 1 );
+    cache.update( first );
+    cache.expire( 1200 * second );
+    ASSERT_TRUE( cache.get(7)->stale );
+
+    Report refresh = at( 7, 1300, 2 );
+    cache.update( refresh );
+
+    // stale at the stale age after the refresh; not held back until the old expiry deadline
+    cache.expire( 1300 * second + 181 * second );
+    ASSERT_NE( nullptr, cache.get(7) );
+    EXPECT_TRUE( cache.get(7)->stale );
+}
+
+TEST( TrackCacheHistory, ParsesSpec ){
+    TrackCache cache;
+    EXPECT_TRUE( cache.set_history("0") );
+    EXPECT_TRUE( cache.set_history("64") );
+    EXPECT_TRUE( cache.set_history("64,600") );
+    EXPECT_TRUE( cache.set_history("64,0.5") );
+    EXPECT_FALSE( cache.set_history("") );
+    EXPECT_FALSE( cache.set_history("x") );
+    EXPECT_FALSE( cache.set_history("64,") );
+    EXPECT_FALSE( cache.set_history("64;600") );
+    EXPECT_FALSE( cache.set_history("64,-1") );
+    EXPECT_FALSE( cache.set_history("64,600,1") );
+}
+
+TEST( TrackCacheHistory, SpecBoundsDepthAndWindow ){
+    // as `--history 4,60`
+    TrackCache cache;
+    ASSERT_TRUE( cache.set_history("4,60") );
+
+    for( uint64_t seconds = 1000; seconds <= 1050; seconds += 10 ){
+        Report report = at( 7, seconds, static_cast<float>(seconds - 1000) );
+        cache.update( report );
+    }
+
+    // six reports; only the newest four are kept
+    const HistoryView history = cache.history( 7 );
+    ASSERT_EQ( 4u, history.size() );
+    EXPECT_EQ( 1050 * second, history.timestamp(0) );
+    EXPECT_EQ( 1020 * second, history.timestamp(3) );
+
+    float easting = 0;
+    float northing = 0;
+    ASSERT_TRUE( history.position_at(1035 * second, easting, northing) );
+    EXPECT_FLOAT_EQ( 35.0f, easting );
+    EXPECT_FALSE( history.position_at(1010 * second, easting, northing) );
+
+    // a report past the window drops every older sample
+    Report late = at( 7, 1200, 200 );
+    cache.update( late );
+    EXPECT_EQ( 1u, cache.history(7).size() );
+}
+
+TEST( TrackCacheHistory, DisabledByDefault ){
+    TrackCache cache;
+    Report report = at( 7, 1000, 1 );
+    cache.update( report );
+    EXPECT_TRUE( cache.history(7).empty() );
+}
+
+TEST( ShardedTrackCache, BatchReachesEveryShard ){
+    ShardedTrackCache cache( 4 );
+    std::vector<Report> batch;
+    for( uint64_t id = 1; id <= 1000; ++id ){
+        batch.push_back( at(id, 1000, 0) );
+    }
+    EXPECT_EQ( 1000u, cache.update(batch) );
+    EXPECT_EQ( 1000u, cache.size() );
+
+    for( Report& report : batch ){
+        report = at( report.id, 1001, static_cast<float>(report.id) );
+    }
+    EXPECT_EQ( 1000u, cache.update(batch) );
+    for( uint64_t id = 1; id <= 1000; ++id ){
+        float easting = 0;
+        ASSERT_TRUE( cache.visit(id, [&]( const Track& track ){ easting = track.last_report.easting; }) );
+        EXPECT_FLOAT_EQ( static_cast<float>(id), easting );
+    }
+}
+
+TEST( ShardedTrackCache, QuietShardFollowsSharedClock ){
+    ShardedTrackCache cache( 4 );
+    cache.set_expiry( Report::AIS, 180 * second, 600 * second );
+
+    Report quiet = at( 1, 1000, 1 );
+    cache.update( quiet );
+
+    // every later report comes from a track on another shard
+    uint64_t other = 2;
+    while( cache.shard(other) == cache.shard(quiet.id) ){
+        ++other;
+    }
+    std::vector<Report> batch = { at(other, 1200, 1) };
+    cache.update( batch );
+
+    bool stale = false;
+    ASSERT_TRUE( cache.visit(quiet.id, [&]( const Track& track ){ stale = track.stale; }) );
+    EXPECT_TRUE( stale );
+
+    Report late = at( other, 1700, 2 );
+    cache.update( late );
+    EXPECT_FALSE( cache.visit(quiet.id, []( const Track& ){}) );
+    EXPECT_EQ( 1u, cache.size() );
+}
+
+TEST( ShardedTrackCache, ExpireWhileQuiet ){
+    ShardedTrackCache cache( 4 );
+    cache.set_expiry( Report::AIS, 180 * second, 0 );
+    Report report = at( 1, 1000, 1 );
+    cache.update( report );
+
+    cache.expire( 1181 * second );
+    bool stale = false;
+    ASSERT_TRUE( cache.visit(1, [&]( const Track& track ){ stale = track.stale; }) );
+    EXPECT_TRUE( stale );
+}
@@ -1,24 +1,30 @@
 // Standard Library Includes
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Dependency Includes
 #include <cxxopts.hpp>
 #include <fmt/core.h>
 #include <ncurses.h>
+#include <signal.h>
+#include <unistd.h>
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
 // Project includes
+#include "connectors/registry.hpp"
+#include "core/checkpoint.hpp"
+#include "core/connector.hpp"
+#include "core/cpa-engine.hpp"
+#include "core/event-loop.hpp"
+#include "core/ingest-pipeline.hpp"
+#include "core/journal.hpp"
 #include "core/track-cache.hpp"
-#include "readers/pcap/log-reader.hpp"
-#include "parsers/ais/parser.hpp"
-#include "parsers/moos/message-parser.hpp"
-#include "parsers/moos/packet-parser.hpp"
-#include "parsers/nmea0183/packet-parser.hpp"
 
 #include "ui/curses-input-handler.hpp"
 #include "ui/curses-renderer.hpp"
@@ -26,8 +32,6 @@
 const static std::string binary_name = "trackmon";
 const static std::string binary_version = "0.0.2";
 
-static bool run = true;
-
 // //---------------------------------------------------------
 // // Procedure: OnStartUp()
 // //      Note: happens before connection is open
@@ -85,12 +89,38 @@ void print_version_information() {
     std::cout << binary_name << "    Version: " << "0.0.1-beta" << std::endl;
 }
 
+/// \brief connectors to use, when none are given
+std::vector<std::string> default_sources(){
+    std::vector<std::string> specs;
+#ifdef ENABLE_AIS
+    // "ais:text:data/ais.nmea0183.2022-05-18.log"
+    specs.push_back( "ais:pcap:data/ais.tcpdump.2022-05-18.pcap;protocol=udp;port=4003" );
+#endif
+#ifdef ENABLE_MOOS
+    // "moos:pcap:data/m2_berta.moos.gt140.pcap;protocol=tcp;port=9000"
+    specs.push_back( "moos:pcap:data/m2_berta.moos.p9000.pcap;protocol=tcp;port=9000" );
+#endif
+    return specs;
+}
+
 int main(int argc, char *argv[]){
     // Create a cxxopts::Options instance.
     cxxopts::Options options("trackmon", "monitor tracks from data streams");
     options.add_options()
         ("b,build", "Display Build Information")
+        ("checkpoint", "restore tracks from this file at startup; and save them to it periodically", cxxopts::value<std::string>()->default_value(""))
+        ("checkpoint-interval", "seconds between checkpoints", cxxopts::value<double>()->default_value("60"))
+        ("cpa-distance", "flag pairs of tracks predicted to pass within this many meters.  0 => disable", cxxopts::value<double>()->default_value("500"))
+        ("cpa-horizon", "look this many seconds ahead for closest approaches", cxxopts::value<double>()->default_value("600"))
         ("h,help", "Print usage")
+        ("journal", "append every update to a journal in this directory; for replay (see: ingest --replay)", cxxopts::value<std::string>()->default_value(""))
+        ("s,source", "read from this connector: 'PARSER:READER:TARGET[;KEY=VALUE]...';  repeatable.  e.g. 'ais:udp:4003'", cxxopts::value<std::vector<std::string>>())
+        ("sources", "read from every connector listed in this file; one per line", cxxopts::value<std::string>()->default_value(""))
+        ("stale", "flag tracks as stale after this many seconds without an update.  0 => never", cxxopts::value<double>()->default_value("180"))
+        ("expire", "remove tracks after this many seconds without an update.  0 => never", cxxopts::value<double>()->default_value("0"))
+        ("history", "keep each track's recent positions, as 'DEPTH[,WINDOW]': at most DEPTH samples, over at most WINDOW seconds.  0 (default) => none", cxxopts::value<std::string>()->default_value("0"))
+        ("max-tracks", "hard limit on tracks held; the least-recently-updated are evicted.  0 => unlimited", cxxopts::value<size_t>()->default_value("0"))
+        ("pin", "pin the ingest pipeline's read, parse, and apply threads to CPUs, as 'R,P,A';  -1 => unpinned", cxxopts::value<std::string>()->default_value(""))
         ("v,verbose", "Verbose output")
         ("V,version", "Print Version");
     const auto clargs = options.parse(argc, argv);
@@ -123,107 +153,230 @@ int main(int argc, char *argv[]){
     // auto err_logger = spdlog::stderr_color_mt("stderr");
     //
 
+    // delivered through the event loop's signalfd; so block them before any thread starts, or that thread takes them
+    if( ! EventLoop::block_signals({SIGINT, SIGTERM, SIGWINCH}) ){
+        return EXIT_FAILURE;
+    }
+
     // ===========================================================================================
     spdlog::info(">>> .A. Creating Track Database:");
     TrackCache cache;
+    {
+        const uint64_t stale_after = static_cast<uint64_t>( clargs["stale"].as<double>() * 1e6 );
+        const uint64_t expire_after = static_cast<uint64_t>( clargs["expire"].as<double>() * 1e6 );
+        for( int source = Report::AIS; source <= Report::VISUAL; ++source ){
+            cache.set_expiry( static_cast<Report::SOURCE_SENSOR>(source), stale_after, expire_after );
+        }
+        cache.set_budget( clargs["max-tracks"].as<size_t>() );
+
+        // before the warm start: which restores each track's history into its ring
+        const std::string history = clargs["history"].as<std::string>();
+        if( ! cache.set_history(history) ){
+            spdlog::error("!! could not parse history: '{}';  expected 'DEPTH[,WINDOW]'", history );
+            return EXIT_FAILURE;
+        }
+    }
+
+    // warm start
+    const std::string checkpoint_path = clargs["checkpoint"].as<std::string>();
+    std::unique_ptr<CheckpointWriter> checkpoint_writer;
+    if( ! checkpoint_path.empty() ){
+        const auto start = std::chrono::steady_clock::now();
+        const size_t restored = Checkpoint::load( checkpoint_path, cache );
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start );
+        spdlog::info("    :> Restored {} tracks from checkpoint: {}  ({} ms)", restored, checkpoint_path, elapsed.count() );
+        checkpoint_writer = std::make_unique<CheckpointWriter>( checkpoint_path );
+    }
+    const auto checkpoint_interval = std::chrono::milliseconds( static_cast<int64_t>(clargs["checkpoint-interval"].as<double>() * 1e3) );
+
+    // after the warm start; so restored tracks are not journaled again
+    const std::string journal_directory = clargs["journal"].as<std::string>();
+    std::unique_ptr<JournalWriter> journal;
+    if( ! journal_directory.empty() ){
+        journal = std::make_unique<JournalWriter>( journal_directory );
+        if( ! journal->good() ){
+            spdlog::error("!! could not open journal: {}", journal_directory );
+            return EXIT_FAILURE;
+        }
+        cache.set_journal( journal.get() );
+        spdlog::info("    :> Journaling updates to: {}", journal_directory );
+    }
+
+    // collision-risk screening; runs on the ingest thread, between publishes
+    const bool enable_cpa = 0 < clargs["cpa-distance"].as<double>();
+    CpaEngine cpa(cache);
+    cpa.configure( static_cast<float>(clargs["cpa-distance"].as<double>()),
+                   static_cast<uint64_t>(clargs["cpa-horizon"].as<double>() * 1e6) );
 
     // ===========================================================================================
     spdlog::info(">>> .B. Creating Connectors:");
-    
-#ifdef ENABLE_AIS
-    // // const std::string ais_file = "data/ais.nmea0183.2022-05-18.log";
-    // // const std::string ais_file = "data/ais.nmea0183.2022-05-19.log";
-    // const std::string input_pcap_file = "data/ais.tcpdump.2022-05-18.pcap";
-#endif
-
-#ifdef ENABLE_MOOS
-    // const std::string input_pcap_file = "data/m2_berta.moos.pcap";
-    // const std::string input_pcap_file = "data/m2_berta.moos.gt140.pcap";
-    const std::string input_pcap_file = "data/m2_berta.moos.p9000.pcap";
-#endif
+    std::vector<std::string> specs;
+    if( 0 < clargs.count("source") ){
+        specs = clargs["source"].as<std::vector<std::string>>();
+    }
+    const std::string sources_path = clargs["sources"].as<std::string>();
+    if( (! sources_path.empty()) && (! connectors::Registry::load(sources_path, specs)) ){
+        return EXIT_FAILURE;
+    }
+    if( specs.empty() ){
+        specs = default_sources();
+    }
 
-    spdlog::info("    :> Creating File Connector to: {}", input_pcap_file);
-    readers::pcap::LogReader reader( input_pcap_file );
-    if( ! (reader.good()) ){
+    std::vector<std::unique_ptr<Connector>> connectors;
+    if( specs.empty() || (! connectors::Registry::global().create(specs, connectors)) ){
         spdlog::error("!!! Could not create all connectors");
         return EXIT_FAILURE;
     }
 
-#ifdef ENABLE_AIS
-    reader.set_filter_udp();
-    reader.set_filter_port(4003);
-#endif 
-#ifdef ENABLE_MOOS
-    reader.set_filter_tcp();
-    reader.set_filter_port(9000);
-#endif
-
     // ===========================================================================================
-    spdlog::info(">>> .C. Creating Parsers:");
-#ifdef ENABLE_AIS
-    spdlog::info("    :> Creating AIS Parser...");
-    parsers::nmea0183::PacketParser nmea_parser;
-    parsers::ais::Parser ais_parser;
-#endif
 
-#ifdef ENABLE_MOOS
-    spdlog::info( "    >> Creating MOOS Parser..." );
-    parsers::moos::PacketParser moos_packet_parser;
-    spdlog::info( "    >> Creating Node-Report Parser..." );
-    parsers::moos::MessageParser moos_report_parser;
-#endif
+    using clock = std::chrono::system_clock;
+    const std::chrono::milliseconds render_blackout(20);  // wait at least this much time between render calls
 
-    // ===========================================================================================
-    spdlog::info(">>> .D. Building UI: ");
-    CursesInputHandler handler(cache);
-    handler.update(true);
+    // Ingest runs on its own threads -- read => parse, per connector; then one apply -- and shares only immutable
+    // snapshots with the UI: a slow terminal never stalls ingest, and ingest never blocks on a render.
+    // the newest report time seen, and when; so the tick can run the cache's clock on while a feed is quiet
+    uint64_t reported_time = 0;
+    auto reported_at = std::chrono::steady_clock::now();
+
+    IngestPipeline pipeline( [&]( std::vector<Report>& reports ){
+        // project + apply this batch of reports
+        cache.update( reports );
+        for( const Report& report : reports ){
+            if( reported_time < report.timestamp ){
+                reported_time = report.timestamp;
+                reported_at = std::chrono::steady_clock::now();
+            }
+        }
+    });
+    for( auto& connector : connectors ){
+        spdlog::info("    >> Created Connector: {}", connector->name() );
+        pipeline.add_source( *connector );
+    }
 
-    // ===========================================================================================
+    // the UI thread sleeps in here until there is work: a key, a signal, a render, or a fresh snapshot
+    EventLoop loop;
+    if( ! loop.good() ){
+        spdlog::error("!! could not create the event loop");
+        return EXIT_FAILURE;
+    }
+    int published_event = -1;  // added with the UI; before the pipeline starts
+
+    // on the apply thread; the only thread which touches the cache, until the pipeline finishes
+    auto last_publish_timestamp = clock::now();
+    auto last_checkpoint_timestamp = clock::now();
+    pipeline.set_tick( [&]( bool finished ){
+        // .4. expire: updates only advance the cache's clock as far as their own timestamps; so without
+        //     this, tracks on a feed that falls quiet never go stale.  Report time, not wall time: replays age alike.
+        if( 0 < reported_time ){
+            const auto quiet = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - reported_at );
+            cache.expire( reported_time + static_cast<uint64_t>(quiet.count()) );
+        }
 
-    uint32_t interval_update_count;
-    uint32_t interval_start;
+        // .5. publish at (at most) the render rate
+        const auto now = clock::now();
+        if( finished || (render_blackout < (now - last_publish_timestamp)) ){
+            if( enable_cpa ){
+                cpa.update();
+            }
+            cache.publish();
+            loop.notify( published_event );
+            last_publish_timestamp = now;
+        }
 
-    using clock = std::chrono::system_clock;
-    const std::chrono::milliseconds render_blackout(20);  // wait at least this much time between render calls
+        // .6. checkpoint: this thread only copies; the writer's thread does the I/O
+        if( checkpoint_writer && (finished || (checkpoint_interval < (now - last_checkpoint_timestamp))) ){
+            checkpoint_writer->submit( cache.capture(true) );
+            last_checkpoint_timestamp = now;
+        }
+    }, render_blackout );
 
-    auto last_render_timestamp = clock::now();
-    auto last_change_timestamp = last_render_timestamp;
-    while(run){
-        // .1. get next data chunk
-        const auto chunk = reader.next();
-        if( 0 < chunk.length ){
-
-            // .2. Load next chunk into parser
-            moos_packet_parser.load( &chunk );
-
-            // .3. Pull reports from packet until empty
-            while( ! moos_packet_parser.empty() ){
-                const std::string line = moos_packet_parser.next();
-                if( line.empty() ){
-                    continue;
-                }
-
-                // .3. Pull reports out of parser until drained
-                Report* report = moos_report_parser.parse( line );
-                if( report ){
-                    cache.update( *report );
-                    last_change_timestamp = clock::now();
-                    ++interval_update_count;
-                }
+    const std::string cpus = clargs["pin"].as<std::string>();
+    if( (! cpus.empty()) && (! pipeline.pin(cpus)) ){
+        spdlog::error("!! could not parse CPU list: '{}';  expected 'R,P,A'", cpus );
+        return EXIT_FAILURE;
+    }
+
+    // ===========================================================================================
+    spdlog::info(">>> .C. Building UI: ");
+    CursesInputHandler handler(cache, enable_cpa ? &cpa : nullptr);
+    auto last_render_timestamp = handler.render();
+
+    // render a snapshot the UI hasn't shown yet; redundant updates do not count
+    uint64_t rendered_version = 0;
+    bool render_pending = false;
+    const auto render_latest = [&](){
+        render_pending = false;
+        const auto latest = cache.snapshot();
+        if( latest && (rendered_version != latest->modified) ){
+            rendered_version = latest->modified;
+            last_render_timestamp = handler.render();
+        }
+    };
+
+    // a fresh snapshot: render now; or -- within the blackout after the last render -- once it ends
+    const int render_timer = loop.add_timer( render_latest );
+    published_event = loop.add_event( [&](){
+        const auto render_age = clock::now() - last_render_timestamp;
+        if( render_blackout <= render_age ){
+            render_latest();
+        }else if( ! render_pending ){
+            render_pending = true;
+            loop.arm_timer( render_timer, std::chrono::duration_cast<std::chrono::microseconds>(render_blackout - render_age) );
+        }
+    });
+
+    // AGE counts from the wall clock: so redraw once a second even when no snapshot changes -- which is exactly
+    // when tracks go stale, and should be seen to age
+    const int age_timer = loop.add_timer( [&](){
+        if( std::chrono::seconds(1) <= (clock::now() - last_render_timestamp) ){
+            const auto latest = cache.snapshot();
+            if( latest ){
+                rendered_version = latest->modified;
             }
+            last_render_timestamp = handler.render();
         }
+    });
 
-        bool pending_changes = false;
-        // (a) check if any update exists since the last render...
-        if( last_render_timestamp < last_change_timestamp ){
-            auto render_age = clock::now() - last_render_timestamp;
-            if( render_blackout < render_age ){
-                pending_changes = true;
-            }
+    const bool watching_input = loop.add_reader( STDIN_FILENO, [&](){
+        handler.handle_input();
+        if( handler.quit_requested() ){
+            loop.stop();
+        }
+    });
+
+    const bool watching_signals = loop.add_signals( {SIGINT, SIGTERM, SIGWINCH}, [&]( int signal ){
+        if( SIGWINCH == signal ){
+            last_render_timestamp = handler.resize();
+        }else{
+            loop.stop();
         }
+    });
+
+    if( (render_timer < 0) || (published_event < 0) || (age_timer < 0) || (! watching_input) || (! watching_signals)
+            || (! loop.arm_timer(age_timer, std::chrono::seconds(1), std::chrono::seconds(1))) ){
+        handler.shutdownCurses();
+        spdlog::error("!! could not watch the UI's event sources");
+        return EXIT_FAILURE;
+    }
+
+    // ===========================================================================================
+    pipeline.start();
+    loop.run();
+    handler.shutdownCurses();
+
+    pipeline.stop();
+    pipeline.join();
+
+    for( const auto& connector : connectors ){
+        const ConnectorStats stats = connector->stats();
+        spdlog::info("    >> Connector {}: {} frames => {} reports;  {} errors, {} rejected.",
+                        connector->name(), stats.frames, stats.reports, stats.errors, stats.rejected );
+    }
 
-        last_render_timestamp = handler.update( pending_changes );
-        sleep(0.01);
+    if( journal ){
+        cache.set_journal( nullptr );
+        journal.reset();
     }
 
     spdlog::info( cache.to_string());
@@ -1,20 +1,29 @@
 #include <ncurses.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
 
 #include "curses-input-handler.hpp"
 #include "curses-renderer.hpp"
 
-CursesInputHandler::CursesInputHandler(TrackCache& cache)
-    : renderer(cache)
+CursesInputHandler::CursesInputHandler(TrackCache& cache, const CpaEngine* cpa)
+    : renderer(cache, cpa)
+    , quit_(false)
+    , active_(false)
 {
     configure();
 }
 
+CursesInputHandler::~CursesInputHandler(){
+    shutdownCurses();
+}
+
 void CursesInputHandler::configure(){
     // initialise Ncurses
     if (initscr() == NULL) {
         fprintf(stderr, "Error initializing NCurses: initscr() failed!!\n");
         exit(EXIT_FAILURE);
     }
+    active_ = true;
 
     renderer.configure();
 
@@ -37,18 +46,25 @@ void CursesInputHandler::configure(){
 }
 
 bool CursesInputHandler::handle_input(){
-    char key = getch();
-    
-    if(ERR == key){
-        // technically an error, but also the return if no input is available -- 
-        // i.e. this is the very common, default case
-        return false;
+    bool handled = false;
+    // reads are non-blocking: so this drains every key typed since the last call
+    while( ! quit_ ){
+        const int next = getch();
+        if(ERR == next){
+            // technically an error, but also the return if no input is available --
+            // i.e. this is the very common, default case
+            break;
+        }
+        handled = handle_key( static_cast<char>(next) ) || handled;
     }
+    return handled;
+}
 
+bool CursesInputHandler::handle_key( char key ){
     if( 'q' == key ){
-        // normal exit
-        shutdownCurses();
-        exit(0);
+        // normal exit; the caller shuts down, so ingest can stop cleanly
+        quit_ = true;
+        return true;
     }
 
     if(('0' <= key) && ( key <= '9')){
@@ -86,22 +102,34 @@ bool CursesInputHandler::handle_input(){
 }
 
 void CursesInputHandler::shutdownCurses(){
+    if( ! active_ ){
+        return;
+    }
+    active_ = false;
+
     // End curses mode
     endwin();
     
     fprintf(stderr, "Program finished: shutting down NCurses.\n\n");
 }
 
-std::chrono::system_clock::time_point CursesInputHandler::update( bool changed ){
-    if( handle_input() ){
-        // noop
-    }else if(changed){
-        renderer.render();
-        last_update_ = std::chrono::system_clock::now();
-    } // else{
-    //    // noop
-    // }
+bool CursesInputHandler::quit_requested() const {
+    return quit_;
+}
 
+std::chrono::system_clock::time_point CursesInputHandler::render(){
+    renderer.render();
+    last_update_ = std::chrono::system_clock::now();
     return last_update_;
 }
 
+std::chrono::system_clock::time_point CursesInputHandler::resize(){
+    winsize size{};
+    if( 0 == ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) ){
+        resizeterm( size.ws_row, size.ws_col );
+    }
+    // the old layout is wrong at the new size; so clear it, rather than draw over it
+    clear();
+    return render();
+}
+
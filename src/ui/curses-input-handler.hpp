@@ -13,22 +13,38 @@ class CursesInputHandler
     public:
         CursesInputHandler() = delete;
         
-        CursesInputHandler(TrackCache& cache);
+        /// \param cpa optional; adds a CPA column
+        CursesInputHandler(TrackCache& cache, const CpaEngine* cpa = nullptr);
 
-        ~CursesInputHandler() =  default;
+        ~CursesInputHandler();
 
-        std::chrono::system_clock::time_point update( bool changed );
+        /// \brief handle every key waiting on stdin; call when stdin is readable
+        /// \return true if any key was handled
+        bool handle_input();
 
+        /// \brief redraw now
+        /// \return the time of this render
+        std::chrono::system_clock::time_point render();
 
-    private:
-        void configure();
+        /// \brief adopt the terminal's new size, and redraw; call on SIGWINCH
+        /// \return the time of this render
+        std::chrono::system_clock::time_point resize();
 
-        bool handle_input();
+        /// \return true once the user has asked to quit
+        bool quit_requested() const;
 
+        /// \brief restore the terminal; safe to call more than once
         void shutdownCurses();
 
+    private:
+        void configure();
+
+        bool handle_key( char key );
+
     private:
         CursesRenderer renderer;
         std::chrono::system_clock::time_point last_update_;
+        bool quit_;
+        bool active_;
 
 };
@@ -1,48 +1,44 @@
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstring>
 
 #include <ncurses.h>
-#include <signal.h>
 
+#include "core/name-table.hpp"
 #include "curses-renderer.hpp"
 
 /* If an xterm is resized the contents on your text windows might be messed up.
 To handle this gracefully you should redraw all the stuff based on the new
 height and width of the screen. When resizing happens, your program is sent
-a SIGWINCH signal. You should catch this signal and do redrawing accordingly.
+a SIGWINCH signal: trackmon receives it through its event loop, rather than a
+signal handler, and calls `CursesInputHandler::resize`.
 */
-void resizeHandler(int sig)
-{
-    int h, w;
-
-    // this simply doesn't update h&w under OSX when using terminal
-    getmaxyx(stdscr, h, w);
-    fprintf(stderr, "Resizing: (h= %d, w= %d )\n", h, w);
-    fprintf(stderr, "Resizing: (LINES= %d, COLS= %d )\n", LINES, COLS);
-    refresh();
-}
 
-CursesRenderer::CursesRenderer(TrackCache& _cache)
+CursesRenderer::CursesRenderer(TrackCache& _cache, const CpaEngine* _cpa)
     : cache(_cache)
+    , cpa(_cpa)
     , command_key(' ')
     , command_result("\0")
     , render_live(true)
     , render_help(true)
 {
-    // SIGWINCH ~= SIGnal-WINdow-CHange
-    signal(SIGWINCH, resizeHandler);
-
     // columns.emplace(? "Source", 
     columns.emplace_back("ID", "Id", "%ld", 20);
     // columns.emplace_back("TIME", "Time", "%g", 12);
     columns.emplace_back("AGE", "Time", "%+9.8g", 12);
-    columns.emplace_back("NAME", "Name", "%-20s", 20);
+    // names are views into the NameTable, not terminated: so the format takes the width, then the length
+    columns.emplace_back("NAME", "Name", "%-*.*s", 20);
     //columns.emplace_back("X", "X", "%+9.2g", 10);
     //columns.emplace_back("Y", "Y", "%+9.2g", 10);
 
     columns.emplace_back("LAT", "Latitude", "%+9.2g", 10);
     columns.emplace_back("LON", "Longitude", "%+9.2g", 10);
+
+    if( nullptr != cpa ){
+        // distance (m) @ time-until (s) of this track's closest approach
+        columns.emplace_back("CPA", "CPA (m @ s)", "%6.0f @ %-5.0f", 16);
+    }
     
     // mvprintw(0,0,"Source             Time                Name        X / Y            Latitude / Longitude    ");
 }
@@ -93,7 +89,7 @@ void CursesRenderer::render_status_bar(){
         }
         printw("============ ============ ");
         printw("============ ============ ");
-        printw("==== %4d/%4d Tracks ==== ", (int)0, (int)cache.size());
+        printw("==== %4d/%4d Tracks ==== ", (int)(frame->size() - frame->stale_count), (int)frame->size());
     }
     attroff(A_REVERSE);
     return;
@@ -131,32 +127,50 @@ void CursesRenderer::render_column_headers(){
 void CursesRenderer::render_column_contents(){
     auto current_time = std::chrono::system_clock::now();
 
-    if(0 == cache.size()){
+    if(0 == frame->size()){
         // dummy / placeholder
         mvprintw( header_line_offset, 0, " < No Tracks Received > ");
     } else {
+        // snapshots are already ordered by id.  Only format the rows that fit above the footer:
+        // so a frame costs O(screen), not O(tracks).
+        const int footer_line = LINES + (render_help ? footer_expand_line_offset : footer_minimal_line_offset);
+        const size_t visible = (header_line_offset < footer_line) ? static_cast<size_t>(footer_line - header_line_offset) : 0;
+        const size_t count = std::min( frame->reports.size(), visible );
         size_t row = header_line_offset;
-        for (auto iter = cache.cbegin(); iter != cache.cend(); ++iter) {
-            const uint64_t id = iter->first;
-            const Track& track = iter->second;
-            
-            const Report& report = track.last_report;
+        for( size_t index = 0; index < count; ++index ){
+            const Report& report = frame->reports[index];
+            const uint64_t id = report.id;
+
+            // stale tracks are drawn dimmed
+            const bool stale = frame->stale[index];
+            if( stale ){
+                attron(A_DIM);
+            }
 
             int col = 0;
             for( DisplayColumn& disp : columns ){
                 if("AGE" == disp.key){
-                    const auto age = current_time - std::chrono::microseconds(report.timestamp);
-                    mvprintw( row, col, disp.format.c_str(), age);
+                    // seconds since the report; a double, as the column's format expects
+                    const std::chrono::duration<double> age = current_time.time_since_epoch() - std::chrono::microseconds(report.timestamp);
+                    mvprintw( row, col, disp.format.c_str(), age.count());
                 }else if("TIME" == disp.key){
                     mvprintw( row, col, disp.format.c_str(), report.timestamp);
                 }else if("ID" == disp.key){
                     mvprintw( row, col, disp.format.c_str(), id);
-                // }else if("NAME" == disp.key){
-                // mvprintw( row, col, disp.format.c_str(), track.name.c_str());
+                }else if("NAME" == disp.key){
+                    const std::string_view name = NameTable::global().lookup(report.name);
+                    const int width = static_cast<int>(disp.width);
+                    mvprintw( row, col, disp.format.c_str(), width, std::min(static_cast<int>(name.size()), width), name.data());
                 }else if("LAT" == disp.key){
-                    mvprintw( row, col, disp.format.c_str(), report.latitude);
+                    mvprintw( row, col, disp.format.c_str(), report.has(Report::GLOBAL) ? report.latitude : NAN);
                 }else if("LON" == disp.key){
-                mvprintw( row, col, disp.format.c_str(), report.longitude);
+                    mvprintw( row, col, disp.format.c_str(), report.has(Report::GLOBAL) ? report.longitude : NAN);
+                }else if("CPA" == disp.key){
+                    const CpaPair* pair = cpa_frame ? cpa_frame->closest(id) : nullptr;
+                    if( pair ){
+                        const double until = (static_cast<double>(pair->time) - static_cast<double>(cpa_frame->clock)) * 1e-6;
+                        mvprintw( row, col, disp.format.c_str(), pair->distance, until);
+                    }
                 // }else if("X" == disp.key){
                 //     mvprintw( row, col, disp.format.c_str(), report.x);
                 // }else if("Y" == disp.key){
@@ -165,6 +179,9 @@ void CursesRenderer::render_column_contents(){
                 
                 col += disp.width;
             }
+            if( stale ){
+                attroff(A_DIM);
+            }
             ++row;
         }
     }
@@ -204,7 +221,17 @@ void CursesRenderer::set_key_result(const char* _result, size_t length ){
 }
 
 void CursesRenderer::render(){
-    clear();
+    // hold one snapshot for the whole frame; ingest may publish newer ones meanwhile
+    frame = cache.snapshot();
+    if( ! frame ){
+        frame = std::make_shared<const TrackSnapshot>();
+    }
+    if( nullptr != cpa ){
+        cpa_frame = cpa->snapshot();
+    }
+
+    // erase, not clear: clear() forces a full repaint; erase() lets curses send only the cells that changed
+    erase();
 
     // header
     render_column_headers();
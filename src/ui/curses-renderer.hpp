@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "core/cpa-engine.hpp"
 #include "core/track-cache.hpp"
 
 #include "ui/display-column.hpp"
@@ -16,7 +17,8 @@ class CursesRenderer
     public:
         CursesRenderer() = delete;
 
-        CursesRenderer(TrackCache& cache);
+        /// \param cpa optional; adds a CPA column
+        CursesRenderer(TrackCache& cache, const CpaEngine* cpa = nullptr);
 
         ~CursesRenderer() = default;
 
@@ -52,7 +54,12 @@ class CursesRenderer
         static const int status_line_offset = -1;
 
         TrackCache& cache;
+        const CpaEngine* cpa;
         std::vector<DisplayColumn> columns;
+        // snapshot being rendered; read-only, and shared with the ingest thread
+        std::shared_ptr<const TrackSnapshot> frame;
+        // CPA results for this frame; (may be published at a slightly different time than `frame`)
+        std::shared_ptr<const CpaSnapshot> cpa_frame;
         char command_key;
         constexpr static size_t command_result_buffer_length = 128;
         char command_result[command_result_buffer_length];